@@ -0,0 +1,226 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "AudioCapture.h"
+#include "sdkconfig.h"
+
+#if CONFIG_AUDIO_CAPTURE_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/ringbuf.h"
+#include "MemPlacement.h"
+#include "TaskTopology.h"
+#if CONFIG_AUDIO_CAPTURE_MOUNT_SDCARD
+#include "board.h"
+#include "esp_peripherals.h"
+#endif
+
+static const char *TAG = "AUDIO_CAPTURE";
+
+#define CAPTURE_MAX_FILES           100000
+#define CAPTURE_FLUSH_INTERVAL_US   (1000 * 1000)
+#define CAPTURE_STOP_WAIT_MS        1000
+
+typedef struct {
+    RingbufHandle_t ring;
+    StaticRingbuffer_t ring_struct;
+    uint8_t* ring_storage;
+    SemaphoreHandle_t lock;             // 保护 file，写文件任务和 start/stop 之间互斥
+    FILE* file;
+    volatile bool active;
+    capture_file_header_t header;
+    uint32_t file_bytes;
+    int64_t last_flush_us;
+    uint32_t records;
+    volatile uint32_t dropped;
+    bool size_limit_logged;
+} audio_capture_t;
+
+static audio_capture_t capture = {0};
+
+static void capture_write_task(void* arg) {
+    while (true) {
+        size_t size = 0;
+        uint8_t* item = xRingbufferReceive(capture.ring, &size, portMAX_DELAY);
+        if (item == NULL) {
+            continue;
+        }
+        xSemaphoreTake(capture.lock, portMAX_DELAY);
+        if (capture.file) {
+            if (capture.file_bytes + size > (uint32_t)CONFIG_AUDIO_CAPTURE_MAX_FILE_KB * 1024) {
+                if (!capture.size_limit_logged) {
+                    ESP_LOGW(TAG, "capture file reached %d KB, drop further records", CONFIG_AUDIO_CAPTURE_MAX_FILE_KB);
+                    capture.size_limit_logged = true;
+                }
+                capture.dropped++;
+            } else if (fwrite(item, 1, size, capture.file) == size) {
+                capture.file_bytes += size;
+                capture.records++;
+            } else {
+                capture.dropped++;
+            }
+            int64_t now = esp_timer_get_time();
+            if (now - capture.last_flush_us > CAPTURE_FLUSH_INTERVAL_US) {
+                // 定期落盘，设备异常重启时最多丢失一秒的数据
+                fflush(capture.file);
+                fsync(fileno(capture.file));
+                capture.last_flush_us = now;
+            }
+        }
+        xSemaphoreGive(capture.lock);
+        vRingbufferReturnItem(capture.ring, item);
+    }
+}
+
+bool audio_capture_init(void* periph_set) {
+    if (capture.ring != NULL) {
+        return true;
+    }
+#if CONFIG_AUDIO_CAPTURE_MOUNT_SDCARD
+    if (periph_set == NULL || audio_board_sdcard_init((esp_periph_set_handle_t)periph_set, SD_MODE_1_LINE) != ESP_OK) {
+        ESP_LOGE(TAG, "mount sdcard failed, capture disabled");
+        return false;
+    }
+#endif
+    // 录音和下行音频合计约 100KB/s，ring buffer 吸收 SD 卡写入的抖动，放在 PSRAM
+    capture.ring_storage = mem_class_malloc(MEM_CLASS_BULK, CONFIG_AUDIO_CAPTURE_RING_KB * 1024);
+    capture.lock = xSemaphoreCreateMutex();
+    if (!capture.ring_storage || !capture.lock) {
+        ESP_LOGE(TAG, "capture init failed");
+        return false;
+    }
+    capture.ring = xRingbufferCreateStatic(CONFIG_AUDIO_CAPTURE_RING_KB * 1024, RINGBUF_TYPE_NOSPLIT,
+                                           capture.ring_storage, &capture.ring_struct);
+    memcpy(capture.header.magic, CAPTURE_MAGIC, sizeof(capture.header.magic));
+    capture.header.version = CAPTURE_VERSION;
+    capture.header.stream_count = CAPTURE_STREAM_MAX;
+    task_topology_create(TASK_ID_CAPTURE, capture_write_task, NULL, NULL);
+    ESP_LOGI(TAG, "capture to %s, ring %d KB", CONFIG_AUDIO_CAPTURE_DIR, CONFIG_AUDIO_CAPTURE_RING_KB);
+    return true;
+}
+
+void audio_capture_set_format(capture_stream_e stream, uint32_t sample_rate, uint8_t channels, capture_codec_e codec) {
+    if (stream >= CAPTURE_STREAM_MAX) {
+        return;
+    }
+    capture.header.formats[stream].sample_rate = sample_rate;
+    capture.header.formats[stream].channels = channels;
+    capture.header.formats[stream].codec = codec;
+}
+
+bool audio_capture_start(void) {
+    if (capture.ring == NULL || capture.active) {
+        return false;
+    }
+    // FATFS 没有开启长文件名，使用 8.3 文件名
+    char path[64];
+    struct stat st;
+    int index = 0;
+    for (; index < CAPTURE_MAX_FILES; index++) {
+        snprintf(path, sizeof(path), "%s/CAP%05d.RCP", CONFIG_AUDIO_CAPTURE_DIR, index);
+        if (stat(path, &st) != 0) {
+            break;
+        }
+    }
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        ESP_LOGE(TAG, "open %s failed", path);
+        return false;
+    }
+    capture.header.start_time_us = esp_timer_get_time();
+    fwrite(&capture.header, 1, sizeof(capture.header), file);
+
+    xSemaphoreTake(capture.lock, portMAX_DELAY);
+    capture.file = file;
+    capture.file_bytes = sizeof(capture.header);
+    capture.last_flush_us = capture.header.start_time_us;
+    capture.records = 0;
+    capture.dropped = 0;
+    capture.size_limit_logged = false;
+    xSemaphoreGive(capture.lock);
+    capture.active = true;
+    ESP_LOGI(TAG, "capture started: %s", path);
+    return true;
+}
+
+void audio_capture_stop(void) {
+    if (!capture.active) {
+        return;
+    }
+    capture.active = false;
+    // 等待 ring buffer 中已经提交的记录写完
+    for (int waited = 0; waited < CAPTURE_STOP_WAIT_MS; waited += 10) {
+        UBaseType_t waiting = 0;
+        vRingbufferGetInfo(capture.ring, NULL, NULL, NULL, NULL, &waiting);
+        if (waiting == 0) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    xSemaphoreTake(capture.lock, portMAX_DELAY);
+    FILE* file = capture.file;
+    capture.file = NULL;
+    xSemaphoreGive(capture.lock);
+    if (file) {
+        fclose(file);
+    }
+    ESP_LOGI(TAG, "capture stopped: %u records, %u bytes, %u dropped",
+             (unsigned)capture.records, (unsigned)capture.file_bytes, (unsigned)capture.dropped);
+}
+
+bool audio_capture_active(void) {
+    return capture.active;
+}
+
+void audio_capture_write(capture_stream_e stream, const void* data, size_t length, uint32_t extra) {
+    if (!capture.active || length > UINT16_MAX) {
+        return;
+    }
+    void* item = NULL;
+    size_t size = sizeof(capture_record_header_t) + length;
+    if (xRingbufferSendAcquire(capture.ring, &item, size, 0) != pdTRUE) {
+        capture.dropped++;
+        return;
+    }
+    capture_record_header_t* record = item;
+    record->stream = stream;
+    record->flags = 0;
+    record->length = length;
+    record->extra = extra;
+    record->timestamp_us = esp_timer_get_time() - capture.header.start_time_us;
+    memcpy(record + 1, data, length);
+    xRingbufferSendComplete(capture.ring, item);
+}
+
+#else
+
+bool audio_capture_init(void* periph_set) {
+    return false;
+}
+
+void audio_capture_set_format(capture_stream_e stream, uint32_t sample_rate, uint8_t channels, capture_codec_e codec) {
+}
+
+bool audio_capture_start(void) {
+    return false;
+}
+
+void audio_capture_stop(void) {
+}
+
+bool audio_capture_active(void) {
+    return false;
+}
+
+void audio_capture_write(capture_stream_e stream, const void* data, size_t length, uint32_t extra) {
+}
+
+#endif
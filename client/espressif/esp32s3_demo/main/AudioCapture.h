@@ -0,0 +1,77 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __AUDIO_CAPTURE_H__
+#define __AUDIO_CAPTURE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 采集文件格式，主机工具 tools/capture 也使用这个头文件，这里只能依赖 libc
+// 文件 = capture_file_header_t + N * (capture_record_header_t + payload)，全部小端
+#define CAPTURE_MAGIC           "RCAP"
+#define CAPTURE_VERSION         1
+
+typedef enum {
+    CAPTURE_STREAM_MIC = 0,     // i2s 原始输入，KORVO2 上包含回采参考信号
+    CAPTURE_STREAM_AEC,         // AFE（AEC/AGC）输出
+    CAPTURE_STREAM_UPLINK,      // 编码后的上行帧，即 byte_rtc_send_audio_data 的数据
+    CAPTURE_STREAM_DOWNLINK,    // on_audio_data 收到的下行帧，extra 为 sent_ts
+    CAPTURE_STREAM_MAX,
+} capture_stream_e;
+
+typedef enum {
+    CAPTURE_CODEC_PCM16 = 0,
+    CAPTURE_CODEC_PCM32,        // 32bit 容器，KORVO2 的 "RM" 格式每个样本高低 16bit 分别是参考和麦克风
+    CAPTURE_CODEC_OPUS,
+    CAPTURE_CODEC_G711A,
+    CAPTURE_CODEC_G722,
+    CAPTURE_CODEC_AAC,
+} capture_codec_e;
+
+typedef struct __attribute__((packed)) {
+    uint32_t sample_rate;
+    uint8_t channels;
+    uint8_t codec;              // capture_codec_e
+    uint16_t reserved;
+} capture_stream_format_t;
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint16_t version;
+    uint16_t stream_count;
+    uint64_t start_time_us;     // 开始采集时的 esp_timer 时间
+    capture_stream_format_t formats[CAPTURE_STREAM_MAX];
+} capture_file_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t stream;             // capture_stream_e
+    uint8_t flags;
+    uint16_t length;            // payload 字节数
+    uint32_t extra;
+    uint64_t timestamp_us;      // 相对 start_time_us
+} capture_record_header_t;
+
+// 挂载存储、创建写文件任务；periph_set 用于挂载 SD 卡，可以为 NULL
+bool audio_capture_init(void* periph_set);
+
+// 在 start 之前设置，写入文件头
+void audio_capture_set_format(capture_stream_e stream, uint32_t sample_rate, uint8_t channels, capture_codec_e codec);
+
+// 每次 start 新建一个文件，stop 时等待队列写完再关闭
+bool audio_capture_start(void);
+void audio_capture_stop(void);
+bool audio_capture_active(void);
+
+// 可以在任意任务中调用，只拷贝到 ring buffer，满了直接丢弃并计数，不会阻塞 pipeline
+void audio_capture_write(capture_stream_e stream, const void* data, size_t length, uint32_t extra);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __AUDIO_CAPTURE_H__
@@ -2,6 +2,12 @@
 // SPDX-License-Identifier: MIT
 
 #include "AudioPipeline.h"
+#include "MemPlacement.h"
+#include "TaskTopology.h"
+#include "AudioCapture.h"
+#include "AudioPlc.h"
+#include "ReorderWindow.h"
+#include "AudioPlayout.h"
 #include <string.h>
 #include "esp_log.h"
 #include "sdkconfig.h"
@@ -75,6 +81,23 @@ static const char *TAG = "AUDIO_PIPELINE";
 #define CODEC_SAMPLE_RATE   8000
 #endif
 
+#define PLAYER_FRAME_MAX            1024    // 下行单帧的最大字节数
+#if CONFIG_AUDIO_PLC_ENABLE
+#define PLC_HEADER_SIZE             8       // 2 字节长度 + 2 字节 sent_ts + 4 字节到达时间(ms)，大端
+#define PLC_FRAME_MS                20
+#define REORDER_ADAPT_MS            10000   // 这么久没有乱序后缺帧不再等待
+#define PLAYOUT_LOW_WATER_MS        5       // 播放缓冲低于这个值时不再等缺的帧，提前隐藏
+#define PLC_TIMED_INPUT             (CONFIG_AUDIO_REORDER_ENABLE || CONFIG_AUDIO_PLAYOUT_ADAPTIVE)
+#endif
+
+#if CONFIG_AUDIO_CAPTURE_ENABLE
+// 替换 element 的输出：先交给 AudioCapture，再写入原来的 ringbuffer，不需要额外的任务
+typedef struct {
+    ringbuf_handle_t rb;
+    capture_stream_e stream;
+} capture_hook_t;
+#endif
+
 struct  recorder_pipeline_t {
     audio_pipeline_handle_t audio_pipeline;
     audio_element_handle_t i2s_stream_reader;
@@ -82,6 +105,13 @@ struct  recorder_pipeline_t {
     audio_element_handle_t raw_reader;
     audio_element_handle_t rsp;
     audio_element_handle_t algo_aec;
+    audio_element_handle_t tap;
+    recorder_tap_cb_t tap_cb;
+    void* tap_ctx;
+    volatile bool tap_forward;
+#if CONFIG_AUDIO_CAPTURE_ENABLE
+    capture_hook_t capture_hooks[2];
+#endif
 };
 
 
@@ -91,11 +121,25 @@ struct  player_pipeline_t {
     audio_element_handle_t audio_decoder;
     audio_element_handle_t rsp;
     audio_element_handle_t i2s_stream_writer;
+    uint8_t frame[PLAYER_FRAME_MAX + 8];    // 只在 SDK 的下行回调中使用
+#if CONFIG_AUDIO_PLC_ENABLE
+    audio_plc_t* plc;
+    volatile bool plc_reset;
+#if CONFIG_AUDIO_REORDER_ENABLE
+    reorder_window_t* reorder;
+#endif
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+    audio_playout_t* playout;
+    int sample_rate;            // plc element 输出的采样率
+    bool conceal_blocked;       // 提前隐藏已经达到 max gap，等下一帧
+#endif
+#endif
 };
 
-static audio_element_handle_t create_resample_stream(int src_rate, int src_ch, int dest_rate, int dest_ch)
+static audio_element_handle_t create_resample_stream(task_id_e task_id, int src_rate, int src_ch, int dest_rate, int dest_ch)
 {
     rsp_filter_cfg_t rsp_cfg = DEFAULT_RESAMPLE_FILTER_CONFIG();
+    TASK_TOPOLOGY_APPLY(rsp_cfg, task_id);
     rsp_cfg.src_rate = src_rate;
     rsp_cfg.src_ch = src_ch;
     rsp_cfg.dest_rate = dest_rate;
@@ -114,6 +158,7 @@ static audio_element_handle_t create_record_i2s_stream(void)
 #endif
     i2s_stream_cfg_t i2s_cfg = I2S_STREAM_CFG_DEFAULT_WITH_PARA(CODEC_ADC_I2S_PORT, I2S_SAMPLE_RATE, ALGORITHM_STREAM_SAMPLE_BIT, AUDIO_STREAM_READER); // 参数需要仔细检查
     i2s_cfg.type = AUDIO_STREAM_READER;
+    TASK_TOPOLOGY_APPLY(i2s_cfg, TASK_ID_REC_I2S);
     i2s_stream_set_channel_type(&i2s_cfg, CHANNEL_FORMAT);
     i2s_cfg.std_cfg.clk_cfg.sample_rate_hz = I2S_SAMPLE_RATE;
     return i2s_stream_init(&i2s_cfg);
@@ -127,17 +172,19 @@ static audio_element_handle_t create_record_encoder_stream(void)
     opus_cfg.channel            = CHANNEL;
     opus_cfg.bitrate            = BIT_RATE;
     opus_cfg.complexity         = 0; // COMPLEXITY;
-    opus_cfg.task_core          = 1;
+    TASK_TOPOLOGY_APPLY(opus_cfg, TASK_ID_REC_ENCODER);
     return raw_opus_encoder_init(&opus_cfg);
 #elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_AAC)
     aac_encoder_cfg_t aac_cfg = DEFAULT_AAC_ENCODER_CONFIG();
     aac_cfg.sample_rate        = CODEC_SAMPLE_RATE;
     aac_cfg.channel            = CHANNEL;
     aac_cfg.bitrate            = BIT_RATE;
+    TASK_TOPOLOGY_APPLY(aac_cfg, TASK_ID_REC_ENCODER);
     pipeline->audio_encoder = aac_encoder_init(&aac_cfg);
     return audio_pipeline_register(pipeline->audio_pipeline, pipeline->audio_encoder, CODEC_NAME);
 #elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_G711A)
     g711_encoder_cfg_t g711_cfg = DEFAULT_G711_ENCODER_CONFIG();
+    TASK_TOPOLOGY_APPLY(g711_cfg, TASK_ID_REC_ENCODER);
     return g711_encoder_init(&g711_cfg);
 #else
     return NULL;
@@ -164,15 +211,88 @@ static audio_element_handle_t create_record_algo_stream(void)
     algo_config.out_rb_size = 256;
     algo_config.algo_mask = ALGORITHM_STREAM_DEFAULT_MASK | ALGORITHM_STREAM_USE_AGC;
     algo_config.input_format = ALGORITHM_INPUT_FORMAT;
+    TASK_TOPOLOGY_APPLY(algo_config, TASK_ID_REC_AEC);
     audio_element_handle_t element_algo = algo_stream_init(&algo_config);
     audio_element_set_music_info(element_algo, ALGO_SAMPLE_RATE, 1, 16);
     audio_element_set_input_timeout(element_algo, portMAX_DELAY);
     return element_algo;
 }
 
+#if CONFIG_WAKE_WORD_ENABLE
+// AFE 输出的旁路：把每块数据交给回调（唤醒词检测），只有 forward 时才继续送给编码器
+static audio_element_err_t tap_process(audio_element_handle_t self, char *in_buffer, int in_len)
+{
+    recorder_pipeline_handle_t pipeline = (recorder_pipeline_handle_t)audio_element_getdata(self);
+    int r_size = audio_element_input(self, in_buffer, in_len);
+    if (r_size <= 0) {
+        return r_size;
+    }
+    if (pipeline->tap_cb) {
+        pipeline->tap_cb((const int16_t *)in_buffer, r_size / sizeof(int16_t), pipeline->tap_ctx);
+    }
+    if (!pipeline->tap_forward) {
+        return r_size;
+    }
+    return audio_element_output(self, in_buffer, r_size);
+}
+
+static audio_element_handle_t create_record_tap_stream(recorder_pipeline_handle_t pipeline)
+{
+    audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+    cfg.process = tap_process;
+    cfg.tag = "tap";
+    cfg.buffer_len = 960;
+    cfg.out_rb_size = 2 * 1024;
+    TASK_TOPOLOGY_APPLY(cfg, TASK_ID_REC_TAP);
+    audio_element_handle_t stream = audio_element_init(&cfg);
+    audio_element_setdata(stream, pipeline);
+    audio_element_set_input_timeout(stream, portMAX_DELAY);
+    return stream;
+}
+#endif
+
+#if CONFIG_AUDIO_CAPTURE_ENABLE
+static audio_element_err_t capture_write_cb(audio_element_handle_t self, char *buffer, int len, TickType_t ticks_to_wait, void *context)
+{
+    capture_hook_t *hook = (capture_hook_t *)context;
+    audio_capture_write(hook->stream, buffer, len, 0);
+    return rb_write(hook->rb, buffer, len, ticks_to_wait);
+}
+
+// 必须在 audio_pipeline_link 之后调用，link 会把输出重新设置为 ringbuffer
+static void capture_hook_install(capture_hook_t *hook, audio_element_handle_t element, capture_stream_e stream)
+{
+    hook->rb = audio_element_get_output_ringbuf(element);
+    hook->stream = stream;
+    audio_element_set_write_cb(element, capture_write_cb, hook);
+}
+
+static void capture_set_formats(void)
+{
+#ifdef CONFIG_ESP32_S3_KORVO2_V3_BOARD
+    audio_capture_set_format(CAPTURE_STREAM_MIC, I2S_SAMPLE_RATE, CHANNEL_NUM, CAPTURE_CODEC_PCM32);
+#else
+    audio_capture_set_format(CAPTURE_STREAM_MIC, I2S_SAMPLE_RATE, CHANNEL_NUM, CAPTURE_CODEC_PCM16);
+#endif
+    audio_capture_set_format(CAPTURE_STREAM_AEC, ALGO_SAMPLE_RATE, 1, CAPTURE_CODEC_PCM16);
+#if defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS)
+    capture_codec_e codec = CAPTURE_CODEC_OPUS;
+#elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_AAC)
+    capture_codec_e codec = CAPTURE_CODEC_AAC;
+#elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_G711A)
+    capture_codec_e codec = CAPTURE_CODEC_G711A;
+#else
+    capture_codec_e codec = CAPTURE_CODEC_PCM16;
+#endif
+    audio_capture_set_format(CAPTURE_STREAM_UPLINK, CODEC_SAMPLE_RATE, 1, codec);
+    audio_capture_set_format(CAPTURE_STREAM_DOWNLINK, CODEC_SAMPLE_RATE, 1, codec);
+}
+#endif
+
 recorder_pipeline_handle_t recorder_pipeline_open()
 {
-    recorder_pipeline_handle_t pipeline = heap_caps_calloc(1, sizeof(recorder_pipeline_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_DEFAULT);
+    recorder_pipeline_handle_t pipeline = mem_class_calloc(MEM_CLASS_HOT_AUDIO, 1, sizeof(recorder_pipeline_t));
+    pipeline->tap_forward = true;
     esp_log_level_set("*", ESP_LOG_WARN);
     esp_log_level_set(TAG, ESP_LOG_INFO);
 
@@ -187,8 +307,13 @@ recorder_pipeline_handle_t recorder_pipeline_open()
     pipeline->algo_aec = create_record_algo_stream();
     audio_pipeline_register(pipeline->audio_pipeline, pipeline->algo_aec, "algo");
 
+#if CONFIG_WAKE_WORD_ENABLE
+    pipeline->tap = create_record_tap_stream(pipeline);
+    audio_pipeline_register(pipeline->audio_pipeline, pipeline->tap, "tap");
+#endif
+
 #ifndef RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS
-    pipeline->rsp = create_resample_stream(I2S_SAMPLE_RATE, 1, CODEC_SAMPLE_RATE, 1);
+    pipeline->rsp = create_resample_stream(TASK_ID_REC_RSP, I2S_SAMPLE_RATE, 1, CODEC_SAMPLE_RATE, 1);
     audio_pipeline_register(pipeline->audio_pipeline, pipeline->rsp, "rsp");
 #endif
 
@@ -200,17 +325,27 @@ recorder_pipeline_handle_t recorder_pipeline_open()
     pipeline->raw_reader = create_record_raw_stream();
     audio_pipeline_register(pipeline->audio_pipeline, pipeline->raw_reader, "raw");
 
+#if CONFIG_WAKE_WORD_ENABLE
+#define AFE_OUTPUT_TAGS     "algo", "tap"
+#else
+#define AFE_OUTPUT_TAGS     "algo"
+#endif
 #ifdef RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS
-    const char *link_tag[] = {"i2s", "algo", CODEC_NAME, "raw"};
+    const char *link_tag[] = {"i2s", AFE_OUTPUT_TAGS, CODEC_NAME, "raw"};
 #elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_AAC)
     const char *link_tag[] = {"i2s", "aac", "rsp", CODEC_NAME, "raw"};
 #elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_G711A)
-    const char *link_tag[] = {"i2s", "algo", "rsp", "g711a", "raw"};
+    const char *link_tag[] = {"i2s", AFE_OUTPUT_TAGS, "rsp", "g711a", "raw"};
 #elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_PCM)
-    const char *link_tag[] = {"i2s", "algo", "rsp", "raw"};
+    const char *link_tag[] = {"i2s", AFE_OUTPUT_TAGS, "rsp", "raw"};
 #endif
 
     audio_pipeline_link(pipeline->audio_pipeline, &link_tag[0], sizeof(link_tag) / sizeof(link_tag[0]));
+#if CONFIG_AUDIO_CAPTURE_ENABLE
+    capture_hook_install(&pipeline->capture_hooks[0], pipeline->i2s_stream_reader, CAPTURE_STREAM_MIC);
+    capture_hook_install(&pipeline->capture_hooks[1], pipeline->algo_aec, CAPTURE_STREAM_AEC);
+    capture_set_formats();
+#endif
     return pipeline;
 }
 
@@ -239,15 +374,37 @@ void recorder_pipeline_close(recorder_pipeline_handle_t pipeline)  {
         audio_pipeline_unregister(pipeline->audio_pipeline, pipeline->algo_aec);
         audio_element_deinit(pipeline->algo_aec);
     }
+    if (pipeline->tap) {
+        audio_pipeline_unregister(pipeline->audio_pipeline, pipeline->tap);
+        audio_element_deinit(pipeline->tap);
+    }
 
     audio_pipeline_deinit(pipeline->audio_pipeline);
-    heap_caps_free(pipeline);
+    mem_class_free(MEM_CLASS_HOT_AUDIO, pipeline);
 };
 
 void recorder_pipeline_run(recorder_pipeline_handle_t pipeline){
     audio_pipeline_run(pipeline->audio_pipeline);
 };
 
+// 会话之间只暂停 element 任务，不销毁 pipeline，下一次会话直接 resume
+void recorder_pipeline_pause(recorder_pipeline_handle_t pipeline){
+    audio_pipeline_pause(pipeline->audio_pipeline);
+};
+
+void recorder_pipeline_resume(recorder_pipeline_handle_t pipeline){
+    audio_pipeline_resume(pipeline->audio_pipeline);
+};
+
+void recorder_pipeline_set_tap(recorder_pipeline_handle_t pipeline, recorder_tap_cb_t cb, void *ctx){
+    pipeline->tap_ctx = ctx;
+    pipeline->tap_cb = cb;
+};
+
+void recorder_pipeline_set_forward(recorder_pipeline_handle_t pipeline, bool forward){
+    pipeline->tap_forward = forward;
+};
+
 int recorder_pipeline_get_default_read_size(recorder_pipeline_handle_t pipeline){
     #if defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS)
         return 80;
@@ -283,6 +440,7 @@ static audio_element_handle_t create_player_i2s_stream(void)
 {
     i2s_stream_cfg_t i2s_cfg = I2S_STREAM_CFG_DEFAULT_WITH_PARA(I2S_NUM_0, I2S_SAMPLE_RATE, ALGORITHM_STREAM_SAMPLE_BIT, AUDIO_STREAM_WRITER);
     i2s_cfg.type = AUDIO_STREAM_WRITER;
+    TASK_TOPOLOGY_APPLY(i2s_cfg, TASK_ID_PLAY_I2S);
 #ifdef CONFIG_ESP32_S3_KORVO2_V3_BOARD
     i2s_cfg.need_expand = (16 != 32);
 #endif
@@ -294,6 +452,215 @@ static audio_element_handle_t create_player_i2s_stream(void)
     return stream;
 }
 
+#if CONFIG_AUDIO_PLC_ENABLE
+static uint32_t plc_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+// 只统计 plc element 的输出 ringbuffer，下游 rsp/i2s 内部和 DMA 中的数据不计入
+static int plc_buffered_ms(player_pipeline_handle_t pipeline, audio_element_handle_t self)
+{
+    int bytes = rb_bytes_filled(audio_element_get_output_ringbuf(self));
+    return bytes / (int)sizeof(int16_t) * 1000 / pipeline->sample_rate;
+}
+
+static void playout_output(const int16_t *pcm, int samples, void *ctx)
+{
+    audio_element_output((audio_element_handle_t)ctx, (char *)pcm, samples * sizeof(int16_t));
+}
+#endif
+
+static void plc_output(const int16_t *pcm, int samples, void *ctx)
+{
+    audio_element_handle_t self = (audio_element_handle_t)ctx;
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+    player_pipeline_handle_t pipeline = (player_pipeline_handle_t)audio_element_getdata(self);
+    audio_playout_push(pipeline->playout, pcm, samples, plc_buffered_ms(pipeline, self), plc_now_ms());
+#else
+    audio_element_output(self, (char *)pcm, samples * sizeof(int16_t));
+#endif
+}
+
+#if CONFIG_AUDIO_REORDER_ENABLE
+static void reorder_release(uint16_t sent_ts, const uint8_t *data, size_t length, void *ctx)
+{
+    audio_plc_push((audio_plc_t *)ctx, sent_ts, data, length);
+}
+#endif
+
+#if PLC_TIMED_INPUT
+// 有帧在等待缺帧时按最早的超时时间读输入；自适应播放时播放缓冲降到低水位也要醒来
+static void plc_update_input_timeout(audio_element_handle_t self, player_pipeline_handle_t pipeline)
+{
+    uint32_t now_ms = plc_now_ms();
+    int32_t wait_ms = INT32_MAX;
+#if CONFIG_AUDIO_REORDER_ENABLE
+    uint32_t deadline_ms;
+    if (reorder_window_next_deadline(pipeline->reorder, &deadline_ms)) {
+        wait_ms = (int32_t)(deadline_ms - now_ms);
+    }
+#endif
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+    if (!pipeline->conceal_blocked) {
+        int32_t low_ms = plc_buffered_ms(pipeline, self) - PLAYOUT_LOW_WATER_MS;
+        if (low_ms < wait_ms) {
+            wait_ms = low_ms;
+        }
+    }
+#endif
+    if (wait_ms == INT32_MAX) {
+        audio_element_set_input_timeout(self, portMAX_DELAY);
+        return;
+    }
+    audio_element_set_input_timeout(self, wait_ms > 0 ? pdMS_TO_TICKS(wait_ms) + 1 : 1);
+}
+
+static void plc_input_timeout(audio_element_handle_t self, player_pipeline_handle_t pipeline)
+{
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+    if (!pipeline->conceal_blocked && plc_buffered_ms(pipeline, self) <= PLAYOUT_LOW_WATER_MS) {
+        // 缓冲快空了：有帧在等缺帧就不再等，否则提前隐藏下一帧，迟到的帧到达后丢弃
+#if CONFIG_AUDIO_REORDER_ENABLE
+        uint32_t deadline_ms;
+        if (reorder_window_next_deadline(pipeline->reorder, &deadline_ms)) {
+            reorder_window_flush(pipeline->reorder);
+            return;
+        }
+#endif
+        pipeline->conceal_blocked = !audio_plc_conceal_next(pipeline->plc);
+        return;
+    }
+#endif
+#if CONFIG_AUDIO_REORDER_ENABLE
+    reorder_window_poll(pipeline->reorder, plc_now_ms());
+#endif
+}
+#endif
+
+// 替代解码器：按帧读出 sent_ts 和数据，经过乱序窗口后交给 AudioPlc，缺帧时在这里生成隐藏帧，输出 PCM
+static audio_element_err_t plc_process(audio_element_handle_t self, char *in_buffer, int in_len)
+{
+    player_pipeline_handle_t pipeline = (player_pipeline_handle_t)audio_element_getdata(self);
+    uint8_t header[PLC_HEADER_SIZE];
+#if PLC_TIMED_INPUT
+    plc_update_input_timeout(self, pipeline);
+#endif
+    int r_size = audio_element_input(self, (char *)header, sizeof(header));
+#if PLC_TIMED_INPUT
+    if (r_size == AEL_IO_TIMEOUT) {
+        plc_input_timeout(self, pipeline);
+        return AEL_IO_TIMEOUT;
+    }
+    audio_element_set_input_timeout(self, portMAX_DELAY);
+    if (r_size > 0 && r_size < (int)sizeof(header)) {
+        // 写入方一次写完整帧，超时前只读到一部分时阻塞读完剩下的
+        int rest = audio_element_input(self, (char *)header + r_size, sizeof(header) - r_size);
+        r_size = rest <= 0 ? rest : r_size + rest;
+    }
+#endif
+    if (r_size != sizeof(header)) {
+        return r_size <= 0 ? r_size : AEL_IO_FAIL;
+    }
+    int length = (header[0] << 8) | header[1];
+    uint16_t sent_ts = (header[2] << 8) | header[3];
+    if (length > in_len) {
+        return AEL_IO_FAIL;
+    }
+    if (length > 0) {
+        r_size = audio_element_input(self, in_buffer, length);
+        if (r_size != length) {
+            return r_size <= 0 ? r_size : AEL_IO_FAIL;
+        }
+    }
+    if (pipeline->plc_reset) {
+        pipeline->plc_reset = false;
+        audio_plc_reset(pipeline->plc);
+#if CONFIG_AUDIO_REORDER_ENABLE
+        reorder_window_reset(pipeline->reorder);
+#endif
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+        audio_playout_reset(pipeline->playout);
+#endif
+    }
+    uint32_t arrival_ms = ((uint32_t)header[4] << 24) | (header[5] << 16) | (header[6] << 8) | header[7];
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+    audio_playout_on_arrival(pipeline->playout, sent_ts, arrival_ms);
+    pipeline->conceal_blocked = false;
+#endif
+#if CONFIG_AUDIO_REORDER_ENABLE
+    reorder_window_push(pipeline->reorder, sent_ts, arrival_ms, (const uint8_t *)in_buffer, length);
+#else
+    (void)arrival_ms;
+    audio_plc_push(pipeline->plc, sent_ts, (const uint8_t *)in_buffer, length);
+#endif
+    return sizeof(header) + length;
+}
+
+static audio_element_handle_t create_player_plc_stream(player_pipeline_handle_t pipeline)
+{
+    audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+    cfg.process = plc_process;
+    cfg.tag = "plc";
+    cfg.buffer_len = PLAYER_FRAME_MAX;
+    cfg.out_rb_size = 8 * 1024;
+    TASK_TOPOLOGY_APPLY(cfg, TASK_ID_PLAY_DECODER);
+    audio_element_handle_t stream = audio_element_init(&cfg);
+    audio_element_setdata(stream, pipeline);
+    audio_element_set_input_timeout(stream, portMAX_DELAY);
+
+#if defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS)
+#if CONFIG_AUDIO_PLC_OPUS_FEC
+    audio_plc_codec_t *codec = audio_plc_codec_opus_create(DEC_SAMPLE_RATE, true);
+#else
+    audio_plc_codec_t *codec = audio_plc_codec_opus_create(DEC_SAMPLE_RATE, false);
+#endif
+#elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_G711A)
+    audio_plc_codec_t *codec = audio_plc_codec_g711a_create();
+#else
+    audio_plc_codec_t *codec = audio_plc_codec_pcm_create(CODEC_SAMPLE_RATE);
+#endif
+    audio_plc_config_t plc_cfg = {
+        .frame_ms = PLC_FRAME_MS,
+        .max_gap_ms = CONFIG_AUDIO_PLC_MAX_GAP_MS,
+        .output = plc_output,
+        .ctx = stream,
+    };
+    pipeline->plc = audio_plc_create(codec, &plc_cfg);
+    mem_assert(pipeline->plc);
+#if CONFIG_AUDIO_REORDER_ENABLE
+    reorder_window_config_t reorder_cfg = {
+        .frame_ms = PLC_FRAME_MS,
+        .max_hold_ms = CONFIG_AUDIO_REORDER_HOLD_MS,
+        .max_depth = CONFIG_AUDIO_REORDER_MAX_DEPTH,
+        .max_gap_ms = CONFIG_AUDIO_PLC_MAX_GAP_MS,
+        .adapt_ms = REORDER_ADAPT_MS,
+        .max_frame_bytes = PLAYER_FRAME_MAX,
+        .release = reorder_release,
+        .ctx = pipeline->plc,
+    };
+    pipeline->reorder = reorder_window_create(&reorder_cfg);
+    mem_assert(pipeline->reorder);
+#endif
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+    audio_playout_config_t playout_cfg = {
+        .sample_rate = codec->sample_rate,
+        .min_delay_ms = CONFIG_AUDIO_PLAYOUT_MIN_DELAY_MS,
+        .max_delay_ms = CONFIG_AUDIO_PLAYOUT_MAX_DELAY_MS,
+        .max_gap_ms = CONFIG_AUDIO_PLC_MAX_GAP_MS,
+        .output = playout_output,
+        .ctx = stream,
+    };
+    pipeline->sample_rate = codec->sample_rate;
+    pipeline->conceal_blocked = true;
+    pipeline->playout = audio_playout_create(&playout_cfg);
+    mem_assert(pipeline->playout);
+#endif
+    return stream;
+}
+#endif
+
 static audio_element_handle_t create_player_decoder_stream(void)
 {
 #ifdef RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS
@@ -301,14 +668,16 @@ static audio_element_handle_t create_player_decoder_stream(void)
     opus_dec_cfg.enable_frame_length_prefix = true;
     opus_dec_cfg.sample_rate = DEC_SAMPLE_RATE;
     opus_dec_cfg.channels = 1;
-    opus_dec_cfg.task_core = 1;
+    TASK_TOPOLOGY_APPLY(opus_dec_cfg, TASK_ID_PLAY_DECODER);
     return raw_opus_decoder_init(&opus_dec_cfg);
 #elif RTC_DEMO_AUDIO_PIPELINE_CODEC_AAC
     aac_decoder_cfg_t  aac_dec_cfg  = DEFAULT_AAC_DECODER_CONFIG();
+    TASK_TOPOLOGY_APPLY(aac_dec_cfg, TASK_ID_PLAY_DECODER);
     return aac_decoder_init(&aac_dec_cfg);
 #elif RTC_DEMO_AUDIO_PIPELINE_CODEC_G711A
     g711_decoder_cfg_t g711_dec_cfg = DEFAULT_G711_DECODER_CONFIG();
     g711_dec_cfg.out_rb_size = 8 * 1024;
+    TASK_TOPOLOGY_APPLY(g711_dec_cfg, TASK_ID_PLAY_DECODER);
     return g711_decoder_init(&g711_dec_cfg);
 #else
     return NULL;
@@ -316,7 +685,7 @@ static audio_element_handle_t create_player_decoder_stream(void)
 }
 
 player_pipeline_handle_t player_pipeline_open(void) {
-    player_pipeline_handle_t player_pipeline = heap_caps_calloc(1, sizeof(player_pipeline_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_DEFAULT);
+    player_pipeline_handle_t player_pipeline = mem_class_calloc(MEM_CLASS_HOT_AUDIO, 1, sizeof(player_pipeline_t));
     esp_log_level_set("*", ESP_LOG_WARN);
     esp_log_level_set(TAG, ESP_LOG_INFO);
     assert(player_pipeline != 0);
@@ -333,17 +702,21 @@ player_pipeline_handle_t player_pipeline_open(void) {
     audio_pipeline_register(player_pipeline->audio_pipeline, player_pipeline->i2s_stream_writer, "i2s");
 
 #ifndef RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS
-    player_pipeline->rsp = create_resample_stream(CODEC_SAMPLE_RATE, 1, I2S_SAMPLE_RATE, CHANNEL_NUM);
+    player_pipeline->rsp = create_resample_stream(TASK_ID_PLAY_RSP, CODEC_SAMPLE_RATE, 1, I2S_SAMPLE_RATE, CHANNEL_NUM);
     audio_element_set_output_timeout(player_pipeline->rsp, portMAX_DELAY);
     audio_pipeline_register(player_pipeline->audio_pipeline, player_pipeline->rsp, "rsp");
 #endif
 
+#if CONFIG_AUDIO_PLC_ENABLE
+    player_pipeline->audio_decoder = create_player_plc_stream(player_pipeline);
+#else
     player_pipeline->audio_decoder = create_player_decoder_stream();
+#endif
     if (player_pipeline->audio_decoder != NULL) {
         audio_pipeline_register(player_pipeline->audio_pipeline, player_pipeline->audio_decoder, "dec");
     }
     
-#if defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_PCM)
+#if defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_PCM) && !CONFIG_AUDIO_PLC_ENABLE
     const char *link_tag[] = {"raw", "rsp", "i2s"};
 #elif defined(RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS)
 const char *link_tag[] = {"raw", "dec", "i2s"};
@@ -360,6 +733,14 @@ void player_pipeline_run(player_pipeline_handle_t player_pipeline){
     audio_pipeline_run(player_pipeline->audio_pipeline);
 };
 
+void player_pipeline_pause(player_pipeline_handle_t player_pipeline){
+    audio_pipeline_pause(player_pipeline->audio_pipeline);
+};
+
+void player_pipeline_resume(player_pipeline_handle_t player_pipeline){
+    audio_pipeline_resume(player_pipeline->audio_pipeline);
+};
+
 void player_pipeline_close(player_pipeline_handle_t player_pipeline){
     audio_pipeline_stop(player_pipeline->audio_pipeline);
     audio_pipeline_wait_for_stop(player_pipeline->audio_pipeline);
@@ -383,10 +764,80 @@ void player_pipeline_close(player_pipeline_handle_t player_pipeline){
     }
 
     audio_pipeline_deinit(player_pipeline->audio_pipeline);
-    heap_caps_free(player_pipeline);
+#if CONFIG_AUDIO_PLC_ENABLE
+#if CONFIG_AUDIO_REORDER_ENABLE
+    reorder_window_destroy(player_pipeline->reorder);
+#endif
+#if CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+    audio_playout_destroy(player_pipeline->playout);
+#endif
+    audio_plc_destroy(player_pipeline->plc);
+#endif
+    mem_class_free(MEM_CLASS_HOT_AUDIO, player_pipeline);
 };
 
 int player_pipeline_write(player_pipeline_handle_t player_pipeline, char *buffer, int buf_size){
     raw_stream_write(player_pipeline->raw_writer, buffer, buf_size);
     return 0;
-};
\ No newline at end of file
+};
+int player_pipeline_write_frame(player_pipeline_handle_t player_pipeline, uint16_t sent_ts, const void *data, size_t len){
+    if (len > PLAYER_FRAME_MAX) {
+        ESP_LOGW(TAG, "drop downlink frame of %d bytes", (int)len);
+        return -1;
+    }
+    uint8_t *frame = player_pipeline->frame;
+#if CONFIG_AUDIO_PLC_ENABLE
+    frame[0] = (len >> 8) & 0xFF;
+    frame[1] = len & 0xFF;
+    frame[2] = (sent_ts >> 8) & 0xFF;
+    frame[3] = sent_ts & 0xFF;
+    uint32_t arrival_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    frame[4] = (arrival_ms >> 24) & 0xFF;
+    frame[5] = (arrival_ms >> 16) & 0xFF;
+    frame[6] = (arrival_ms >> 8) & 0xFF;
+    frame[7] = arrival_ms & 0xFF;
+    memcpy(frame + PLC_HEADER_SIZE, data, len);
+    return player_pipeline_write(player_pipeline, (char *)frame, len + PLC_HEADER_SIZE);
+#elif defined (RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS)
+    // raw opus 解码器需要 2 字节的长度前缀
+    frame[0] = (len >> 8) & 0xFF;
+    frame[1] = len & 0xFF;
+    memcpy(frame + 2, data, len);
+    return player_pipeline_write(player_pipeline, (char *)frame, len + 2);
+#else
+    return player_pipeline_write(player_pipeline, (char *)data, len);
+#endif
+};
+
+void player_pipeline_reset_plc(player_pipeline_handle_t player_pipeline){
+#if CONFIG_AUDIO_PLC_ENABLE
+    player_pipeline->plc_reset = true;
+#endif
+};
+
+bool player_pipeline_get_plc_stats(player_pipeline_handle_t player_pipeline, audio_plc_stats_t *stats){
+#if CONFIG_AUDIO_PLC_ENABLE
+    audio_plc_get_stats(player_pipeline->plc, stats);
+    return true;
+#else
+    return false;
+#endif
+};
+
+bool player_pipeline_get_reorder_stats(player_pipeline_handle_t player_pipeline, reorder_window_stats_t *stats){
+#if CONFIG_AUDIO_PLC_ENABLE && CONFIG_AUDIO_REORDER_ENABLE
+    reorder_window_get_stats(player_pipeline->reorder, stats);
+    return true;
+#else
+    return false;
+#endif
+};
+
+bool player_pipeline_get_playout_stats(player_pipeline_handle_t player_pipeline, audio_playout_stats_t *stats){
+#if CONFIG_AUDIO_PLC_ENABLE && CONFIG_AUDIO_PLAYOUT_ADAPTIVE
+    audio_playout_get_stats(player_pipeline->playout, stats);
+    return true;
+#else
+    return false;
+#endif
+};
@@ -8,6 +8,9 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include "audio_pipeline.h"
+#include "AudioPlc.h"
+#include "ReorderWindow.h"
+#include "AudioPlayout.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,18 +32,37 @@ struct recorder_pipeline_t;
 typedef struct recorder_pipeline_t recorder_pipeline_t,*recorder_pipeline_handle_t;
 recorder_pipeline_handle_t recorder_pipeline_open();
 void recorder_pipeline_run(recorder_pipeline_handle_t);
+void recorder_pipeline_pause(recorder_pipeline_handle_t);
+void recorder_pipeline_resume(recorder_pipeline_handle_t);
 void recorder_pipeline_close(recorder_pipeline_handle_t);
 int recorder_pipeline_get_default_read_size(recorder_pipeline_handle_t);
 int recorder_pipeline_read(recorder_pipeline_handle_t,char *buffer, int buf_size);
+// 开启 CONFIG_WAKE_WORD_ENABLE 时 AFE 输出之后插入 tap element，回调在 tap 任务中执行
+typedef void (*recorder_tap_cb_t)(const int16_t *samples, int count, void *ctx);
+void recorder_pipeline_set_tap(recorder_pipeline_handle_t, recorder_tap_cb_t cb, void *ctx);
+// false 时 AFE 输出只交给 tap 回调，不编码也不上行
+void recorder_pipeline_set_forward(recorder_pipeline_handle_t, bool forward);
 
 struct  player_pipeline_t;
 typedef struct player_pipeline_t player_pipeline_t,*player_pipeline_handle_t;
 player_pipeline_handle_t player_pipeline_open();
 void player_pipeline_run(player_pipeline_handle_t);
+void player_pipeline_pause(player_pipeline_handle_t);
+void player_pipeline_resume(player_pipeline_handle_t);
 void player_pipeline_close(player_pipeline_handle_t);
 int player_pipeline_get_default_read_size(player_pipeline_handle_t);
 int player_pipeline_write(player_pipeline_handle_t,char *buffer, int buf_size);
 void player_pipeline_write_play_buffer_flag(player_pipeline_handle_t player_pipeline);
+// 写入一帧下行音频；开启 CONFIG_AUDIO_PLC_ENABLE 时按 sent_ts 重排、检测缺帧并生成隐藏帧
+int player_pipeline_write_frame(player_pipeline_handle_t, uint16_t sent_ts, const void *data, size_t len);
+// 新会话开始前调用，丢弃乱序窗口中的帧，sent_ts 重新同步
+void player_pipeline_reset_plc(player_pipeline_handle_t);
+// 未开启 PLC 时返回 false
+bool player_pipeline_get_plc_stats(player_pipeline_handle_t, audio_plc_stats_t *stats);
+// 未开启 CONFIG_AUDIO_REORDER_ENABLE 时返回 false
+bool player_pipeline_get_reorder_stats(player_pipeline_handle_t, reorder_window_stats_t *stats);
+// 未开启 CONFIG_AUDIO_PLAYOUT_ADAPTIVE 时返回 false
+bool player_pipeline_get_playout_stats(player_pipeline_handle_t, audio_playout_stats_t *stats);
 
 #ifdef __cplusplus
 }
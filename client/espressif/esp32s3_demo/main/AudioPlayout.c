@@ -0,0 +1,281 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 只依赖 libc 和 esp_log，主机上由 tools/netemu 的弱网模拟驱动
+
+#include "AudioPlayout.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "AUDIO_PLAYOUT";
+
+// 抖动估计：每个包到达的时刻减去 sent_ts 即相对时延，最近 DELAY_HISTORY 个包的最小值作为基准（随时钟漂移
+// 缓慢移动），超出基准的部分是这个包的抖动，进入带遗忘的直方图，取 98 分位加一个桶作为目标水位。
+// 水位 = 写入前的缓冲深度 + 最近一个包的抖动，即这个包准时到达时缓冲应有的深度，不随单个包的抖动跳动。
+// 丢包不计入抖动，由播放端在缓冲将空时提前隐藏
+#define DELAY_HISTORY           256     // 20ms 一帧约 5s
+#define BUCKET_MS               5
+#define BUCKET_COUNT            80      // 最多 400ms
+#define HISTOGRAM_FORGET        0.998f  // 时间常数约 500 个包
+#define JITTER_QUANTILE         0.98f
+
+// 伸缩：在一帧内找基音周期 T，去掉或重复一个周期并交叉淡化，所以 T 不超过半帧。
+// 清音或能量很低时相关性不可靠，直接按最小周期处理
+#define PITCH_MIN_US            2500
+#define PITCH_MAX_US            10000
+#define PITCH_MIN_CORR          0.6f
+#define QUIET_POWER             (100.0f * 100.0f)
+#define OP_COOLDOWN_FRAMES      1       // 两次伸缩之间至少间隔的帧数，变速不超过约 25%
+
+struct audio_playout_t {
+    audio_playout_config_t config;
+    bool synced;
+    uint16_t last_ts;
+    int32_t position_ms;        // 展开后的 sent_ts
+    uint32_t first_arrival_ms;
+    int jitter_ms;              // 最近到达的包的抖动
+    bool pushed;
+    uint32_t last_push_ms;
+    int32_t delays[DELAY_HISTORY];
+    int delay_count;
+    int delay_pos;
+    float histogram[BUCKET_COUNT];
+    int cooldown;
+    int16_t* work;
+    audio_playout_stats_t stats;
+};
+
+audio_playout_t* audio_playout_create(const audio_playout_config_t* config) {
+    audio_playout_t* playout = calloc(1, sizeof(audio_playout_t));
+    if (playout == NULL) {
+        return NULL;
+    }
+    playout->config = *config;
+    playout->work = malloc(2 * AUDIO_PLAYOUT_MAX_FRAME_SAMPLES * sizeof(int16_t));
+    if (playout->work == NULL) {
+        free(playout);
+        return NULL;
+    }
+    playout->stats.target_ms = config->min_delay_ms;
+    ESP_LOGI(TAG, "adaptive playout %d Hz, delay %d-%d ms", config->sample_rate, config->min_delay_ms, config->max_delay_ms);
+    return playout;
+}
+
+void audio_playout_destroy(audio_playout_t* playout) {
+    if (playout == NULL) {
+        return;
+    }
+    free(playout->work);
+    free(playout);
+}
+
+static void update_target(audio_playout_t* playout, int jitter_ms) {
+    int bucket = jitter_ms / BUCKET_MS;
+    if (bucket >= BUCKET_COUNT) {
+        bucket = BUCKET_COUNT - 1;
+    }
+    float total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        playout->histogram[i] *= HISTOGRAM_FORGET;
+        total += playout->histogram[i];
+    }
+    playout->histogram[bucket] += 1.0f - HISTOGRAM_FORGET;
+    total += 1.0f - HISTOGRAM_FORGET;
+
+    float sum = 0;
+    int quantile = BUCKET_COUNT - 1;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        sum += playout->histogram[i];
+        if (sum >= JITTER_QUANTILE * total) {
+            quantile = i;
+            break;
+        }
+    }
+    playout->stats.jitter_ms = (quantile + 1) * BUCKET_MS;
+    int target = (quantile + 2) * BUCKET_MS;
+    if (target < playout->config.min_delay_ms) {
+        target = playout->config.min_delay_ms;
+    }
+    if (target > playout->config.max_delay_ms) {
+        target = playout->config.max_delay_ms;
+    }
+    playout->stats.target_ms = target;
+}
+
+void audio_playout_on_arrival(audio_playout_t* playout, uint16_t sent_ts, uint32_t arrival_ms) {
+    int32_t position;
+    if (!playout->synced) {
+        playout->synced = true;
+        playout->last_ts = sent_ts;
+        playout->position_ms = 0;
+        playout->first_arrival_ms = arrival_ms;
+        playout->delay_count = 0;
+        playout->delay_pos = 0;
+        position = 0;
+    } else {
+        int16_t delta = (int16_t)(sent_ts - playout->last_ts);
+        position = playout->position_ms + delta;
+        if (delta > 0) {
+            playout->last_ts = sent_ts;
+            playout->position_ms = position;
+        }
+    }
+
+    int32_t delay = (int32_t)(arrival_ms - playout->first_arrival_ms) - position;
+    playout->delays[playout->delay_pos] = delay;
+    playout->delay_pos = (playout->delay_pos + 1) % DELAY_HISTORY;
+    if (playout->delay_count < DELAY_HISTORY) {
+        playout->delay_count++;
+    }
+    int32_t base = delay;
+    for (int i = 0; i < playout->delay_count; i++) {
+        if (playout->delays[i] < base) {
+            base = playout->delays[i];
+        }
+    }
+    playout->jitter_ms = delay - base;
+    update_target(playout, playout->jitter_ms);
+}
+
+static float power(const int16_t* x, int count) {
+    float sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += (float)x[i] * x[i];
+    }
+    return count > 0 ? sum / count : 0;
+}
+
+// 比较相邻两个长度为 T 的片段，返回归一化相关最大的 T，相关性不够时返回 0
+static int find_period(audio_playout_t* playout, const int16_t* x, int samples) {
+    int rate = playout->config.sample_rate;
+    int min_lag = (int)((int64_t)rate * PITCH_MIN_US / 1000000);
+    int max_lag = (int)((int64_t)rate * PITCH_MAX_US / 1000000);
+    if (max_lag > samples / 2) {
+        max_lag = samples / 2;
+    }
+    if (min_lag < 1 || min_lag > max_lag) {
+        return 0;
+    }
+    if (power(x, samples) < QUIET_POWER) {
+        return min_lag;
+    }
+    int best_lag = 0;
+    float best_corr = PITCH_MIN_CORR;
+    for (int lag = min_lag; lag <= max_lag; lag++) {
+        float xy = 0, xx = 0, yy = 0;
+        for (int i = 0; i < lag; i++) {
+            float a = x[i];
+            float b = x[i + lag];
+            xy += a * b;
+            xx += a * a;
+            yy += b * b;
+        }
+        if (xx <= 0 || yy <= 0) {
+            continue;
+        }
+        float corr = xy / sqrtf(xx * yy);
+        if (corr > best_corr) {
+            best_corr = corr;
+            best_lag = lag;
+        }
+    }
+    return best_lag;
+}
+
+// 前两个周期交叉淡化成一个，输出 samples - T 个样本
+static int compress(const int16_t* x, int samples, int period, int16_t* out) {
+    for (int i = 0; i < period; i++) {
+        float w = (float)i / period;
+        out[i] = (int16_t)lrintf(x[i] * (1.0f - w) + x[period + i] * w);
+    }
+    memcpy(out + period, x + 2 * period, (samples - 2 * period) * sizeof(int16_t));
+    return samples - period;
+}
+
+// 第一个周期之后插入一个从第二周期淡化回第一周期的片段，输出 samples + T 个样本
+static int stretch(const int16_t* x, int samples, int period, int16_t* out) {
+    memcpy(out, x, period * sizeof(int16_t));
+    for (int i = 0; i < period; i++) {
+        float w = (float)i / period;
+        out[period + i] = (int16_t)lrintf(x[period + i] * (1.0f - w) + x[i] * w);
+    }
+    memcpy(out + 2 * period, x + period, (samples - period) * sizeof(int16_t));
+    return samples + period;
+}
+
+static void output_silence(audio_playout_t* playout, int samples) {
+    memset(playout->work, 0, AUDIO_PLAYOUT_MAX_FRAME_SAMPLES * sizeof(int16_t));
+    while (samples > 0) {
+        int chunk = samples < AUDIO_PLAYOUT_MAX_FRAME_SAMPLES ? samples : AUDIO_PLAYOUT_MAX_FRAME_SAMPLES;
+        playout->config.output(playout->work, chunk, playout->config.ctx);
+        samples -= chunk;
+    }
+}
+
+void audio_playout_push(audio_playout_t* playout, const int16_t* pcm, int samples, int buffered_ms, uint32_t now_ms) {
+    if (samples <= 0) {
+        return;
+    }
+    if (samples > AUDIO_PLAYOUT_MAX_FRAME_SAMPLES) {
+        playout->config.output(pcm, samples, playout->config.ctx);
+        return;
+    }
+    playout->stats.frames++;
+    // 超过 max_gap_ms 没有数据说明上一句已经说完，这一帧是新一句的开头
+    bool talkspurt = !playout->pushed || (int32_t)(now_ms - playout->last_push_ms) > playout->config.max_gap_ms;
+    playout->pushed = true;
+    playout->last_push_ms = now_ms;
+    int target_ms = playout->stats.target_ms;
+    int frame_ms = samples * 1000 / playout->config.sample_rate;
+    int level_ms = buffered_ms + playout->jitter_ms;
+
+    if (talkspurt) {
+        // 句首前面本来就是静音，直接补到目标水位，不需要伸缩
+        playout->stats.talkspurts++;
+        if (level_ms < target_ms) {
+            int pad = (target_ms - level_ms) * playout->config.sample_rate / 1000;
+            playout->stats.inserted_samples += pad;
+            output_silence(playout, pad);
+        }
+        playout->config.output(pcm, samples, playout->config.ctx);
+        return;
+    }
+    if (playout->cooldown > 0) {
+        playout->cooldown--;
+        playout->config.output(pcm, samples, playout->config.ctx);
+        return;
+    }
+
+    // 水位在目标上下半帧之内不处理，避免来回伸缩
+    bool too_deep = level_ms > target_ms + frame_ms / 2;
+    bool too_shallow = level_ms < target_ms - frame_ms / 2;
+    int period = (too_deep || too_shallow) ? find_period(playout, pcm, samples) : 0;
+    if (period == 0) {
+        playout->config.output(pcm, samples, playout->config.ctx);
+        return;
+    }
+    int count;
+    if (too_deep) {
+        count = compress(pcm, samples, period, playout->work);
+        playout->stats.compressed++;
+        playout->stats.removed_samples += period;
+    } else {
+        count = stretch(pcm, samples, period, playout->work);
+        playout->stats.stretched++;
+        playout->stats.inserted_samples += period;
+    }
+    playout->cooldown = OP_COOLDOWN_FRAMES;
+    playout->config.output(playout->work, count, playout->config.ctx);
+}
+
+void audio_playout_reset(audio_playout_t* playout) {
+    playout->synced = false;
+    playout->pushed = false;
+    playout->cooldown = 0;
+}
+
+void audio_playout_get_stats(audio_playout_t* playout, audio_playout_stats_t* stats) {
+    *stats = playout->stats;
+}
@@ -0,0 +1,62 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __AUDIO_PLAYOUT_H__
+#define __AUDIO_PLAYOUT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 自适应播放：按下行包的到达时间估计抖动得到目标缓冲深度，对解码后的 PCM 做基音同步的
+// 时域伸缩（WSOLA，不改变音调），把播放缓冲保持在目标深度附近，同时吸收收发两端的时钟漂移。
+// 缓冲将空而下一帧还没到时由调用方提前隐藏（audio_plc_conceal_next），不计入这里的抖动
+#define AUDIO_PLAYOUT_MAX_FRAME_SAMPLES     1920
+
+typedef void (*audio_playout_output_cb_t)(const int16_t* pcm, int samples, void* ctx);
+
+typedef struct {
+    int sample_rate;
+    int min_delay_ms;           // 目标深度的下限，不小于播放端一次取数的粒度
+    int max_delay_ms;
+    int max_gap_ms;             // 超过这个时间没有数据视为新的一句话，开头补静音到目标深度
+    audio_playout_output_cb_t output;
+    void* ctx;
+} audio_playout_config_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t compressed;        // 去掉一个基音周期的帧
+    uint32_t stretched;         // 插入一个基音周期的帧
+    uint32_t talkspurts;
+    uint64_t removed_samples;
+    uint64_t inserted_samples;  // 伸长和句首补的静音
+    uint32_t jitter_ms;         // 当前估计的抖动（98 分位）
+    uint32_t target_ms;
+} audio_playout_stats_t;
+
+typedef struct audio_playout_t audio_playout_t;
+
+audio_playout_t* audio_playout_create(const audio_playout_config_t* config);
+void audio_playout_destroy(audio_playout_t* playout);
+
+// 每个下行包到达时调用（排序之前），arrival_ms 为本地时钟
+void audio_playout_on_arrival(audio_playout_t* playout, uint16_t sent_ts, uint32_t arrival_ms);
+
+// 送入按播放顺序解码好的一帧（包括隐藏帧），buffered_ms 为这一帧之前还没有播放的数据，now_ms 为本地时钟。
+// 伸缩后的结果通过 output 回调输出，在调用线程中执行
+void audio_playout_push(audio_playout_t* playout, const int16_t* pcm, int samples, int buffered_ms, uint32_t now_ms);
+
+// 新会话开始时调用，保留抖动的统计
+void audio_playout_reset(audio_playout_t* playout);
+
+void audio_playout_get_stats(audio_playout_t* playout, audio_playout_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __AUDIO_PLAYOUT_H__
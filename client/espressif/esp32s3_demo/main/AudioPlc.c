@@ -0,0 +1,348 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 只依赖 libc 和 esp_log，可以在主机上用 tools/netemu 的弱网模拟验证隐藏效果
+
+#include "AudioPlc.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "AUDIO_PLC";
+
+// 波形替换（参考 G.711 Appendix I）：丢包时重复最近的基音周期，连续丢包时逐步使用更多周期并衰减，
+// 恢复后把隐藏信号和新的一帧交叉淡化
+#define WS_HISTORY_MS           48
+#define WS_PITCH_MIN_US         2500    // 400Hz
+#define WS_PITCH_MAX_US         15000   // 66Hz
+#define WS_CORR_MS              10
+#define WS_FADE_START_MS        10      // 丢包 10ms 之后开始衰减
+#define WS_FADE_MS              50      // 再经过 50ms 衰减到 0
+#define WS_PERIOD_STEP_MS       10      // 每 10ms 多使用一个周期，最多 3 个
+#define WS_OLA_STEP_MS          4       // 每多丢 10ms，恢复时的交叉淡化加长 4ms
+
+#define MS_TO_SAMPLES(rate, ms) ((rate) * (ms) / 1000)
+
+typedef struct {
+    int sample_rate;
+    int pitch_min;
+    int pitch_max;
+    int16_t* history;           // 最近输出的样本，包括隐藏生成的
+    int history_len;
+    int16_t* loop;              // 丢包开始时的最后 3 个基音周期
+    int pitch;
+    int loop_offset;
+    int erased;                 // 当前丢包段已经生成的样本数，0 表示没有在丢包
+} plc_ws_t;
+
+static bool ws_init(plc_ws_t* ws, int sample_rate) {
+    ws->sample_rate = sample_rate;
+    ws->pitch_min = (int)((int64_t)sample_rate * WS_PITCH_MIN_US / 1000000);
+    ws->pitch_max = (int)((int64_t)sample_rate * WS_PITCH_MAX_US / 1000000);
+    ws->history_len = MS_TO_SAMPLES(sample_rate, WS_HISTORY_MS);
+    ws->history = calloc(ws->history_len, sizeof(int16_t));
+    ws->loop = calloc(3 * ws->pitch_max, sizeof(int16_t));
+    return ws->history && ws->loop;
+}
+
+static void ws_deinit(plc_ws_t* ws) {
+    free(ws->history);
+    free(ws->loop);
+}
+
+static void ws_append_history(plc_ws_t* ws, const int16_t* pcm, int samples) {
+    if (samples >= ws->history_len) {
+        memcpy(ws->history, pcm + samples - ws->history_len, ws->history_len * sizeof(int16_t));
+        return;
+    }
+    memmove(ws->history, ws->history + samples, (ws->history_len - samples) * sizeof(int16_t));
+    memcpy(ws->history + ws->history_len - samples, pcm, samples * sizeof(int16_t));
+}
+
+// 归一化互相关找基音周期，信号太弱时返回最大周期，重复出来的只是低能量噪声
+static int ws_find_pitch(plc_ws_t* ws) {
+    int window = MS_TO_SAMPLES(ws->sample_rate, WS_CORR_MS);
+    const int16_t* x = ws->history + ws->history_len - window;
+    float energy = 0;
+    for (int n = 0; n < window; n++) {
+        energy += (float)x[n] * x[n];
+    }
+    int best = ws->pitch_max;
+    float best_score = 0;
+    for (int lag = ws->pitch_min; lag <= ws->pitch_max; lag++) {
+        const int16_t* y = x - lag;
+        float corr = 0;
+        float lag_energy = 0;
+        for (int n = 0; n < window; n++) {
+            corr += (float)x[n] * y[n];
+            lag_energy += (float)y[n] * y[n];
+        }
+        if (corr <= 0 || lag_energy <= 0 || energy <= 0) {
+            continue;
+        }
+        float score = corr / sqrtf(energy * lag_energy);
+        if (score > best_score) {
+            best_score = score;
+            best = lag;
+        }
+    }
+    return best;
+}
+
+static int ws_periods(plc_ws_t* ws) {
+    int periods = 1 + ws->erased / MS_TO_SAMPLES(ws->sample_rate, WS_PERIOD_STEP_MS);
+    return periods > 3 ? 3 : periods;
+}
+
+static float ws_gain(plc_ws_t* ws) {
+    int start = MS_TO_SAMPLES(ws->sample_rate, WS_FADE_START_MS);
+    int length = MS_TO_SAMPLES(ws->sample_rate, WS_FADE_MS);
+    if (ws->erased <= start) {
+        return 1.0f;
+    }
+    float gain = 1.0f - (float)(ws->erased - start) / length;
+    return gain > 0 ? gain : 0;
+}
+
+// 从 loop 末尾的 periods 个周期中循环取样，loop_offset 从最后一个周期的开头开始，和真实信号相位连续
+static int16_t ws_next_sample(plc_ws_t* ws) {
+    int span = ws_periods(ws) * ws->pitch;
+    int base = 3 * ws->pitch - span;
+    int16_t sample = ws->loop[base + ws->loop_offset % span];
+    ws->loop_offset++;
+    return (int16_t)(sample * ws_gain(ws));
+}
+
+static void ws_conceal(plc_ws_t* ws, int16_t* pcm, int samples) {
+    if (ws->erased == 0) {
+        ws->pitch = ws_find_pitch(ws);
+        memcpy(ws->loop, ws->history + ws->history_len - 3 * ws->pitch, 3 * ws->pitch * sizeof(int16_t));
+        ws->loop_offset = 2 * ws->pitch;
+    }
+    for (int i = 0; i < samples; i++) {
+        pcm[i] = ws_next_sample(ws);
+        ws->erased++;
+    }
+    ws_append_history(ws, pcm, samples);
+}
+
+// 正常帧：如果前面在丢包，把隐藏信号的延续和这一帧交叉淡化
+static void ws_good_frame(plc_ws_t* ws, int16_t* pcm, int samples) {
+    if (ws->erased > 0) {
+        int ola = ws->pitch / 4 + MS_TO_SAMPLES(ws->sample_rate, WS_OLA_STEP_MS) *
+                  (ws->erased / MS_TO_SAMPLES(ws->sample_rate, 10));
+        if (ola > samples) {
+            ola = samples;
+        }
+        for (int i = 0; i < ola; i++) {
+            float w = (float)(i + 1) / (ola + 1);
+            pcm[i] = (int16_t)(pcm[i] * w + ws_next_sample(ws) * (1.0f - w));
+        }
+        ws->erased = 0;
+    }
+    ws_append_history(ws, pcm, samples);
+}
+
+typedef struct {
+    plc_ws_t ws;
+    bool alaw;
+} plc_linear_t;
+
+static int16_t alaw_to_linear(uint8_t value) {
+    value ^= 0x55;
+    int t = (value & 0x0F) << 4;
+    int seg = (value & 0x70) >> 4;
+    if (seg == 0) {
+        t += 8;
+    } else {
+        t += 0x108;
+        if (seg > 1) {
+            t <<= seg - 1;
+        }
+    }
+    return (value & 0x80) ? t : -t;
+}
+
+static int linear_decode(audio_plc_codec_t* codec, const uint8_t* data, size_t length, int16_t* pcm, int max_samples) {
+    plc_linear_t* linear = codec->priv;
+    int samples = linear->alaw ? (int)length : (int)(length / sizeof(int16_t));
+    if (samples > max_samples) {
+        return -1;
+    }
+    if (linear->alaw) {
+        for (int i = 0; i < samples; i++) {
+            pcm[i] = alaw_to_linear(data[i]);
+        }
+    } else {
+        for (int i = 0; i < samples; i++) {
+            pcm[i] = (int16_t)(data[2 * i] | (data[2 * i + 1] << 8));
+        }
+    }
+    ws_good_frame(&linear->ws, pcm, samples);
+    return samples;
+}
+
+static int linear_conceal(audio_plc_codec_t* codec, int16_t* pcm, int samples) {
+    plc_linear_t* linear = codec->priv;
+    ws_conceal(&linear->ws, pcm, samples);
+    return samples;
+}
+
+static void linear_destroy(audio_plc_codec_t* codec) {
+    plc_linear_t* linear = codec->priv;
+    ws_deinit(&linear->ws);
+    free(linear);
+    free(codec);
+}
+
+static audio_plc_codec_t* linear_create(const char* name, int sample_rate, bool alaw) {
+    audio_plc_codec_t* codec = calloc(1, sizeof(audio_plc_codec_t));
+    plc_linear_t* linear = calloc(1, sizeof(plc_linear_t));
+    if (codec == NULL || linear == NULL || !ws_init(&linear->ws, sample_rate)) {
+        if (linear) {
+            ws_deinit(&linear->ws);
+        }
+        free(linear);
+        free(codec);
+        return NULL;
+    }
+    linear->alaw = alaw;
+    codec->name = name;
+    codec->sample_rate = sample_rate;
+    codec->decode = linear_decode;
+    codec->conceal = linear_conceal;
+    codec->destroy = linear_destroy;
+    codec->priv = linear;
+    return codec;
+}
+
+audio_plc_codec_t* audio_plc_codec_pcm_create(int sample_rate) {
+    return linear_create("pcm", sample_rate, false);
+}
+
+audio_plc_codec_t* audio_plc_codec_g711a_create(void) {
+    return linear_create("g711a", 8000, true);
+}
+
+struct audio_plc_t {
+    audio_plc_codec_t* codec;
+    audio_plc_config_t config;
+    int16_t* pcm;
+    bool synced;
+    uint16_t last_ts;           // 最后输出的位置，包括播放端提前隐藏的帧
+    uint16_t received_ts;       // 最后一个收到的帧
+    int frame_samples;          // 最近一次正常解码的样本数，隐藏帧使用同样的长度
+    audio_plc_stats_t stats;
+};
+
+audio_plc_t* audio_plc_create(audio_plc_codec_t* codec, const audio_plc_config_t* config) {
+    if (codec == NULL) {
+        return NULL;
+    }
+    audio_plc_t* plc = calloc(1, sizeof(audio_plc_t));
+    if (plc == NULL || (plc->pcm = malloc(AUDIO_PLC_MAX_FRAME_SAMPLES * sizeof(int16_t))) == NULL) {
+        free(plc);
+        codec->destroy(codec);
+        return NULL;
+    }
+    plc->codec = codec;
+    plc->config = *config;
+    plc->frame_samples = MS_TO_SAMPLES(codec->sample_rate, config->frame_ms);
+    ESP_LOGI(TAG, "%s plc, frame %d ms, max gap %d ms, fec %s", codec->name, config->frame_ms, config->max_gap_ms,
+             codec->recover ? "on" : "off");
+    return plc;
+}
+
+void audio_plc_destroy(audio_plc_t* plc) {
+    if (plc == NULL) {
+        return;
+    }
+    plc->codec->destroy(plc->codec);
+    free(plc->pcm);
+    free(plc);
+}
+
+static void plc_output(audio_plc_t* plc, int samples) {
+    if (samples > 0 && plc->config.output) {
+        plc->config.output(plc->pcm, samples, plc->config.ctx);
+    }
+}
+
+void audio_plc_push(audio_plc_t* plc, uint16_t sent_ts, const uint8_t* data, size_t length) {
+    audio_plc_codec_t* codec = plc->codec;
+    if (plc->synced) {
+        int16_t delta = (int16_t)(sent_ts - plc->last_ts);
+        if (delta <= 0) {
+            // 位置已经被提前隐藏的帧占用时也算迟到
+            if (sent_ts == plc->received_ts) {
+                plc->stats.duplicates++;
+            } else {
+                plc->stats.late++;
+            }
+            return;
+        }
+        int frame_ms = plc->frame_samples * 1000 / codec->sample_rate;
+        int missing = frame_ms > 0 ? (delta + frame_ms / 2) / frame_ms - 1 : 0;
+        if (delta > plc->config.max_gap_ms) {
+            plc->stats.resyncs++;
+            missing = 0;
+        }
+        for (int i = 0; i < missing; i++) {
+            // 只有紧挨着这一帧的丢失帧能从它的 FEC 恢复
+            int samples = -1;
+            if (i == missing - 1 && codec->recover) {
+                samples = codec->recover(codec, data, length, plc->pcm, plc->frame_samples);
+                if (samples > 0) {
+                    plc->stats.fec_recovered++;
+                }
+            }
+            if (samples <= 0) {
+                samples = codec->conceal(codec, plc->pcm, plc->frame_samples);
+                plc->stats.concealed++;
+            }
+            plc_output(plc, samples);
+        }
+    }
+    plc->synced = true;
+    plc->last_ts = sent_ts;
+    plc->received_ts = sent_ts;
+
+    int samples = codec->decode(codec, data, length, plc->pcm, AUDIO_PLC_MAX_FRAME_SAMPLES);
+    if (samples < 0) {
+        plc->stats.decode_errors++;
+        samples = codec->conceal(codec, plc->pcm, plc->frame_samples);
+        plc->stats.concealed++;
+    } else {
+        plc->stats.frames++;
+        if (samples > 0) {
+            plc->frame_samples = samples;
+        }
+    }
+    plc_output(plc, samples);
+}
+
+bool audio_plc_conceal_next(audio_plc_t* plc) {
+    if (!plc->synced) {
+        return false;
+    }
+    int frame_ms = plc->frame_samples * 1000 / plc->codec->sample_rate;
+    uint16_t next_ts = plc->last_ts + frame_ms;
+    if ((int16_t)(next_ts - plc->received_ts) > plc->config.max_gap_ms) {
+        return false;
+    }
+    plc->last_ts = next_ts;
+    int samples = plc->codec->conceal(plc->codec, plc->pcm, plc->frame_samples);
+    plc->stats.concealed++;
+    plc->stats.early_concealed++;
+    plc_output(plc, samples);
+    return true;
+}
+
+void audio_plc_reset(audio_plc_t* plc) {
+    plc->synced = false;
+}
+
+void audio_plc_get_stats(audio_plc_t* plc, audio_plc_stats_t* stats) {
+    *stats = plc->stats;
+}
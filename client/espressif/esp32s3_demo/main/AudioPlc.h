@@ -0,0 +1,81 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __AUDIO_PLC_H__
+#define __AUDIO_PLC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_PLC_MAX_FRAME_SAMPLES     1920    // 16k 下 120ms
+
+// 下行解码接口：正常解码、丢包隐藏、用下一包的带内 FEC 恢复。Opus 之外的实现都用波形替换做隐藏
+typedef struct audio_plc_codec_t audio_plc_codec_t;
+struct audio_plc_codec_t {
+    const char* name;
+    int sample_rate;
+    // 返回输出的样本数，出错返回 -1
+    int (*decode)(audio_plc_codec_t* codec, const uint8_t* data, size_t length, int16_t* pcm, int max_samples);
+    // 生成 samples 个样本的隐藏数据
+    int (*conceal)(audio_plc_codec_t* codec, int16_t* pcm, int samples);
+    // 用 next 中的 FEC 数据恢复它前面丢失的一帧，不支持时为 NULL
+    int (*recover)(audio_plc_codec_t* codec, const uint8_t* next, size_t length, int16_t* pcm, int samples);
+    void (*destroy)(audio_plc_codec_t* codec);
+    void* priv;
+};
+
+// PCM16 小端单声道
+audio_plc_codec_t* audio_plc_codec_pcm_create(int sample_rate);
+// G.711 A-law，8k
+audio_plc_codec_t* audio_plc_codec_g711a_create(void);
+// esp_audio_codec 的 Opus 解码器，隐藏和 FEC 由解码器完成，只在设备上编译
+audio_plc_codec_t* audio_plc_codec_opus_create(int sample_rate, bool fec);
+
+typedef void (*audio_plc_output_cb_t)(const int16_t* pcm, int samples, void* ctx);
+
+typedef struct {
+    int frame_ms;               // 收到第一帧之前假定的帧长，之后按实际解码的样本数计算
+    int max_gap_ms;             // sent_ts 间隔超过这个值视为智能体停顿，不做隐藏直接重新同步
+    audio_plc_output_cb_t output;
+    void* ctx;
+} audio_plc_config_t;
+
+typedef struct {
+    uint32_t frames;            // 正常解码的帧
+    uint32_t concealed;         // 丢包隐藏生成的帧
+    uint32_t early_concealed;   // 其中播放缓冲将空时提前生成的
+    uint32_t fec_recovered;     // 由下一包 FEC 恢复的帧
+    uint32_t late;              // sent_ts 早于已经播放或提前隐藏的帧，丢弃
+    uint32_t duplicates;
+    uint32_t resyncs;           // 间隔超过 max_gap_ms
+    uint32_t decode_errors;     // 解码失败，按丢包隐藏处理
+} audio_plc_stats_t;
+
+typedef struct audio_plc_t audio_plc_t;
+
+// plc 持有 codec，destroy 时一起释放
+audio_plc_t* audio_plc_create(audio_plc_codec_t* codec, const audio_plc_config_t* config);
+void audio_plc_destroy(audio_plc_t* plc);
+
+// 按播放顺序送入一帧，sent_ts 的间隔说明中间少了几帧，先输出隐藏帧再输出这一帧。
+// 所有输出都通过 output 回调，在调用线程中执行
+void audio_plc_push(audio_plc_t* plc, uint16_t sent_ts, const uint8_t* data, size_t length);
+
+// 播放缓冲将空而下一帧还没到时调用，立即输出一帧隐藏数据，之后到达的这一帧按迟到丢弃。
+// 距最后收到的帧超过 max_gap_ms 后不再隐藏（智能体停顿），返回 false
+bool audio_plc_conceal_next(audio_plc_t* plc);
+
+// 新会话的 sent_ts 和上一次没有关系，需要重新同步
+void audio_plc_reset(audio_plc_t* plc);
+
+void audio_plc_get_stats(audio_plc_t* plc, audio_plc_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __AUDIO_PLC_H__
@@ -0,0 +1,25 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "Backoff.h"
+#include "esp_random.h"
+
+void backoff_init(backoff_t* backoff, uint32_t base_ms, uint32_t max_ms) {
+    backoff->base_ms = base_ms;
+    backoff->max_ms = max_ms < base_ms ? base_ms : max_ms;
+    backoff->attempt = 0;
+}
+
+uint32_t backoff_next_ms(backoff_t* backoff) {
+    uint64_t delay = (uint64_t)backoff->base_ms << (backoff->attempt < 32 ? backoff->attempt : 32);
+    uint32_t cap = delay < backoff->max_ms ? (uint32_t)delay : backoff->max_ms;
+    if (cap < backoff->max_ms) {
+        backoff->attempt++;
+    }
+    uint32_t half = cap / 2;
+    return half + (half ? esp_random() % (cap - half + 1) : 0);
+}
+
+void backoff_reset(backoff_t* backoff) {
+    backoff->attempt = 0;
+}
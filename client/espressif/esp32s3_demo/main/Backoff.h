@@ -0,0 +1,30 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __BACKOFF_H__
+#define __BACKOFF_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 带随机抖动的指数退避，避免大量设备在网络恢复后同时重连
+typedef struct {
+    uint32_t base_ms;
+    uint32_t max_ms;
+    uint32_t attempt;
+} backoff_t;
+
+void backoff_init(backoff_t* backoff, uint32_t base_ms, uint32_t max_ms);
+
+// 返回下一次重试前需要等待的时间，在 [cap/2, cap] 之间随机，cap = min(max_ms, base_ms * 2^attempt)
+uint32_t backoff_next_ms(backoff_t* backoff);
+
+void backoff_reset(backoff_t* backoff);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __BACKOFF_H__
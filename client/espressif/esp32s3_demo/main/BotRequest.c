@@ -0,0 +1,107 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "BotRequest.h"
+#include <stdio.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include "JsonArena.h"
+#include "MemPlacement.h"
+
+static const char *TAG = "BOT_REQUEST";
+
+#if CONFIG_AIGENT_CONTROL_TLV
+// TLV 编解码不使用 cJSON，arena 只用来串行化请求
+#define BOT_ARENA_SIZE              256
+#else
+#define BOT_ARENA_SIZE              (6 * 1024)
+#endif
+
+static json_arena_t json_arena;
+static char* response_buffer = NULL;
+static portMUX_TYPE init_lock = portMUX_INITIALIZER_UNLOCKED;
+
+bool bot_request_init(void) {
+    if (response_buffer != NULL) {
+        return true;
+    }
+    void* arena_buffer = mem_class_malloc(MEM_CLASS_CONTROL, BOT_ARENA_SIZE);
+    char* buffer = mem_class_malloc(MEM_CLASS_CONTROL, BOT_RESPONSE_BUFFER_SIZE);
+    if (arena_buffer == NULL || buffer == NULL) {
+        mem_class_free(MEM_CLASS_CONTROL, arena_buffer);
+        mem_class_free(MEM_CLASS_CONTROL, buffer);
+        ESP_LOGE(TAG, "Failed to alloc control plane buffers");
+        return false;
+    }
+    // 并发初始化时只保留一份
+    portENTER_CRITICAL(&init_lock);
+    bool installed = (response_buffer == NULL);
+    if (installed) {
+        json_arena_init(&json_arena, arena_buffer, BOT_ARENA_SIZE);
+        response_buffer = buffer;
+    }
+    portEXIT_CRITICAL(&init_lock);
+    if (!installed) {
+        mem_class_free(MEM_CLASS_CONTROL, arena_buffer);
+        mem_class_free(MEM_CLASS_CONTROL, buffer);
+    }
+    return true;
+}
+
+bool bot_request_begin(void) {
+    if (response_buffer == NULL) {
+        ESP_LOGE(TAG, "bot_request_init not called");
+        return false;
+    }
+    json_arena_begin(&json_arena);
+    return true;
+}
+
+void bot_request_end(void) {
+    json_arena_end(&json_arena);
+}
+
+rtc_req_result_t bot_request_post(const char* uri, const char** headers, const char* post_data, int post_data_len) {
+    rtc_post_config_t post_config = {
+        .uri = uri,
+        .headers = headers,
+        .post_data = post_data,
+        .post_data_len = post_data_len,
+        .response_buffer = response_buffer,
+        .response_buffer_size = BOT_RESPONSE_BUFFER_SIZE,
+    };
+    return rtc_http_post(&post_config);
+}
+
+bool bot_request_parse_json(const char* response, int response_len, int code, cJSON** data) {
+    cJSON* root = NULL;
+    if (response != NULL && response_len > 0) {
+        root = cJSON_ParseWithLength(response, response_len);
+    }
+    if (code != 200) {
+        if (root != NULL) {
+            const char* message = cJSON_GetStringValue(cJSON_GetObjectItem(root, "message"));
+            ESP_LOGE(TAG, "Error: %s", message ? message : "");
+        }
+        return false;
+    }
+    if (root == NULL) {
+        ESP_LOGE(TAG, "Error parsing JSON");
+        return false;
+    }
+    *data = cJSON_GetObjectItem(root, "data");
+    if (*data == NULL) {
+        ESP_LOGE(TAG, "Not found data object.");
+        return false;
+    }
+    return true;
+}
+
+bool bot_request_print_json(cJSON* obj, char* buffer, int buffer_size) {
+    if (obj == NULL || !cJSON_PrintPreallocated(obj, buffer, buffer_size, false)) {
+        ESP_LOGE(TAG, "Failed to print json, buffer size %d", buffer_size);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,36 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __BOT_REQUEST_H__
+#define __BOT_REQUEST_H__
+
+#include <stdbool.h>
+#include "cJSON.h"
+#include "RtcHttpUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 控制面请求（启动、停止智能体等）共用的 json arena 和响应 buffer，RtcBotUtils 和 CozeBotUtils 都通过这里发请求。
+// bot_request_begin/bot_request_end 之间 cJSON 从 arena 分配、响应写入共用 buffer，每次请求都不再申请堆内存；
+// 同一时刻只有一个请求，其它任务的请求阻塞等待
+#define BOT_RESPONSE_BUFFER_SIZE    2048
+
+// 启动时在任何请求之前调用一次，分配 arena 和响应 buffer，重复调用是安全的
+bool bot_request_init(void);
+// 开始一次请求，没有初始化时返回 false
+bool bot_request_begin(void);
+// 结束请求，之前解析出的 cJSON 对象和响应内容不能再使用
+void bot_request_end(void);
+// 发送 POST，响应写入共用 buffer；post_data_len 为 0 时 post_data 按字符串处理
+rtc_req_result_t bot_request_post(const char* uri, const char** headers, const char* post_data, int post_data_len);
+// 解析 json 响应，失败时记录服务端的错误信息，成功返回 true 并通过 data 返回其中的 data 对象
+bool bot_request_parse_json(const char* response, int response_len, int code, cJSON** data);
+// 将 json 对象写入调用方提供的定长 buffer，不产生额外的堆分配
+bool bot_request_print_json(cJSON* obj, char* buffer, int buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __BOT_REQUEST_H__
@@ -0,0 +1,84 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "ControlTlv.h"
+#include <string.h>
+
+#define CONTROL_TLV_MAX_VALUE_LEN   0xffff
+
+void control_tlv_writer_init(control_tlv_writer_t* writer, void* buffer, size_t size) {
+    writer->buffer = buffer;
+    writer->size = size;
+    writer->len = 0;
+    writer->overflow = false;
+}
+
+static bool control_tlv_put(control_tlv_writer_t* writer, uint8_t tag, const void* value, size_t value_len) {
+    if (writer->overflow || value_len > CONTROL_TLV_MAX_VALUE_LEN ||
+        writer->len + CONTROL_TLV_HEADER_SIZE + value_len > writer->size) {
+        writer->overflow = true;
+        return false;
+    }
+    uint8_t* p = writer->buffer + writer->len;
+    p[0] = tag;
+    p[1] = (uint8_t)(value_len >> 8);
+    p[2] = (uint8_t)value_len;
+    if (value_len > 0) {
+        memcpy(p + CONTROL_TLV_HEADER_SIZE, value, value_len);
+    }
+    writer->len += CONTROL_TLV_HEADER_SIZE + value_len;
+    return true;
+}
+
+bool control_tlv_put_string(control_tlv_writer_t* writer, uint8_t tag, const char* value) {
+    return control_tlv_put(writer, tag, value, value ? strlen(value) : 0);
+}
+
+bool control_tlv_put_uint(control_tlv_writer_t* writer, uint8_t tag, uint32_t value) {
+    uint8_t raw[4] = {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+    return control_tlv_put(writer, tag, raw, sizeof(raw));
+}
+
+bool control_tlv_put_bool(control_tlv_writer_t* writer, uint8_t tag, bool value) {
+    uint8_t raw = value ? 1 : 0;
+    return control_tlv_put(writer, tag, &raw, 1);
+}
+
+bool control_tlv_find(const uint8_t* data, size_t len, uint8_t tag, const uint8_t** value, size_t* value_len) {
+    size_t pos = 0;
+    while (pos + CONTROL_TLV_HEADER_SIZE <= len) {
+        size_t field_len = ((size_t)data[pos + 1] << 8) | data[pos + 2];
+        if (pos + CONTROL_TLV_HEADER_SIZE + field_len > len) {
+            return false;
+        }
+        if (data[pos] == tag) {
+            *value = data + pos + CONTROL_TLV_HEADER_SIZE;
+            *value_len = field_len;
+            return true;
+        }
+        pos += CONTROL_TLV_HEADER_SIZE + field_len;
+    }
+    return false;
+}
+
+bool control_tlv_copy_string(const uint8_t* data, size_t len, uint8_t tag, char* dst, size_t dst_size) {
+    const uint8_t* value = NULL;
+    size_t value_len = 0;
+    dst[0] = 0;
+    if (!control_tlv_find(data, len, tag, &value, &value_len) || value_len >= dst_size) {
+        return false;
+    }
+    memcpy(dst, value, value_len);
+    dst[value_len] = 0;
+    return true;
+}
+
+bool control_tlv_get_uint(const uint8_t* data, size_t len, uint8_t tag, uint32_t* value) {
+    const uint8_t* raw = NULL;
+    size_t raw_len = 0;
+    if (!control_tlv_find(data, len, tag, &raw, &raw_len) || raw_len != 4) {
+        return false;
+    }
+    *value = ((uint32_t)raw[0] << 24) | ((uint32_t)raw[1] << 16) | ((uint32_t)raw[2] << 8) | raw[3];
+    return true;
+}
@@ -0,0 +1,66 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __CONTROL_TLV_H__
+#define __CONTROL_TLV_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 和示例服务端之间控制请求的紧凑编码（server/src/ControlTlv.py），按 Content-Type 协商。
+// 每个字段为 tag(1 字节) + 长度(2 字节，大端) + 值：字符串不带结尾的 0，整数 4 字节大端，布尔 1 字节，
+// 响应的 data 为嵌套的 TLV。编码写入调用方的 buffer，解码直接在响应 buffer 上查找，都不分配内存
+#define CONTROL_TLV_CONTENT_TYPE    "application/x-rtc-tlv"
+#define CONTROL_TLV_HEADER_SIZE     3
+
+typedef enum {
+    CONTROL_TLV_APP_ID              = 0x01,
+    CONTROL_TLV_ROOM_ID             = 0x02,
+    CONTROL_TLV_UID                 = 0x03,
+    CONTROL_TLV_TASK_ID             = 0x04,
+    CONTROL_TLV_BOT_UID             = 0x05,
+    CONTROL_TLV_TOKEN               = 0x06,
+    CONTROL_TLV_AUDIO_CODEC         = 0x07,
+    CONTROL_TLV_ROOM_IDENTIFIER     = 0x08,
+    CONTROL_TLV_DEVICE_ID           = 0x09,
+    CONTROL_TLV_COMMAND             = 0x0a,
+    CONTROL_TLV_MESSAGE             = 0x0b,
+    CONTROL_TLV_ENABLE_BURST        = 0x0c,
+    CONTROL_TLV_BURST_BUFFER_SIZE   = 0x0d,
+    CONTROL_TLV_BURST_INTERVAL      = 0x0e,
+    CONTROL_TLV_UID_IDENTIFIER      = 0x0f,
+    CONTROL_TLV_BOT_IDENTIFIER      = 0x10,
+    CONTROL_TLV_RETRY_AFTER         = 0x11,     // 429 响应中建议的重试时间，和 Retry-After 头相同
+    CONTROL_TLV_RESUMED             = 0x12,     // resumevoicechat 响应，是否恢复了原来的会话
+    CONTROL_TLV_CODE                = 0x40,
+    CONTROL_TLV_MSG                 = 0x41,
+    CONTROL_TLV_DATA                = 0x42,
+} control_tlv_tag_e;
+
+typedef struct {
+    uint8_t* buffer;
+    size_t size;
+    size_t len;
+    bool overflow;              // 有字段没有写入，整个请求不能使用
+} control_tlv_writer_t;
+
+void control_tlv_writer_init(control_tlv_writer_t* writer, void* buffer, size_t size);
+bool control_tlv_put_string(control_tlv_writer_t* writer, uint8_t tag, const char* value);
+bool control_tlv_put_uint(control_tlv_writer_t* writer, uint8_t tag, uint32_t value);
+bool control_tlv_put_bool(control_tlv_writer_t* writer, uint8_t tag, bool value);
+
+// 在 data 中按顺序查找第一个 tag，value 指向 data 内部；格式错误或没有找到时返回 false
+bool control_tlv_find(const uint8_t* data, size_t len, uint8_t tag, const uint8_t** value, size_t* value_len);
+// 复制字符串字段并补 0，没有找到或放不下时 dst 为空串并返回 false
+bool control_tlv_copy_string(const uint8_t* data, size_t len, uint8_t tag, char* dst, size_t dst_size);
+bool control_tlv_get_uint(const uint8_t* data, size_t len, uint8_t tag, uint32_t* value);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __CONTROL_TLV_H__
@@ -5,33 +5,43 @@
 #include "RtcHttpUtils.h"
 #include "cJSON.h"
 #include "esp_log.h"
-#include "esp_heap_caps.h"
+#include "BotRequest.h"
+#include <stdio.h>
 #include <string.h>
 
 static const char *TAG = "RTC_BOT_UTILS";
 
-static void *impl_malloc_fn(size_t size) {
-    uint32_t allocate_caps = 0;
-#if CONFIG_PSRAM
-    allocate_caps = MALLOC_CAP_SPIRAM;
-#else
-    allocate_caps = MALLOC_CAP_INTERNAL;
-#endif
-    return heap_caps_malloc(size, allocate_caps);
-}
-
-static void impl_free_fn(void *ptr) {
-    heap_caps_free(ptr);
-}
-
 const char* common_headers[] = {
     "Content-Type", "application/json",
     "Authorization", "Bearer " CONFIG_COZE_AUTH,
     NULL
 };
 
+#define POST_DATA_SIZE              1024
+
+static void copy_json_string(char* dst, size_t dst_size, const cJSON* obj, const char* key) {
+    const char* value = cJSON_GetStringValue(cJSON_GetObjectItem(obj, key));
+    snprintf(dst, dst_size, "%s", value ? value : "");
+}
+
+// 发送请求并解析响应中的 data 对象，返回 200 表示成功
+// data 指向 arena 中的对象，只在 bot_request_end 之前有效
+static int bot_post(const char* uri, const char* post_data, cJSON** data) {
+    rtc_req_result_t post_result = bot_request_post(uri, common_headers, post_data, 0);
+    bool parsed = bot_request_parse_json(post_result.response, post_result.response_len, post_result.code, data);
+    rtc_request_free(&post_result);
+
+    if (post_result.code != 200) {
+        return post_result.code;
+    }
+    return parsed ? 200 : -1;
+}
+
 int start_voice_bot(rtc_room_info_t* room_info) {
-    char post_data[1024];
+    char post_data[POST_DATA_SIZE];
+    if (!bot_request_begin()) {
+        return -1;
+    }
     cJSON *post_jobj = cJSON_CreateObject();
     cJSON_AddStringToObject(post_jobj, "bot_id", CONFIG_COZE_BOT_ID);
 
@@ -51,69 +61,47 @@ int start_voice_bot(rtc_room_info_t* room_info) {
     cJSON_AddStringToObject(audio_config, "codec", "AACLC");
 #endif
 
+    if (!bot_request_print_json(post_jobj, post_data, sizeof(post_data))) {
+        bot_request_end();
+        return -1;
+    }
 
-    const char* json_str = cJSON_Print(post_jobj);
-    strcpy(post_data, json_str);
-    cJSON_Delete(post_jobj);
-
-    rtc_post_config_t post_config = {
-        .uri = CONFIG_COZE_SERVER_HOST,
-        .headers = common_headers,
-        .post_data = post_data  // 根据需要传入智能体id和音色id
-    };
-    rtc_req_result_t post_result = rtc_http_post(&post_config);
-    if (post_result.code == 200 && post_result.response != NULL) {
-        // parse json
-        cJSON* root = cJSON_Parse(post_result.response);
-        rtc_request_free(&post_result);
-        if (root == NULL) {
-            ESP_LOGE(TAG, "Error parsing JSON");
-            return -1;
-        }
-        
-        cJSON* data = cJSON_GetObjectItem(root, "data");
-
-        if (data == NULL) {
-            cJSON_Delete(root);
-            ESP_LOGE(TAG, "Not found data object.");
-            return -1;
-        }
-        
-        cJSON* app_id_item = cJSON_GetObjectItem(data, "app_id");
-        const char* app_id = cJSON_GetStringValue(app_id_item);
-        strcpy(room_info->app_id, app_id);
-
-        cJSON* uid_item = cJSON_GetObjectItem(data, "uid");
-        const char* uid = cJSON_GetStringValue(uid_item);
-        strcpy(room_info->uid, uid);
-        
-        cJSON* room_id_item = cJSON_GetObjectItem(data, "room_id");
-        const char* room_id = cJSON_GetStringValue(room_id_item);
-        strcpy(room_info->room_id, room_id);
-
-        cJSON* token_item = cJSON_GetObjectItem(data, "token");
-        const char* token = cJSON_GetStringValue(token_item);
-        strcpy(room_info->token, token);
-        
-        cJSON_Delete(root);
-
-        return 200;
-    } else {
-        cJSON* root = cJSON_Parse(post_result.response);
-        if (root != NULL) {
-            cJSON* message_item = cJSON_GetObjectItem(root, "message");
-            const char* message = cJSON_GetStringValue(message_item);
-            ESP_LOGE(TAG, "Error: %s", message);
-            cJSON_Delete(root);
-        }
-        return post_result.code;
+    // 根据需要传入智能体id和音色id
+    cJSON* data = NULL;
+    int ret = bot_post(CONFIG_COZE_SERVER_HOST, post_data, &data);
+    if (ret == 200) {
+        copy_json_string(room_info->app_id, sizeof(room_info->app_id), data, "app_id");
+        copy_json_string(room_info->uid, sizeof(room_info->uid), data, "uid");
+        copy_json_string(room_info->room_id, sizeof(room_info->room_id), data, "room_id");
+        copy_json_string(room_info->token, sizeof(room_info->token), data, "token");
     }
+    bot_request_end();
+    return ret;
 }
 
 int stop_voice_bot(const rtc_room_info_t* room_info) {
     return 0;
 }
 
+void voice_bot_warm_up(void) {
+    rtc_http_warm_up(CONFIG_COZE_SERVER_HOST);
+}
+
+int resume_voice_bot(rtc_room_info_t* room_info, bool* resumed) {
+    // Coze 智能体没有示例服务端的会话表，总是启动新会话
+    *resumed = false;
+    return start_voice_bot(room_info);
+}
+
+int voice_bot_retry_after(void) {
+    return 0;
+}
+
+int heartbeat_voice_bot(const rtc_room_info_t* room_info) {
+    // Coze 智能体由 Coze 服务管理，没有示例服务端的会话回收
+    return 200;
+}
+
 int update_voice_bot(const rtc_room_info_t* room_info, const char* command, const char* message) {
     return 0;
 }
@@ -123,3 +111,7 @@ int interrupt_voice_bot(const rtc_room_info_t* room_info) {
 int voice_bot_function_calling(const rtc_room_info_t* room_info, const char* message) {
     return 0;
 }
+int renew_voice_bot_token(rtc_room_info_t* room_info) {
+    // Coze 房间的 token 由 Coze 服务下发，没有单独的续期接口，过期后需要重新创建房间
+    return -1;
+}
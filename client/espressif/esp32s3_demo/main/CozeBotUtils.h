@@ -4,12 +4,23 @@
 #ifndef __COZE_BOT_UTILS_H__
 #define __COZE_BOT_UTILS_H__
 
+#include <stdbool.h>
 #include "common.h"
 
+// 联网后调用，在后台预解析服务端域名并建立连接，第一次启动智能体时不再等待 DNS 和 TLS 握手
+void voice_bot_warm_up(void);
 int start_voice_bot(rtc_room_info_t* room_info);
+// 重启后第一次对话调用，服务端还保留着这台设备的会话时返回原来的房间和新 token，resumed 为 true，
+// 重新进房后智能体和对话上下文都还在；否则和 start_voice_bot 相同
+int resume_voice_bot(rtc_room_info_t* room_info, bool* resumed);
+// 上一次 start_voice_bot 返回 429 时服务端建议的重试时间，单位 s，没有时为 0
+int voice_bot_retry_after(void);
 int stop_voice_bot(const rtc_room_info_t* room_info);
+int heartbeat_voice_bot(const rtc_room_info_t* room_info);
 int update_voice_bot(const rtc_room_info_t* room_info, const char* command, const char* message);
 int interrupt_voice_bot(const rtc_room_info_t* room_info);
 int voice_bot_function_calling(const rtc_room_info_t* room_info, const char* message);
+// 为当前房间和用户获取新 token，成功时更新 room_info->token 并返回 200
+int renew_voice_bot_token(rtc_room_info_t* room_info);
 
 #endif // __COZE_BOT_UTILS_H__
\ No newline at end of file
@@ -0,0 +1,107 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "JsonArena.h"
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "cJSON.h"
+#include "MemPlacement.h"
+
+#define JSON_ARENA_ALIGN 8
+
+static const char *TAG = "JSON_ARENA";
+
+static SemaphoreHandle_t arena_mutex = NULL;
+static json_arena_t* active_arena = NULL;
+static portMUX_TYPE hooks_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void json_arena_init(json_arena_t* arena, void* buffer, size_t size) {
+    memset(arena, 0, sizeof(json_arena_t));
+    arena->base = (uint8_t*)buffer;
+    arena->size = size;
+}
+
+void* json_arena_alloc(json_arena_t* arena, size_t size) {
+    size_t offset = (arena->used + JSON_ARENA_ALIGN - 1) & ~(size_t)(JSON_ARENA_ALIGN - 1);
+    if (size > arena->size || offset > arena->size - size) {
+        arena->overflow_count++;
+        return NULL;
+    }
+    arena->used = offset + size;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+    return arena->base + offset;
+}
+
+bool json_arena_contains(const json_arena_t* arena, const void* ptr) {
+    const uint8_t* p = (const uint8_t*)ptr;
+    return arena && p >= arena->base && p < arena->base + arena->size;
+}
+
+void json_arena_reset(json_arena_t* arena) {
+    arena->used = 0;
+}
+
+static void* json_hook_malloc(size_t size) {
+    json_arena_t* arena = active_arena;
+    if (arena && arena->owner == xTaskGetCurrentTaskHandle()) {
+        void* ptr = json_arena_alloc(arena, size);
+        if (ptr == NULL) {
+            ESP_LOGE(TAG, "arena overflow, used %d size %d request %d", (int)arena->used, (int)arena->size, (int)size);
+        }
+        return ptr;
+    }
+    return mem_class_malloc(MEM_CLASS_CONTROL, size);
+}
+
+static void json_hook_free(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    // arena 中的内存在 json_arena_end 时统一回收
+    if (json_arena_contains(active_arena, ptr)) {
+        return;
+    }
+    mem_class_free(MEM_CLASS_CONTROL, ptr);
+}
+
+void json_arena_install_hooks(void) {
+    portENTER_CRITICAL(&hooks_lock);
+    bool need_install = (arena_mutex == NULL);
+    if (need_install) {
+        arena_mutex = xSemaphoreCreateMutex();
+    }
+    portEXIT_CRITICAL(&hooks_lock);
+    if (!need_install) {
+        return;
+    }
+    cJSON_Hooks hooks = {
+        .malloc_fn = json_hook_malloc,
+        .free_fn = json_hook_free,
+    };
+    cJSON_InitHooks(&hooks);
+}
+
+void json_arena_begin(json_arena_t* arena) {
+    json_arena_install_hooks();
+    xSemaphoreTake(arena_mutex, portMAX_DELAY);
+    json_arena_reset(arena);
+    arena->owner = xTaskGetCurrentTaskHandle();
+    active_arena = arena;
+}
+
+void json_arena_end(json_arena_t* arena) {
+    if (active_arena != arena) {
+        ESP_LOGE(TAG, "end a non-active arena");
+        return;
+    }
+    ESP_LOGD(TAG, "arena used %d peak %d size %d", (int)arena->used, (int)arena->peak, (int)arena->size);
+    active_arena = NULL;
+    arena->owner = NULL;
+    json_arena_reset(arena);
+    xSemaphoreGive(arena_mutex);
+}
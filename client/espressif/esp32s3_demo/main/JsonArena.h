@@ -0,0 +1,42 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __JSON_ARENA_H__
+#define __JSON_ARENA_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 控制面请求使用的 bump arena：
+// json_arena_begin 之后，当前任务里 cJSON 的所有分配都从 arena 中顺序分配，free 为空操作，
+// json_arena_end 时整体复位。其它任务的 cJSON 调用（例如 RTS 消息解析）不受影响，仍然走堆分配。
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    size_t peak;               // 单次请求的最大使用量，用来调整 arena 大小
+    uint32_t overflow_count;   // arena 空间不足导致分配失败的次数
+    void* owner;               // 绑定 arena 的任务
+} json_arena_t;
+
+void json_arena_init(json_arena_t* arena, void* buffer, size_t size);
+void* json_arena_alloc(json_arena_t* arena, size_t size);
+bool json_arena_contains(const json_arena_t* arena, const void* ptr);
+void json_arena_reset(json_arena_t* arena);
+
+// 安装 cJSON hooks，重复调用是安全的
+void json_arena_install_hooks(void);
+// 将 arena 绑定到当前任务，同一时刻只允许一个 arena 处于活动状态（其它调用者阻塞等待）
+void json_arena_begin(json_arena_t* arena);
+// 解绑并复位 arena，之前从 arena 分配的 cJSON 对象不能再使用
+void json_arena_end(json_arena_t* arena);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __JSON_ARENA_H__
@@ -0,0 +1,175 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "LinkPolicy.h"
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "TaskTopology.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+static const char *TAG = "LINK_POLICY";
+
+#if CONFIG_LINK_POLICY_ENABLE
+
+#define LINK_POLICY_CHECK_MS        200     // TALKING 时检查下行静默的周期
+
+typedef struct {
+    const char* name;
+    wifi_ps_type_t ps;
+    bool cpu_lock;
+} link_mode_config_t;
+
+static const link_mode_config_t mode_configs[LINK_MODE_MAX] = {
+    [LINK_MODE_IDLE]      = {"idle",      WIFI_PS_MAX_MODEM, false},
+    [LINK_MODE_JOINING]   = {"joining",   WIFI_PS_NONE,      true},
+    [LINK_MODE_TALKING]   = {"talking",   WIFI_PS_NONE,      true},
+    [LINK_MODE_LISTENING] = {"listening", WIFI_PS_MIN_MODEM, true},
+    [LINK_MODE_STANDBY]   = {"standby",   WIFI_PS_MAX_MODEM, true},
+};
+
+typedef struct {
+    SemaphoreHandle_t lock;
+    volatile link_mode_e mode;
+    int64_t enter_time_us;
+    volatile int64_t last_downlink_us;
+    volatile bool downlink_pending;     // LISTENING 时收到下行音频，等 link 任务切到 TALKING
+    TaskHandle_t task;
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t cpu_lock;
+    esp_pm_lock_handle_t no_sleep_lock;
+    bool cpu_locked;
+#endif
+} link_policy_t;
+
+static link_policy_t link = {0};
+
+static void link_policy_apply(link_mode_e mode) {
+    const link_mode_config_t* config = &mode_configs[mode];
+    esp_err_t ret = esp_wifi_set_ps(config->ps);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "set wifi ps %d failed: %d", config->ps, ret);
+    }
+#if CONFIG_PM_ENABLE
+    if (config->cpu_lock && !link.cpu_locked) {
+        esp_pm_lock_acquire(link.cpu_lock);
+        esp_pm_lock_acquire(link.no_sleep_lock);
+        link.cpu_locked = true;
+    } else if (!config->cpu_lock && link.cpu_locked) {
+        esp_pm_lock_release(link.no_sleep_lock);
+        esp_pm_lock_release(link.cpu_lock);
+        link.cpu_locked = false;
+    }
+#endif
+}
+
+// from 为 LINK_MODE_MAX 时无条件切换；否则只在当前模式为 from 时切换，避免覆盖控制任务刚设置的模式
+static void link_policy_switch(link_mode_e from, link_mode_e to) {
+    if (link.lock == NULL || to >= LINK_MODE_MAX) {
+        return;
+    }
+    xSemaphoreTake(link.lock, portMAX_DELAY);
+    link_mode_e old_mode = link.mode;
+    if (to != old_mode && (from == LINK_MODE_MAX || from == old_mode)) {
+        int64_t now = esp_timer_get_time();
+        if (to == LINK_MODE_TALKING) {
+            link.last_downlink_us = now;
+        }
+        link_policy_apply(to);
+        link.mode = to;
+        ESP_LOGI(TAG, "link mode %s -> %s, %d ms in %s", mode_configs[old_mode].name, mode_configs[to].name,
+                 (int)((now - link.enter_time_us) / 1000), mode_configs[old_mode].name);
+        link.enter_time_us = now;
+        if (to == LINK_MODE_TALKING && link.task != NULL) {
+            // 让 link 任务开始按周期检查下行静默
+            xTaskNotifyGive(link.task);
+        }
+    }
+    xSemaphoreGive(link.lock);
+}
+
+// esp_wifi_set_ps 要等 Wi-Fi 任务处理，不能在音频回调或 esp_timer 任务中调用：
+// 下行音频回调只记录时间并通知这个任务，LISTENING/TALKING 之间的切换都在这里完成
+static void link_policy_task(void* arg) {
+    while (true) {
+        // 只有 TALKING 需要检查下行静默，其他模式一直等到下行音频或切到 TALKING 的通知
+        TickType_t wait = link.mode == LINK_MODE_TALKING ? pdMS_TO_TICKS(LINK_POLICY_CHECK_MS) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (link.downlink_pending) {
+            link.downlink_pending = false;
+            link_policy_switch(LINK_MODE_LISTENING, LINK_MODE_TALKING);
+        }
+        if (link.mode == LINK_MODE_TALKING &&
+            esp_timer_get_time() - link.last_downlink_us > (int64_t)CONFIG_LINK_POLICY_TALK_HOLD_MS * 1000) {
+            link_policy_switch(LINK_MODE_TALKING, LINK_MODE_LISTENING);
+        }
+    }
+}
+
+void link_policy_init(void) {
+    if (link.lock != NULL) {
+        return;
+    }
+    link.lock = xSemaphoreCreateMutex();
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "link_cpu", &link.cpu_lock);
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "link_awake", &link.no_sleep_lock);
+#endif
+    link.mode = LINK_MODE_IDLE;
+    link.enter_time_us = esp_timer_get_time();
+    link_policy_apply(LINK_MODE_IDLE);
+    if (task_topology_create(TASK_ID_LINK_POLICY, link_policy_task, NULL, &link.task) != pdPASS) {
+        link.task = NULL;
+    }
+    ESP_LOGI(TAG, "link mode %s, listen interval %d", mode_configs[LINK_MODE_IDLE].name, CONFIG_LINK_POLICY_LISTEN_INTERVAL);
+}
+
+void link_policy_set(link_mode_e mode) {
+    link_policy_switch(LINK_MODE_MAX, mode);
+}
+
+link_mode_e link_policy_get(void) {
+    return link.mode;
+}
+
+void link_policy_on_downlink_audio(void) {
+    link.last_downlink_us = esp_timer_get_time();
+    if (link.mode == LINK_MODE_LISTENING && !link.downlink_pending && link.task != NULL) {
+        link.downlink_pending = true;
+        xTaskNotifyGive(link.task);
+    }
+}
+
+uint16_t link_policy_listen_interval(void) {
+    return CONFIG_LINK_POLICY_LISTEN_INTERVAL;
+}
+
+#else
+
+void link_policy_init(void) {
+    ESP_LOGI(TAG, "link policy disabled");
+}
+
+void link_policy_set(link_mode_e mode) {
+}
+
+link_mode_e link_policy_get(void) {
+    return LINK_MODE_IDLE;
+}
+
+void link_policy_on_downlink_audio(void) {
+}
+
+uint16_t link_policy_listen_interval(void) {
+    // 0 表示使用驱动默认值
+    return 0;
+}
+
+#endif
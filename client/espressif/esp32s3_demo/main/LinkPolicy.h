@@ -0,0 +1,39 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __LINK_POLICY_H__
+#define __LINK_POLICY_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 按会话阶段切换 Wi-Fi 省电模式和 CPU 频率锁：对话中低抖动，对话之间低功耗
+typedef enum {
+    LINK_MODE_IDLE = 0,     // 不在对话中：WIFI_PS_MAX_MODEM，按 listen interval 唤醒，释放 CPU 锁
+    LINK_MODE_JOINING,      // 启动智能体、进房、断线恢复：关闭省电，锁定最高主频
+    LINK_MODE_TALKING,      // 正在收到智能体的下行音频：关闭省电，锁定最高主频
+    LINK_MODE_LISTENING,    // 对话中等待用户说话：WIFI_PS_MIN_MODEM，每个 DTIM 唤醒，保持 CPU 锁
+    LINK_MODE_STANDBY,      // 不在对话中但本地在检测唤醒词：WIFI_PS_MAX_MODEM，保持 CPU 锁
+    LINK_MODE_MAX,
+} link_mode_e;
+
+void link_policy_init(void);
+
+void link_policy_set(link_mode_e mode);
+
+link_mode_e link_policy_get(void);
+
+// 每帧下行音频调用，只记录时间并通知 link 任务，不会阻塞调用方；
+// LISTENING 时由 link 任务切到 TALKING，下行静默一段时间后自动回到 LISTENING
+void link_policy_on_downlink_audio(void);
+
+// 空闲时的 listen interval，在 wifi_config_t.sta.listen_interval 中设置，只在关联时生效
+uint16_t link_policy_listen_interval(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __LINK_POLICY_H__
@@ -0,0 +1,131 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "MemPlacement.h"
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "MEM_PLACEMENT";
+
+typedef struct {
+    const char* name;
+    uint32_t caps;             // 首选 caps
+    uint32_t fallback_caps;    // 首选 caps 分配失败时使用，0 表示不回退
+} mem_class_policy_t;
+
+#if CONFIG_SPIRAM
+static const mem_class_policy_t policies[MEM_CLASS_MAX] = {
+    [MEM_CLASS_HOT_AUDIO] = {"hot-audio", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT},
+    [MEM_CLASS_BULK]      = {"bulk",      MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,   MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT},
+    [MEM_CLASS_CONTROL]   = {"control",   MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,   MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT},
+};
+#else
+static const mem_class_policy_t policies[MEM_CLASS_MAX] = {
+    [MEM_CLASS_HOT_AUDIO] = {"hot-audio", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, 0},
+    [MEM_CLASS_BULK]      = {"bulk",      MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, 0},
+    [MEM_CLASS_CONTROL]   = {"control",   MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, 0},
+};
+#endif // CONFIG_SPIRAM
+
+static mem_class_stats_t class_stats[MEM_CLASS_MAX];
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void *mem_class_alloc_impl(mem_class_e mem_class, size_t size, bool zero) {
+    if (mem_class >= MEM_CLASS_MAX || size == 0) {
+        return NULL;
+    }
+    const mem_class_policy_t* policy = &policies[mem_class];
+    bool fallback = false;
+    void* ptr = zero ? heap_caps_calloc(1, size, policy->caps) : heap_caps_malloc(size, policy->caps);
+    if (ptr == NULL && policy->fallback_caps) {
+        ptr = zero ? heap_caps_calloc(1, size, policy->fallback_caps) : heap_caps_malloc(size, policy->fallback_caps);
+        fallback = (ptr != NULL);
+    }
+
+    // 统计按实际占用的块大小计算，释放时才能对得上
+    size_t block_size = ptr ? heap_caps_get_allocated_size(ptr) : 0;
+    mem_class_stats_t* stats = &class_stats[mem_class];
+    portENTER_CRITICAL(&stats_lock);
+    if (ptr) {
+        stats->alloc_count++;
+        stats->cur_bytes += block_size;
+        if (stats->cur_bytes > stats->peak_bytes) {
+            stats->peak_bytes = stats->cur_bytes;
+        }
+        if (fallback) {
+            stats->fallback_count++;
+        }
+    } else {
+        stats->fail_count++;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+
+    if (ptr == NULL) {
+        ESP_LOGE(TAG, "alloc %d bytes for class %s failed", (int)size, policy->name);
+    } else if (fallback) {
+        ESP_LOGW(TAG, "alloc %d bytes for class %s fell back", (int)size, policy->name);
+    }
+    return ptr;
+}
+
+void* mem_class_malloc(mem_class_e mem_class, size_t size) {
+    return mem_class_alloc_impl(mem_class, size, false);
+}
+
+void* mem_class_calloc(mem_class_e mem_class, size_t n, size_t size) {
+    if (size != 0 && n > SIZE_MAX / size) {
+        return NULL;
+    }
+    return mem_class_alloc_impl(mem_class, n * size, true);
+}
+
+void mem_class_free(mem_class_e mem_class, void* ptr) {
+    if (ptr == NULL || mem_class >= MEM_CLASS_MAX) {
+        return;
+    }
+    size_t block_size = heap_caps_get_allocated_size(ptr);
+    heap_caps_free(ptr);
+
+    mem_class_stats_t* stats = &class_stats[mem_class];
+    portENTER_CRITICAL(&stats_lock);
+    stats->free_count++;
+    stats->cur_bytes = stats->cur_bytes > block_size ? stats->cur_bytes - block_size : 0;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+const char* mem_class_name(mem_class_e mem_class) {
+    if (mem_class >= MEM_CLASS_MAX) {
+        return "unknown";
+    }
+    return policies[mem_class].name;
+}
+
+void mem_class_get_stats(mem_class_e mem_class, mem_class_stats_t* stats) {
+    if (stats == NULL || mem_class >= MEM_CLASS_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    memcpy(stats, &class_stats[mem_class], sizeof(mem_class_stats_t));
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void mem_class_dump_stats(void) {
+    for (int i = 0; i < MEM_CLASS_MAX; i++) {
+        mem_class_stats_t stats;
+        mem_class_get_stats((mem_class_e)i, &stats);
+        ESP_LOGI(TAG, "%-9s cur %6u peak %6u alloc %4u free %4u fallback %u fail %u",
+                 policies[i].name,
+                 (unsigned)stats.cur_bytes, (unsigned)stats.peak_bytes,
+                 (unsigned)stats.alloc_count, (unsigned)stats.free_count,
+                 (unsigned)stats.fallback_count, (unsigned)stats.fail_count);
+    }
+    ESP_LOGI(TAG, "internal free %u largest %u, psram free %u largest %u",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+}
@@ -0,0 +1,43 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __MEM_PLACEMENT_H__
+#define __MEM_PLACEMENT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 内存分配类别，每个类别映射到一组 heap caps
+// 热路径（每帧访问）的数据放在内部 RAM，冷数据和大块数据放在 PSRAM
+typedef enum {
+    MEM_CLASS_HOT_AUDIO = 0,   // 每个音频帧都会访问的 buffer 和结构体：内部 RAM，失败时回退到 PSRAM
+    MEM_CLASS_BULK,            // 大块、访问不频繁的 buffer：PSRAM，无 PSRAM 时回退到内部 RAM
+    MEM_CLASS_CONTROL,         // 控制面（HTTP、房间信息等）：PSRAM，无 PSRAM 时回退到内部 RAM
+    MEM_CLASS_MAX,
+} mem_class_e;
+
+typedef struct {
+    uint32_t cur_bytes;        // 当前已分配字节数
+    uint32_t peak_bytes;       // 峰值字节数
+    uint32_t alloc_count;      // 累计分配次数
+    uint32_t free_count;       // 累计释放次数
+    uint32_t fallback_count;   // 首选 caps 分配失败、使用回退 caps 的次数
+    uint32_t fail_count;       // 分配失败次数
+} mem_class_stats_t;
+
+void* mem_class_malloc(mem_class_e mem_class, size_t size);
+void* mem_class_calloc(mem_class_e mem_class, size_t n, size_t size);
+void mem_class_free(mem_class_e mem_class, void* ptr);
+
+const char* mem_class_name(mem_class_e mem_class);
+void mem_class_get_stats(mem_class_e mem_class, mem_class_stats_t* stats);
+void mem_class_dump_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __MEM_PLACEMENT_H__
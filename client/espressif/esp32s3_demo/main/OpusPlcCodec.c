@@ -0,0 +1,85 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "AudioPlc.h"
+#include "sdkconfig.h"
+
+#if CONFIG_AUDIO_PLC_ENABLE && CONFIG_AUDIO_CODEC_TYPE_OPUS
+
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_opus_dec.h"
+
+static const char *TAG = "OPUS_PLC";
+
+typedef struct {
+    void* decoder;
+} opus_plc_t;
+
+static int opus_run(audio_plc_codec_t* codec, const uint8_t* data, size_t length, bool recover, int16_t* pcm, int max_samples) {
+    opus_plc_t* opus = codec->priv;
+    esp_audio_dec_in_raw_t raw = {
+        .buffer = (uint8_t*)data,
+        .len = length,
+        .frame_recover = recover ? ESP_AUDIO_DEC_RECOVERY_PLC : ESP_AUDIO_DEC_RECOVERY_NONE,
+    };
+    esp_audio_dec_out_frame_t frame = {
+        .buffer = (uint8_t*)pcm,
+        .len = max_samples * sizeof(int16_t),
+    };
+    esp_audio_dec_info_t info = {0};
+    esp_audio_err_t ret = esp_opus_dec_decode(opus->decoder, &raw, &frame, &info);
+    if (ret != ESP_AUDIO_ERR_OK) {
+        ESP_LOGD(TAG, "decode failed %d, recover %d, len %d", ret, recover, (int)length);
+        return -1;
+    }
+    return frame.decoded_size / sizeof(int16_t);
+}
+
+static int opus_decode(audio_plc_codec_t* codec, const uint8_t* data, size_t length, int16_t* pcm, int max_samples) {
+    return opus_run(codec, data, length, false, pcm, max_samples);
+}
+
+// 没有数据的恢复请求即 Opus 自带的 PLC
+static int opus_conceal(audio_plc_codec_t* codec, int16_t* pcm, int samples) {
+    return opus_run(codec, NULL, 0, true, pcm, samples);
+}
+
+// 带着下一包的恢复请求由解码器取其中的 LBRR（带内 FEC）数据恢复前一帧，包里没有 FEC 时退化为 PLC
+static int opus_recover(audio_plc_codec_t* codec, const uint8_t* next, size_t length, int16_t* pcm, int samples) {
+    return opus_run(codec, next, length, true, pcm, samples);
+}
+
+static void opus_destroy(audio_plc_codec_t* codec) {
+    opus_plc_t* opus = codec->priv;
+    esp_opus_dec_close(opus->decoder);
+    free(opus);
+    free(codec);
+}
+
+audio_plc_codec_t* audio_plc_codec_opus_create(int sample_rate, bool fec) {
+    audio_plc_codec_t* codec = calloc(1, sizeof(audio_plc_codec_t));
+    opus_plc_t* opus = calloc(1, sizeof(opus_plc_t));
+    esp_opus_dec_cfg_t cfg = {
+        .sample_rate = sample_rate,
+        .channel = 1,
+        .frame_duration = ESP_OPUS_DEC_FRAME_DURATION_INVALID,
+        .self_delimited = false,
+    };
+    if (codec == NULL || opus == NULL || esp_opus_dec_open(&cfg, sizeof(cfg), &opus->decoder) != ESP_AUDIO_ERR_OK) {
+        ESP_LOGE(TAG, "open opus decoder failed");
+        free(opus);
+        free(codec);
+        return NULL;
+    }
+    codec->name = "opus";
+    codec->sample_rate = sample_rate;
+    codec->decode = opus_decode;
+    codec->conceal = opus_conceal;
+    codec->recover = fec ? opus_recover : NULL;
+    codec->destroy = opus_destroy;
+    codec->priv = opus;
+    return codec;
+}
+
+#endif
@@ -0,0 +1,227 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 只依赖 libc，主机上由 tools/netemu 的弱网模拟驱动
+
+#include "ReorderWindow.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint16_t sent_ts;
+    uint32_t arrival_ms;
+    size_t length;
+    uint8_t* data;
+} reorder_slot_t;
+
+struct reorder_window_t {
+    reorder_window_config_t config;
+    bool synced;
+    uint16_t last_ts;           // 最后放行的 sent_ts
+    uint16_t newest_ts;         // 收到的最新 sent_ts，用于计算乱序深度
+    uint32_t clock_ms;
+    bool disorder_seen;
+    uint32_t disorder_ms;       // 最近一次乱序或迟到的时间
+    reorder_slot_t slots[REORDER_WINDOW_MAX_DEPTH];     // 按 sent_ts 从小到大
+    int count;
+    reorder_window_stats_t stats;
+};
+
+reorder_window_t* reorder_window_create(const reorder_window_config_t* config) {
+    reorder_window_t* window = calloc(1, sizeof(reorder_window_t));
+    if (window == NULL) {
+        return NULL;
+    }
+    window->config = *config;
+    if (window->config.max_depth > REORDER_WINDOW_MAX_DEPTH) {
+        window->config.max_depth = REORDER_WINDOW_MAX_DEPTH;
+    }
+    if (window->config.max_depth < 1) {
+        window->config.max_depth = 1;
+    }
+    for (int i = 0; i < REORDER_WINDOW_MAX_DEPTH; i++) {
+        window->slots[i].data = malloc(config->max_frame_bytes ? config->max_frame_bytes : 1);
+        if (window->slots[i].data == NULL) {
+            reorder_window_destroy(window);
+            return NULL;
+        }
+    }
+    return window;
+}
+
+void reorder_window_destroy(reorder_window_t* window) {
+    if (window == NULL) {
+        return;
+    }
+    for (int i = 0; i < REORDER_WINDOW_MAX_DEPTH; i++) {
+        free(window->slots[i].data);
+    }
+    free(window);
+}
+
+static int16_t ts_diff(uint16_t a, uint16_t b) {
+    return (int16_t)(a - b);
+}
+
+// 和上一帧的间隔不超过 1.5 帧即认为是下一帧，容忍发送端时间戳的抖动
+static bool is_next(reorder_window_t* window, uint16_t sent_ts) {
+    int16_t delta = ts_diff(sent_ts, window->last_ts);
+    return delta > 0 && delta <= window->config.frame_ms + window->config.frame_ms / 2;
+}
+
+static void release(reorder_window_t* window, uint16_t sent_ts, uint32_t arrival_ms, const uint8_t* data, size_t length) {
+    if (window->synced && !is_next(window, sent_ts)) {
+        int16_t delta = ts_diff(sent_ts, window->last_ts);
+        if (delta <= window->config.max_gap_ms) {
+            window->stats.gaps++;
+            window->stats.skipped_frames += (delta + window->config.frame_ms / 2) / window->config.frame_ms - 1;
+        }
+    }
+    uint32_t held = window->clock_ms - arrival_ms;
+    if (held > 0) {
+        window->stats.held_frames++;
+        window->stats.hold_ms_sum += held;
+        if (held > window->stats.hold_ms_max) {
+            window->stats.hold_ms_max = held;
+        }
+    }
+    window->synced = true;
+    window->last_ts = sent_ts;
+    window->stats.released++;
+    if (window->config.release) {
+        window->config.release(sent_ts, data, length, window->config.ctx);
+    }
+}
+
+static void release_head(reorder_window_t* window) {
+    reorder_slot_t head = window->slots[0];
+    // slot 的 buffer 轮转使用，回调期间 head.data 仍然有效
+    memmove(&window->slots[0], &window->slots[1], (window->count - 1) * sizeof(reorder_slot_t));
+    window->slots[--window->count] = head;
+    release(window, head.sent_ts, head.arrival_ms, head.data, head.length);
+}
+
+static int hold_ms(reorder_window_t* window) {
+    if (window->config.adapt_ms == 0) {
+        return window->config.max_hold_ms;
+    }
+    if (window->disorder_seen && (int32_t)(window->clock_ms - window->disorder_ms) < window->config.adapt_ms) {
+        return window->config.max_hold_ms;
+    }
+    return 0;
+}
+
+static void note_disorder(reorder_window_t* window) {
+    window->disorder_seen = true;
+    window->disorder_ms = window->clock_ms;
+}
+
+// 放行队首连续的帧；等待超时或窗口已满时即使队首前面有缺口也放行
+static void drain(reorder_window_t* window) {
+    while (window->count > 0) {
+        reorder_slot_t* head = &window->slots[0];
+        bool expired = (int32_t)(window->clock_ms - head->arrival_ms) >= hold_ms(window);
+        if (!is_next(window, head->sent_ts) && !expired && window->count < window->config.max_depth) {
+            break;
+        }
+        release_head(window);
+    }
+}
+
+static void insert(reorder_window_t* window, uint16_t sent_ts, uint32_t arrival_ms, const uint8_t* data, size_t length) {
+    int index = window->count;
+    while (index > 0 && ts_diff(window->slots[index - 1].sent_ts, sent_ts) > 0) {
+        index--;
+    }
+    reorder_slot_t slot = window->slots[window->count];
+    memmove(&window->slots[index + 1], &window->slots[index], (window->count - index) * sizeof(reorder_slot_t));
+    slot.sent_ts = sent_ts;
+    slot.arrival_ms = arrival_ms;
+    slot.length = length;
+    memcpy(slot.data, data, length);
+    window->slots[index] = slot;
+    window->count++;
+}
+
+void reorder_window_push(reorder_window_t* window, uint16_t sent_ts, uint32_t arrival_ms, const uint8_t* data, size_t length) {
+    if (length > window->config.max_frame_bytes) {
+        return;
+    }
+    window->clock_ms = arrival_ms;
+    drain(window);
+
+    if (!window->synced) {
+        window->newest_ts = sent_ts;
+        release(window, sent_ts, arrival_ms, data, length);
+        return;
+    }
+    int16_t delta = ts_diff(sent_ts, window->last_ts);
+    if (delta <= 0) {
+        if (delta == 0) {
+            window->stats.duplicates++;
+        } else {
+            window->stats.late++;
+            note_disorder(window);
+        }
+        return;
+    }
+    for (int i = 0; i < window->count; i++) {
+        if (window->slots[i].sent_ts == sent_ts) {
+            window->stats.duplicates++;
+            return;
+        }
+    }
+    int16_t behind = ts_diff(window->newest_ts, sent_ts);
+    if (behind > 0) {
+        window->stats.reordered++;
+        note_disorder(window);
+        uint32_t depth = (behind + window->config.frame_ms / 2) / window->config.frame_ms;
+        if (depth > window->stats.max_depth) {
+            window->stats.max_depth = depth;
+        }
+    } else {
+        window->newest_ts = sent_ts;
+    }
+
+    if (window->count == 0 && (is_next(window, sent_ts) || delta > window->config.max_gap_ms)) {
+        // 快速路径：顺序到达，或者停顿之后的第一帧，不增加延迟
+        window->stats.in_order++;
+        release(window, sent_ts, arrival_ms, data, length);
+        return;
+    }
+    if (window->count == window->config.max_depth) {
+        release_head(window);
+    }
+    insert(window, sent_ts, arrival_ms, data, length);
+    drain(window);
+}
+
+void reorder_window_poll(reorder_window_t* window, uint32_t now_ms) {
+    if ((int32_t)(now_ms - window->clock_ms) > 0) {
+        window->clock_ms = now_ms;
+    }
+    drain(window);
+}
+
+void reorder_window_flush(reorder_window_t* window) {
+    while (window->count > 0) {
+        release_head(window);
+    }
+}
+
+bool reorder_window_next_deadline(reorder_window_t* window, uint32_t* deadline_ms) {
+    if (window->count == 0) {
+        return false;
+    }
+    *deadline_ms = window->slots[0].arrival_ms + hold_ms(window);
+    return true;
+}
+
+void reorder_window_reset(reorder_window_t* window) {
+    window->count = 0;
+    window->synced = false;
+}
+
+void reorder_window_get_stats(reorder_window_t* window, reorder_window_stats_t* stats) {
+    *stats = window->stats;
+}
@@ -0,0 +1,72 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __REORDER_WINDOW_H__
+#define __REORDER_WINDOW_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 按 sent_ts 排序的下行小窗口：顺序到达的帧立即放行，乱序时最多等待 max_hold_ms 或 max_depth 帧，
+// 之后跳过缺的帧继续放行，缺口由下游（AudioPlc）按 sent_ts 的间隔隐藏。sent_ts 按 16bit 回绕比较。
+// 只丢包不乱序的网络上等待没有收益，最近 adapt_ms 内没有见到乱序或迟到的帧时缺帧不等待
+#define REORDER_WINDOW_MAX_DEPTH    8
+
+typedef void (*reorder_release_cb_t)(uint16_t sent_ts, const uint8_t* data, size_t length, void* ctx);
+
+typedef struct {
+    int frame_ms;               // 相邻帧 sent_ts 的间隔
+    int max_hold_ms;            // 缺帧时后面的帧最多等待的时间
+    int max_depth;              // 缺帧时最多缓存的帧数，不超过 REORDER_WINDOW_MAX_DEPTH
+    int max_gap_ms;             // 间隔超过这个值视为智能体停顿，不等待
+    int adapt_ms;               // 0 表示缺帧时总是等待
+    size_t max_frame_bytes;
+    reorder_release_cb_t release;
+    void* ctx;
+} reorder_window_config_t;
+
+typedef struct {
+    uint32_t released;
+    uint32_t in_order;          // 到达时就是下一帧，没有等待
+    uint32_t reordered;         // 乱序到达但仍按顺序放行
+    uint32_t max_depth;         // 乱序到达的帧落后于已收到的最新帧的最大帧数
+    uint32_t late;              // 到达时位置已经放行或跳过，丢弃
+    uint32_t duplicates;
+    uint32_t gaps;              // 放行时跳过的缺口次数
+    uint32_t skipped_frames;    // 跳过的帧数
+    uint32_t held_frames;       // 等待过的帧数
+    uint32_t hold_ms_max;
+    uint64_t hold_ms_sum;
+} reorder_window_stats_t;
+
+typedef struct reorder_window_t reorder_window_t;
+
+reorder_window_t* reorder_window_create(const reorder_window_config_t* config);
+void reorder_window_destroy(reorder_window_t* window);
+
+// arrival_ms 为到达时间，作为窗口的时钟；放行通过 release 回调，在调用线程中执行
+void reorder_window_push(reorder_window_t* window, uint16_t sent_ts, uint32_t arrival_ms, const uint8_t* data, size_t length);
+
+// 没有新帧时定期调用，放行等待超时的帧
+void reorder_window_poll(reorder_window_t* window, uint32_t now_ms);
+
+// 下一次时间点之前不会有帧超时，没有等待的帧时返回 false
+bool reorder_window_next_deadline(reorder_window_t* window, uint32_t* deadline_ms);
+
+// 不再等待，按顺序放行所有缓存的帧，播放缓冲将空时调用
+void reorder_window_flush(reorder_window_t* window);
+
+// 丢弃缓存的帧并重新同步，新会话开始时调用；保留对网络是否乱序的判断
+void reorder_window_reset(reorder_window_t* window);
+
+void reorder_window_get_stats(reorder_window_t* window, reorder_window_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __REORDER_WINDOW_H__
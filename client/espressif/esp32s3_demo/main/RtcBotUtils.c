@@ -3,220 +3,357 @@
 
 #include "RtcBotUtils.h"
 #include "RtcHttpUtils.h"
+#include "ControlTlv.h"
 #include "cJSON.h"
 #include "esp_log.h"
-#include "esp_heap_caps.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "BotRequest.h"
+#include "nvs.h"
+#include <stdio.h>
 #include <string.h>
 
 static const char *TAG = "RTC_BOT_UTILS";
 
-static void *impl_malloc_fn(size_t size) {
-    uint32_t allocate_caps = 0;
-#if CONFIG_PSRAM
-    allocate_caps = MALLOC_CAP_SPIRAM;
+#if CONFIG_AIGENT_CONTROL_TLV
+#define BOT_CONTENT_TYPE            CONTROL_TLV_CONTENT_TYPE
+#define BOT_ENCODING_NAME           "tlv"
 #else
-    allocate_caps = MALLOC_CAP_INTERNAL;
+#define BOT_CONTENT_TYPE            "application/json"
+#define BOT_ENCODING_NAME           "json"
 #endif
-    return heap_caps_malloc(size, allocate_caps);
-}
-
-static void impl_free_fn(void *ptr) {
-    heap_caps_free(ptr);
-}
 
 const char* common_headers[] = {
-    "Content-Type", "application/json",
+    "Content-Type", BOT_CONTENT_TYPE,
     "Authorization", "af78e30" CONFIG_RTC_APPID,
     NULL
 };
 
-int start_voice_bot(rtc_room_info_t* room_info) {
-    char post_data[1024];
-    cJSON *post_jobj = cJSON_CreateObject();
+#define POST_DATA_SIZE              1024
+
+// 请求体，按 CONFIG_AIGENT_CONTROL_TLV 编码为 TLV 或 json，字段同时给出 TLV tag 和 json key
+typedef struct {
+#if CONFIG_AIGENT_CONTROL_TLV
+    control_tlv_writer_t writer;
+#else
+    cJSON* json;
+#endif
+    char data[POST_DATA_SIZE];
+    int len;
+    int64_t start_us;
+    int encode_us;
+} bot_body_t;
+
+// 响应中的 data 对象，指向 arena 或响应 buffer，只在 bot_request_end 之前有效
+typedef struct {
+#if CONFIG_AIGENT_CONTROL_TLV
+    const uint8_t* value;
+    size_t len;
+#else
+    cJSON* json;
+#endif
+} bot_data_t;
+
+// 最近一次请求响应的 Retry-After，单位 s
+static int last_retry_after_s = 0;
+
+static void body_init(bot_body_t* body) {
+    body->start_us = esp_timer_get_time();
+    body->len = 0;
+#if CONFIG_AIGENT_CONTROL_TLV
+    control_tlv_writer_init(&body->writer, body->data, sizeof(body->data));
+#else
+    body->json = cJSON_CreateObject();
+#endif
+}
+
+static void body_add_string(bot_body_t* body, uint8_t tag, const char* key, const char* value) {
+#if CONFIG_AIGENT_CONTROL_TLV
+    control_tlv_put_string(&body->writer, tag, value);
+#else
+    cJSON_AddStringToObject(body->json, key, value);
+#endif
+}
+
+static void body_add_number(bot_body_t* body, uint8_t tag, const char* key, int value) {
+#if CONFIG_AIGENT_CONTROL_TLV
+    control_tlv_put_uint(&body->writer, tag, (uint32_t)value);
+#else
+    cJSON_AddNumberToObject(body->json, key, value);
+#endif
+}
+
+static void body_add_bool(bot_body_t* body, uint8_t tag, const char* key, bool value) {
+#if CONFIG_AIGENT_CONTROL_TLV
+    control_tlv_put_bool(&body->writer, tag, value);
+#else
+    cJSON_AddBoolToObject(body->json, key, value);
+#endif
+}
+
+// 完成编码，json 写入定长 buffer，不产生额外的堆分配
+static bool body_finish(bot_body_t* body) {
+#if CONFIG_AIGENT_CONTROL_TLV
+    if (body->writer.overflow) {
+        ESP_LOGE(TAG, "Failed to encode tlv, buffer size %d", (int)sizeof(body->data));
+        return false;
+    }
+    body->len = (int)body->writer.len;
+#else
+    if (!bot_request_print_json(body->json, body->data, sizeof(body->data))) {
+        return false;
+    }
+    body->len = strlen(body->data);
+#endif
+    body->encode_us = (int)(esp_timer_get_time() - body->start_us);
+    return true;
+}
+
+static void data_copy_string(const bot_data_t* data, uint8_t tag, const char* key, char* dst, size_t dst_size) {
+#if CONFIG_AIGENT_CONTROL_TLV
+    control_tlv_copy_string(data->value, data->len, tag, dst, dst_size);
+#else
+    const char* value = cJSON_GetStringValue(cJSON_GetObjectItem(data->json, key));
+    snprintf(dst, dst_size, "%s", value ? value : "");
+#endif
+}
+
+static bool data_get_bool(const bot_data_t* data, uint8_t tag, const char* key) {
+#if CONFIG_AIGENT_CONTROL_TLV
+    const uint8_t* value = NULL;
+    size_t len = 0;
+    return control_tlv_find(data->value, data->len, tag, &value, &len) && len == 1 && value[0] != 0;
+#else
+    return cJSON_IsTrue(cJSON_GetObjectItem(data->json, key));
+#endif
+}
+
+// 解析响应，失败时记录服务端的错误信息，返回是否找到 data
+static bool parse_response(const char* response, int response_len, int code, bot_data_t* data) {
+#if CONFIG_AIGENT_CONTROL_TLV
+    const uint8_t* root = (const uint8_t*)response;
+    size_t root_len = response ? response_len : 0;
+    if (code != 200) {
+        char message[128];
+        if (control_tlv_copy_string(root, root_len, CONTROL_TLV_MSG, message, sizeof(message))) {
+            ESP_LOGE(TAG, "Error: %s", message);
+        }
+        return false;
+    }
+    if (!control_tlv_find(root, root_len, CONTROL_TLV_DATA, &data->value, &data->len)) {
+        ESP_LOGE(TAG, "Not found data object.");
+        return false;
+    }
+    return true;
+#else
+    return bot_request_parse_json(response, response_len, code, &data->json);
+#endif
+}
+
+// 发送请求并解析响应中的 data 对象，返回 200 表示成功
+// 请求和响应的字节数、编码和解析耗时记录在日志中，用来比较 json 和 TLV
+static int bot_post(const char* uri, bot_body_t* body, bot_data_t* data) {
+    if (!body_finish(body)) {
+        return -1;
+    }
+    rtc_req_result_t post_result = bot_request_post(uri, common_headers, body->data, body->len);
+    last_retry_after_s = post_result.retry_after_s;
+    int64_t parse_start_us = esp_timer_get_time();
+    bool parsed = parse_response(post_result.response, post_result.response_len, post_result.code, data);
+    int parse_us = (int)(esp_timer_get_time() - parse_start_us);
+    ESP_LOGI(TAG, "%s %s: %d bytes out, %d bytes in, encode %d us, parse %d us", BOT_ENCODING_NAME, uri,
+             body->len, post_result.response_len, body->encode_us, parse_us);
+    rtc_request_free(&post_result);
+
+    if (post_result.code != 200) {
+        return post_result.code;
+    }
+    return parsed ? 200 : -1;
+}
+
+// 设备 id 用 STA MAC，服务端据此停止同一设备遗留的上一个智能体
+static void body_add_device_id(bot_body_t* body) {
+    uint8_t mac[6] = {0};
+    char device_id[13];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    snprintf(device_id, sizeof(device_id), "%02X%02X%02X%02X%02X%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    body_add_string(body, CONTROL_TLV_DEVICE_ID, "device_id", device_id);
+}
+
+static void body_add_task(bot_body_t* body, const rtc_room_info_t* room_info) {
+    body_add_string(body, CONTROL_TLV_APP_ID, "app_id", room_info->app_id);
+    body_add_string(body, CONTROL_TLV_ROOM_ID, "room_id", room_info->room_id);
+    body_add_string(body, CONTROL_TLV_TASK_ID, "task_id", room_info->task_id);
+}
+
+// 上一个会话的 room_id 和 task_id 保存在 NVS 中，重启后 resumevoicechat 用它们证明会话属于这台设备；
+// 启动新会话时写入（房间变化时才写 flash），正常停止后删除
+typedef struct {
+    char room_id[sizeof(((rtc_room_info_t*)0)->room_id)];
+    char task_id[sizeof(((rtc_room_info_t*)0)->task_id)];
+} bot_last_session_t;
+
+#define LAST_SESSION_NAMESPACE      "voice_bot"
+#define LAST_SESSION_KEY            "last_session"
+
+static bool last_session_load(bot_last_session_t* last) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(LAST_SESSION_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return false;
+    }
+    size_t length = sizeof(*last);
+    esp_err_t ret = nvs_get_blob(nvs_handle, LAST_SESSION_KEY, last, &length);
+    nvs_close(nvs_handle);
+    return ret == ESP_OK && length == sizeof(*last) && last->task_id[0] != 0;
+}
+
+static void last_session_save(const rtc_room_info_t* room_info) {
+    bot_last_session_t last = {0};
+    bot_last_session_t saved;
+    snprintf(last.room_id, sizeof(last.room_id), "%s", room_info->room_id);
+    snprintf(last.task_id, sizeof(last.task_id), "%s", room_info->task_id);
+    if (last_session_load(&saved) && memcmp(&saved, &last, sizeof(last)) == 0) {
+        return;
+    }
+    nvs_handle_t nvs_handle;
+    if (nvs_open(LAST_SESSION_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    nvs_set_blob(nvs_handle, LAST_SESSION_KEY, &last, sizeof(last));
+    nvs_commit(nvs_handle);
+    nvs_close(nvs_handle);
+}
+
+static void last_session_clear(void) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(LAST_SESSION_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_erase_key(nvs_handle, LAST_SESSION_KEY) == ESP_OK) {
+        nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+}
+
+// startvoicechat 和 resumevoicechat 的参数相同，last 非空时带上上一个会话的 room_id 和 task_id，
+// resumed 非空时返回是否恢复了原来的会话
+static int request_voice_bot(const char* uri, rtc_room_info_t* room_info, const bot_last_session_t* last, bool* resumed) {
+    bot_body_t body;
+    if (!bot_request_begin()) {
+        return -1;
+    }
+    body_init(&body);
 #ifdef CONFIG_AUDIO_CODEC_TYPE_OPUS
-    cJSON_AddStringToObject(post_jobj, "audio_codec", "OPUS");
-    cJSON_AddStringToObject(post_jobj, "room_identifier", "OPUSLOW");
+    body_add_string(&body, CONTROL_TLV_AUDIO_CODEC, "audio_codec", "OPUS");
+    body_add_string(&body, CONTROL_TLV_ROOM_IDENTIFIER, "room_identifier", "OPUSLOW");
 #elif defined(CONFIG_AUDIO_CODEC_TYPE_PCM) || defined(CONFIG_AUDIO_CODEC_TYPE_G711A)
-    cJSON_AddStringToObject(post_jobj, "audio_codec", "G711A");
+    body_add_string(&body, CONTROL_TLV_AUDIO_CODEC, "audio_codec", "G711A");
 #elif defined(CONFIG_AUDIO_CODEC_TYPE_G722)
-    cJSON_AddStringToObject(post_jobj, "audio_codec", "G722");
+    body_add_string(&body, CONTROL_TLV_AUDIO_CODEC, "audio_codec", "G722");
 #elif defined(CONFIG_AUDIO_CODEC_TYPE_AAC)
-    cJSON_AddStringToObject(post_jobj, "audio_codec", "AAC");
+    body_add_string(&body, CONTROL_TLV_AUDIO_CODEC, "audio_codec", "AAC");
 #endif
     // burst 功能
-    cJSON_AddBoolToObject(post_jobj, "enable_burst", 0); // 默认关闭
-    cJSON_AddNumberToObject(post_jobj, "burst_buffer_size", 500); // 500 ms
-    cJSON_AddNumberToObject(post_jobj, "burst_interval", 20);
-
-    const char* json_str = cJSON_Print(post_jobj);
-    strcpy(post_data, json_str);
-    cJSON_Delete(post_jobj);
-
-    rtc_post_config_t post_config = {
-        .uri = "http://" CONFIG_AIGENT_SERVER_HOST "/startvoicechat",
-        .headers = common_headers,
-        .post_data = post_data  // 根据需要传入智能体id和音色id
-    };
-    rtc_req_result_t post_result = rtc_http_post(&post_config);
-    if (post_result.code == 200 && post_result.response != NULL) {
-        // parse json
-        cJSON* root = cJSON_Parse(post_result.response);
-        rtc_request_free(&post_result);
-        if (root == NULL) {
-            ESP_LOGE(TAG, "Error parsing JSON");
-            return -1;
-        }
-        
-        cJSON* data = cJSON_GetObjectItem(root, "data");
+    body_add_bool(&body, CONTROL_TLV_ENABLE_BURST, "enable_burst", false); // 默认关闭
+    body_add_number(&body, CONTROL_TLV_BURST_BUFFER_SIZE, "burst_buffer_size", 500); // 500 ms
+    body_add_number(&body, CONTROL_TLV_BURST_INTERVAL, "burst_interval", 20);
+    body_add_device_id(&body);
+    if (last) {
+        body_add_string(&body, CONTROL_TLV_ROOM_ID, "room_id", last->room_id);
+        body_add_string(&body, CONTROL_TLV_TASK_ID, "task_id", last->task_id);
+    }
 
-        if (data == NULL) {
-            cJSON_Delete(root);
-            ESP_LOGE(TAG, "Not found data object.");
-            return -1;
-        }
-        
-        cJSON* app_id_item = cJSON_GetObjectItem(data, "app_id");
-        const char* app_id = cJSON_GetStringValue(app_id_item);
-        strcpy(room_info->app_id, app_id);
-
-        cJSON* uid_item = cJSON_GetObjectItem(data, "uid");
-        const char* uid = cJSON_GetStringValue(uid_item);
-        strcpy(room_info->uid, uid);
-        
-        cJSON* room_id_item = cJSON_GetObjectItem(data, "room_id");
-        const char* room_id = cJSON_GetStringValue(room_id_item);
-        strcpy(room_info->room_id, room_id);
-
-        cJSON* task_id_item = cJSON_GetObjectItem(data, "task_id");
-        const char* task_id = cJSON_GetStringValue(task_id_item);
-        strcpy(room_info->task_id, task_id);
-
-        cJSON* bot_uid_item = cJSON_GetObjectItem(data, "bot_uid");
-        const char* bot_uid = cJSON_GetStringValue(bot_uid_item);
-        strcpy(room_info->bot_uid, bot_uid);
-
-        cJSON* token_item = cJSON_GetObjectItem(data, "token");
-        const char* token = cJSON_GetStringValue(token_item);
-        strcpy(room_info->token, token);
-        
-        cJSON_Delete(root);
-
-        return 200;
-    } else {
-        cJSON* root = cJSON_Parse(post_result.response);
-        if (root != NULL) {
-            cJSON* message_item = cJSON_GetObjectItem(root, "message");
-            const char* message = cJSON_GetStringValue(message_item);
-            ESP_LOGE(TAG, "Error: %s", message);
-            cJSON_Delete(root);
+    // 根据需要传入智能体id和音色id
+    bot_data_t data;
+    int ret = bot_post(uri, &body, &data);
+    if (ret == 200) {
+        data_copy_string(&data, CONTROL_TLV_APP_ID, "app_id", room_info->app_id, sizeof(room_info->app_id));
+        data_copy_string(&data, CONTROL_TLV_UID, "uid", room_info->uid, sizeof(room_info->uid));
+        data_copy_string(&data, CONTROL_TLV_ROOM_ID, "room_id", room_info->room_id, sizeof(room_info->room_id));
+        data_copy_string(&data, CONTROL_TLV_TASK_ID, "task_id", room_info->task_id, sizeof(room_info->task_id));
+        data_copy_string(&data, CONTROL_TLV_BOT_UID, "bot_uid", room_info->bot_uid, sizeof(room_info->bot_uid));
+        data_copy_string(&data, CONTROL_TLV_TOKEN, "token", room_info->token, sizeof(room_info->token));
+        if (resumed) {
+            *resumed = data_get_bool(&data, CONTROL_TLV_RESUMED, "resumed");
         }
-        return post_result.code;
     }
+    bot_request_end();
+    if (ret == 200) {
+        last_session_save(room_info);
+    }
+    return ret;
+}
+
+int start_voice_bot(rtc_room_info_t* room_info) {
+    return request_voice_bot("http://" CONFIG_AIGENT_SERVER_HOST "/startvoicechat", room_info, NULL, NULL);
+}
+
+int resume_voice_bot(rtc_room_info_t* room_info, bool* resumed) {
+    *resumed = false;
+    bot_last_session_t last;
+    if (!last_session_load(&last)) {
+        // 没有可以恢复的会话，服务端也会启动新会话，这里直接启动
+        return start_voice_bot(room_info);
+    }
+    return request_voice_bot("http://" CONFIG_AIGENT_SERVER_HOST "/resumevoicechat", room_info, &last, resumed);
+}
+
+void voice_bot_warm_up(void) {
+    rtc_http_warm_up("http://" CONFIG_AIGENT_SERVER_HOST "/ping");
+}
+
+int voice_bot_retry_after(void) {
+    return last_retry_after_s;
 }
 
 int stop_voice_bot(const rtc_room_info_t* room_info) {
+    bot_body_t body;
+    if (!bot_request_begin()) {
+        return -1;
+    }
+    body_init(&body);
+    body_add_task(&body, room_info);
 
-    char post_data[512];
-    cJSON *post_jobj = cJSON_CreateObject();
-    cJSON_AddStringToObject(post_jobj, "app_id", room_info->app_id);
-    cJSON_AddStringToObject(post_jobj, "room_id", room_info->room_id);
-    cJSON_AddStringToObject(post_jobj, "task_id", room_info->task_id);
-    
-    const char* json_str = cJSON_Print(post_jobj);
-    strcpy(post_data, json_str);
-    cJSON_Delete(post_jobj);
-    
-    rtc_post_config_t post_config = {
-        .uri = "http://" CONFIG_AIGENT_SERVER_HOST "/stopvoicechat",
-        .headers = common_headers,
-        .post_data = post_data
-    };
-    rtc_req_result_t post_result = rtc_http_post(&post_config);
-    if (post_result.code == 200 && post_result.response != NULL) {
-        // parse json
-        cJSON* root = cJSON_Parse(post_result.response);
-        rtc_request_free(&post_result);
-        if (root == NULL) {
-            ESP_LOGE(TAG, "Error parsing JSON");
-            return -1;
-        }
-        
-        cJSON* data = cJSON_GetObjectItem(root, "data");
+    bot_data_t data;
+    int ret = bot_post("http://" CONFIG_AIGENT_SERVER_HOST "/stopvoicechat", &body, &data);
+    bot_request_end();
+    if (ret == 200) {
+        last_session_clear();
+    }
+    return ret;
+}
 
-        if (data == NULL) {
-            cJSON_Delete(root);
-            ESP_LOGE(TAG, "Not found data object.");
-            return -1;
-        }
-        
-        
-        cJSON_Delete(root);
-
-        return 200;
-    } else {
-        cJSON* root = cJSON_Parse(post_result.response);
-        if (root != NULL) {
-            cJSON* message_item = cJSON_GetObjectItem(root, "message");
-            const char* message = cJSON_GetStringValue(message_item);
-            ESP_LOGE(TAG, "Error: %s", message);
-            cJSON_Delete(root);
-        }
-        return post_result.code;
+int heartbeat_voice_bot(const rtc_room_info_t* room_info) {
+    bot_body_t body;
+    if (!bot_request_begin()) {
+        return -1;
     }
+    body_init(&body);
+    body_add_task(&body, room_info);
+    body_add_device_id(&body);
+
+    bot_data_t data;
+    int ret = bot_post("http://" CONFIG_AIGENT_SERVER_HOST "/heartbeat", &body, &data);
+    bot_request_end();
+    return ret;
 }
 
 int update_voice_bot(const rtc_room_info_t* room_info, const char* command, const char* message) {
-    char post_data[1024];
-    cJSON *post_jobj = cJSON_CreateObject();
-    cJSON_AddStringToObject(post_jobj, "app_id", room_info->app_id);
-    cJSON_AddStringToObject(post_jobj, "room_id", room_info->room_id);
-    cJSON_AddStringToObject(post_jobj, "task_id", room_info->task_id);
-    cJSON_AddStringToObject(post_jobj, "command", command);
+    bot_body_t body;
+    if (!bot_request_begin()) {
+        return -1;
+    }
+    body_init(&body);
+    body_add_task(&body, room_info);
+    body_add_string(&body, CONTROL_TLV_COMMAND, "command", command);
     if (message) {
-        cJSON_AddStringToObject(post_jobj, "message", message);
-    }
-    
-    const char* json_str = cJSON_Print(post_jobj);
-    strcpy(post_data, json_str);
-    cJSON_Delete(post_jobj);
-
-    
-    rtc_post_config_t post_config = {
-        .uri = "http://" CONFIG_AIGENT_SERVER_HOST "/updatevoicechat",
-        .headers = common_headers,
-        .post_data = post_data
-    };
-    rtc_req_result_t post_result = rtc_http_post(&post_config);
-    if (post_result.code == 200 && post_result.response != NULL) {
-        // parse json
-        cJSON* root = cJSON_Parse(post_result.response);
-        rtc_request_free(&post_result);
-        if (root == NULL) {
-            ESP_LOGE(TAG, "Error parsing JSON");
-            return -1;
-        }
-        
-        cJSON* data = cJSON_GetObjectItem(root, "data");
-
-        if (data == NULL) {
-            cJSON_Delete(root);
-            ESP_LOGE(TAG, "Not found data object.");
-            return -1;
-        }
-        
-        cJSON_Delete(root);
-        return 200;
-    } else {
-        cJSON* root = cJSON_Parse(post_result.response);
-        if (root != NULL) {
-            cJSON* message_item = cJSON_GetObjectItem(root, "message");
-            const char* message = cJSON_GetStringValue(message_item);
-            ESP_LOGE(TAG, "Error: %s", message);
-            cJSON_Delete(root);
-        }
-        return post_result.code;
+        body_add_string(&body, CONTROL_TLV_MESSAGE, "message", message);
     }
 
+    bot_data_t data;
+    int ret = bot_post("http://" CONFIG_AIGENT_SERVER_HOST "/updatevoicechat", &body, &data);
+    bot_request_end();
+    return ret;
 }
 
 int interrupt_voice_bot(const rtc_room_info_t* room_info) {
@@ -226,3 +363,30 @@ int interrupt_voice_bot(const rtc_room_info_t* room_info) {
 int voice_bot_function_calling(const rtc_room_info_t* room_info, const char* message) {
     return update_voice_bot(room_info, "function", message);
 }
+
+int renew_voice_bot_token(rtc_room_info_t* room_info) {
+    bot_body_t body;
+    if (!bot_request_begin()) {
+        return -1;
+    }
+    body_init(&body);
+    body_add_string(&body, CONTROL_TLV_APP_ID, "app_id", room_info->app_id);
+    body_add_string(&body, CONTROL_TLV_ROOM_ID, "room_id", room_info->room_id);
+    body_add_string(&body, CONTROL_TLV_UID, "uid", room_info->uid);
+    body_add_string(&body, CONTROL_TLV_TASK_ID, "task_id", room_info->task_id);
+
+    bot_data_t data;
+    int ret = bot_post("http://" CONFIG_AIGENT_SERVER_HOST "/renewtoken", &body, &data);
+    if (ret == 200) {
+        char token[sizeof(room_info->token)];
+        data_copy_string(&data, CONTROL_TLV_TOKEN, "token", token, sizeof(token));
+        if (token[0] == 0) {
+            ESP_LOGE(TAG, "Not found token.");
+            ret = -1;
+        } else {
+            memcpy(room_info->token, token, sizeof(token));
+        }
+    }
+    bot_request_end();
+    return ret;
+}
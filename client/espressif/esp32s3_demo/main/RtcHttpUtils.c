@@ -3,29 +3,64 @@
 
 #include "RtcHttpUtils.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "esp_http_client.h"
+#include "lwip/netdb.h"
+#include "MemPlacement.h"
+#include "TaskTopology.h"
+#include "sdkconfig.h"
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
 #define HTTP_FINSH_BIT 1
+#define HTTP_RESPONSE_BUFFER_SIZE 2048
+#define HTTP_WARM_HOSTS_MAX       2       // 智能体服务端或 Coze，各占一个
+#define HTTP_ORIGIN_SIZE          96
+#define HTTP_WARM_URL_SIZE        160
 
 static const char *TAG = "RTC_HTTP_UTILS";
-#if CONFIG_PSRAM
-static const unsigned int mem_flags =  MALLOC_CAP_SPIRAM;
-#else
-static const unsigned int mem_flags =  MALLOC_CAP_INTERNAL;
-#endif // CONFIG_PSRAM
 
 typedef struct {
     EventGroupHandle_t http_finish_event;
     int output_len; 
+    int response_buffer_size;
+    int64_t connected_us;   // 本次请求新建了连接时为连接完成的时间，复用连接时为 0
     rtc_req_result_t result;
 } rtc_http_post_context_t;
 
+#if CONFIG_HTTP_WARM_CONNECTION
+// 每个 host 保留一个 client，请求之间复用 keep-alive 连接；服务端关闭空闲连接后重新连接时，
+// 开启 CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS 的 https 用保存在 client 中的 session ticket 恢复会话，不需要完整握手
+typedef struct {
+    char origin[HTTP_ORIGIN_SIZE];      // scheme://host:port
+    esp_http_client_handle_t client;
+    SemaphoreHandle_t lock;             // 同一个 client 上的请求串行执行
+    int requests;
+    int connects;
+    int64_t first_connect_us;           // 第一次连接的耗时，https 为完整握手
+    int64_t reconnect_us;               // 之后重新连接的总耗时
+    int64_t last_used_us;               // 上一次请求结束的时间
+} http_host_t;
+
+static http_host_t warm_hosts[HTTP_WARM_HOSTS_MAX];
+static StaticSemaphore_t warm_hosts_lock_buffer;
+static SemaphoreHandle_t warm_hosts_lock = NULL;
+static portMUX_TYPE warm_hosts_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool warm_up_running = false;
+static char warm_up_url[HTTP_WARM_URL_SIZE];
+#endif
+
 static esp_err_t _http_event_handler(esp_http_client_event_t *evt)
 {
     rtc_http_post_context_t *context = (rtc_http_post_context_t *) evt->user_data;
+    if (context == NULL) {
+        // 保留的 client 在两次请求之间断开时没有请求上下文
+        return ESP_OK;
+    }
    
     switch(evt->event_id) {
         case HTTP_EVENT_ERROR:
@@ -33,17 +68,26 @@ static esp_err_t _http_event_handler(esp_http_client_event_t *evt)
             break;
         case HTTP_EVENT_ON_CONNECTED:
             ESP_LOGD(TAG, "HTTP_EVENT_ON_CONNECTED");
+            context->connected_us = esp_timer_get_time();
             break;
         case HTTP_EVENT_HEADER_SENT:
             ESP_LOGD(TAG, "HTTP_EVENT_HEADER_SENT");
             break;
         case HTTP_EVENT_ON_HEADER:
             ESP_LOGD(TAG, "HTTP_EVENT_ON_HEADER, key=%s, value=%s", evt->header_key, evt->header_value);
+            if (strcasecmp(evt->header_key, "Retry-After") == 0) {
+                context->result.retry_after_s = atoi(evt->header_value);
+            }
             break;
         case HTTP_EVENT_ON_DATA:
+            if (context->output_len + evt->data_len >= context->response_buffer_size) {
+                ESP_LOGE(TAG, "response too large, drop %d bytes", evt->data_len);
+                break;
+            }
             memcpy(context->result.response + context->output_len, evt->data, evt->data_len);
             context->output_len += evt->data_len;
             context->result.response[context->output_len] = 0;
+            context->result.response_len = context->output_len;
             break;
         case HTTP_EVENT_ON_FINISH:            
             ESP_LOGD(TAG, "HTTP_EVENT_ON_FINISH");
@@ -58,19 +102,137 @@ static esp_err_t _http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
+#if CONFIG_HTTP_WARM_CONNECTION
+static SemaphoreHandle_t http_hosts_lock(void) {
+    taskENTER_CRITICAL(&warm_hosts_mux);
+    if (warm_hosts_lock == NULL) {
+        warm_hosts_lock = xSemaphoreCreateMutexStatic(&warm_hosts_lock_buffer);
+    }
+    taskEXIT_CRITICAL(&warm_hosts_mux);
+    return warm_hosts_lock;
+}
+
+// 找到 url 所在 host 的 client，没有时占用一个空位；空位用完时返回 NULL，由调用方使用一次性的 client
+static http_host_t* http_host_get(const char* url) {
+    const char* host = strstr(url, "://");
+    host = host ? host + 3 : url;
+    size_t origin_len = strcspn(host, "/?") + (host - url);
+    if (origin_len >= HTTP_ORIGIN_SIZE) {
+        return NULL;
+    }
+    http_host_t* found = NULL;
+    xSemaphoreTake(http_hosts_lock(), portMAX_DELAY);
+    for (int i = 0; i < HTTP_WARM_HOSTS_MAX && found == NULL; i++) {
+        http_host_t* entry = &warm_hosts[i];
+        if (entry->client == NULL) {
+            esp_http_client_config_t http_client_config = {
+                .url = url,
+                .event_handler = _http_event_handler,
+                .disable_auto_redirect = true,
+                .keep_alive_enable = true,
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+                .save_client_session = true,
+#endif
+            };
+            entry->client = esp_http_client_init(&http_client_config);
+            entry->lock = xSemaphoreCreateMutex();
+            if (entry->client == NULL || entry->lock == NULL) {
+                ESP_LOGE(TAG, "create warm client failed");
+                if (entry->client) {
+                    esp_http_client_cleanup(entry->client);
+                    entry->client = NULL;
+                }
+                if (entry->lock) {
+                    vSemaphoreDelete(entry->lock);
+                    entry->lock = NULL;
+                }
+                break;
+            }
+            memcpy(entry->origin, url, origin_len);
+            entry->origin[origin_len] = 0;
+            found = entry;
+        } else if (strncmp(entry->origin, url, origin_len) == 0 && entry->origin[origin_len] == 0) {
+            found = entry;
+        }
+    }
+    xSemaphoreGive(http_hosts_lock());
+    return found;
+}
+
+// 记录连接耗时，估算复用连接和恢复 TLS 会话节省的时间：复用连接省掉整次连接，重新连接省掉完整握手和恢复握手的差
+static void http_host_record(http_host_t* entry, const rtc_http_post_context_t* context, int64_t start_us) {
+    entry->requests++;
+    entry->last_used_us = esp_timer_get_time();
+    if (context->connected_us != 0) {
+        int64_t connect_us = context->connected_us - start_us;
+        if (entry->connects++ == 0) {
+            entry->first_connect_us = connect_us;
+        } else {
+            entry->reconnect_us += connect_us;
+        }
+        ESP_LOGI(TAG, "%s: new connection in %d ms", entry->origin, (int)(connect_us / 1000));
+    }
+    int reused = entry->requests - entry->connects;
+    int reconnects = entry->connects - 1;
+    int64_t reconnect_avg_us = reconnects > 0 ? entry->reconnect_us / reconnects : entry->first_connect_us;
+    int64_t saved_us = entry->first_connect_us * reused + (entry->first_connect_us - reconnect_avg_us) * reconnects;
+    ESP_LOGI(TAG, "%s: %d requests, %d reused, %d connects (first %d ms, later avg %d ms), ~%d ms saved", entry->origin,
+             entry->requests, reused, entry->connects, (int)(entry->first_connect_us / 1000),
+             (int)(reconnect_avg_us / 1000), (int)(saved_us / 1000));
+}
+
+// 空闲接近服务端 keep-alive 超时的连接可能已经被关闭，请求前主动断开，避免请求发到失效的连接上
+static void http_host_drop_idle(http_host_t* entry) {
+    if (entry->last_used_us != 0 &&
+        esp_timer_get_time() - entry->last_used_us > (int64_t)CONFIG_HTTP_WARM_IDLE_TIMEOUT_MS * 1000) {
+        esp_http_client_close(entry->client);
+    }
+}
+#endif
+
+// 执行一次请求，保留的 client 上复用的连接在发送请求时就失败了才重新连接并重试一次。
+// 请求发出后等响应失败（ESP_ERR_HTTP_FETCH_HEADER、超时）不重试：服务端可能已经在处理，
+// 再发一次 startvoicechat 会启动第二个智能体
+static esp_err_t http_perform(esp_http_client_handle_t client, rtc_http_post_context_t* context, bool warm) {
+    esp_http_client_set_user_data(client, context);
+    esp_err_t err = esp_http_client_perform(client);
+    if ((err == ESP_ERR_HTTP_WRITE_DATA || err == ESP_ERR_HTTP_CONNECT) && warm && context->connected_us == 0 &&
+        context->output_len == 0) {
+        ESP_LOGW(TAG, "reused connection failed: %s, reconnect", esp_err_to_name(err));
+        esp_http_client_close(client);
+        err = esp_http_client_perform(client);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "request failed: %s", esp_err_to_name(err));
+        if (warm) {
+            esp_http_client_close(client);
+        }
+    }
+    esp_http_client_set_user_data(client, NULL);
+    return err;
+}
+
 rtc_req_result_t rtc_http_post(rtc_post_config_t* config) {
+    rtc_http_post_context_t context = {0};
     if (!config || !config->uri || !config->post_data) {
         ESP_LOGE(TAG, "Invalid parameters: config");
+        return context.result;
     }
     
-    rtc_http_post_context_t context = {0};
     context.http_finish_event = xEventGroupCreate();
     if (!context.http_finish_event) {
         ESP_LOGE(TAG, "http_finish_event create failed.");
         return context.result;
     }
     context.result.code = 0;
-    context.result.response = heap_caps_malloc(2048, mem_flags);
+    if (config->response_buffer && config->response_buffer_size > 0) {
+        context.result.response = config->response_buffer;
+        context.response_buffer_size = config->response_buffer_size;
+    } else {
+        context.result.response = mem_class_malloc(MEM_CLASS_CONTROL, HTTP_RESPONSE_BUFFER_SIZE);
+        context.result.response_owned = true;
+        context.response_buffer_size = HTTP_RESPONSE_BUFFER_SIZE;
+    }
     if (!context.result.response) {
         vEventGroupDelete(context.http_finish_event);
         ESP_LOGE(TAG, "http_finish_event create failed.");
@@ -78,15 +240,28 @@ rtc_req_result_t rtc_http_post(rtc_post_config_t* config) {
     }
     context.result.response[0] = 0;
     
-    esp_http_client_config_t http_client_config = {
-        .url = config->uri,
-        .query = "",
-        .event_handler = _http_event_handler,
-        .user_data = &context,
-        .disable_auto_redirect = true,
-    };
-
-    esp_http_client_handle_t client = esp_http_client_init(&http_client_config);
+    esp_http_client_handle_t client = NULL;
+#if CONFIG_HTTP_WARM_CONNECTION
+    http_host_t* warm = http_host_get(config->uri);
+    if (warm != NULL) {
+        xSemaphoreTake(warm->lock, portMAX_DELAY);
+        client = warm->client;
+        http_host_drop_idle(warm);
+        esp_http_client_set_url(client, config->uri);
+    }
+#else
+    void* warm = NULL;
+#endif
+    if (client == NULL) {
+        esp_http_client_config_t http_client_config = {
+            .url = config->uri,
+            .query = "",
+            .event_handler = _http_event_handler,
+            .user_data = &context,
+            .disable_auto_redirect = true,
+        };
+        client = esp_http_client_init(&http_client_config);
+    }
     esp_http_client_set_method(client, HTTP_METHOD_POST);
     if (config->headers) {
         int header_index = 0;
@@ -95,28 +270,118 @@ rtc_req_result_t rtc_http_post(rtc_post_config_t* config) {
             header_index += 2;
         }
     }
-    esp_http_client_set_post_field(client, config->post_data, strlen(config->post_data));
-    esp_err_t err = esp_http_client_perform(client);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "request failed: %s", esp_err_to_name(err));
-    }
+    esp_http_client_set_post_field(client, config->post_data, config->post_data_len > 0 ? config->post_data_len : strlen(config->post_data));
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = http_perform(client, &context, warm != NULL);
 
-    EventBits_t ux_bits = xEventGroupWaitBits(context.http_finish_event, HTTP_FINSH_BIT , pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));  // wait 10s
-    if ((ux_bits & HTTP_FINSH_BIT) == 0) {
-        ESP_LOGE(TAG, "request failed: %s", esp_err_to_name(err));
+    if (err == ESP_OK) {
+        EventBits_t ux_bits = xEventGroupWaitBits(context.http_finish_event, HTTP_FINSH_BIT , pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));  // wait 10s
+        if ((ux_bits & HTTP_FINSH_BIT) == 0) {
+            ESP_LOGE(TAG, "request failed: %s", esp_err_to_name(err));
+        }
     }
     
-    context.result.code = esp_http_client_get_status_code(client);
-    ESP_LOGI(TAG, "context.result.code: %d, context.result.response: %s", context.result.code, context.result.response);
+    if (err == ESP_OK) {
+        context.result.code = esp_http_client_get_status_code(client);
+    } else {
+        // 失败时保留的 client 上还是上一次请求的状态码，不能当作本次的响应，按网络错误返回
+        context.result.code = -1;
+        context.result.response_len = 0;
+        context.result.retry_after_s = 0;
+        context.result.response[0] = 0;
+    }
+    // 响应可能是二进制的 TLV，只在 debug 级别打印内容
+    ESP_LOGI(TAG, "context.result.code: %d, response %d bytes in %d ms", context.result.code, context.result.response_len,
+             (int)((esp_timer_get_time() - start_us) / 1000));
+    ESP_LOGD(TAG, "context.result.response: %s", context.result.response);
 
+#if CONFIG_HTTP_WARM_CONNECTION
+    if (warm != NULL) {
+        // post_data 属于调用方，不能留在保留的 client 上
+        esp_http_client_set_post_field(client, NULL, 0);
+        http_host_record(warm, &context, start_us);
+        xSemaphoreGive(warm->lock);
+    } else {
+        esp_http_client_cleanup(client);
+    }
+#else
     esp_http_client_cleanup(client);
+#endif
     vEventGroupDelete(context.http_finish_event);
     return context.result;
 }
 
+#if CONFIG_HTTP_WARM_CONNECTION
+static void http_warm_up_task(void* arg) {
+    const char* url = (const char*)arg;
+    const char* host = strstr(url, "://");
+    host = host ? host + 3 : url;
+    char hostname[64];
+    size_t hostname_len = strcspn(host, ":/?");
+    if (hostname_len < sizeof(hostname)) {
+        // 解析结果留在 lwIP 的 DNS 缓存中，之后的请求不再等待 DNS
+        memcpy(hostname, host, hostname_len);
+        hostname[hostname_len] = 0;
+        struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_STREAM};
+        struct addrinfo* res = NULL;
+        int64_t dns_start_us = esp_timer_get_time();
+        int ret = getaddrinfo(hostname, NULL, &hints, &res);
+        ESP_LOGI(TAG, "prefetch dns %s: %s in %d ms", hostname, ret == 0 ? "ok" : "failed",
+                 (int)((esp_timer_get_time() - dns_start_us) / 1000));
+        if (res) {
+            freeaddrinfo(res);
+        }
+    }
+
+    // 发一个 GET 建立连接（https 同时完成握手并保存 session ticket），响应内容不关心
+    http_host_t* warm = http_host_get(url);
+    if (warm != NULL) {
+        char response[256];
+        rtc_http_post_context_t context = {
+            .response_buffer_size = sizeof(response),
+            .result.response = response,
+        };
+        context.http_finish_event = xEventGroupCreate();
+        if (context.http_finish_event) {
+            xSemaphoreTake(warm->lock, portMAX_DELAY);
+            http_host_drop_idle(warm);
+            esp_http_client_set_url(warm->client, url);
+            esp_http_client_set_method(warm->client, HTTP_METHOD_GET);
+            int64_t start_us = esp_timer_get_time();
+            if (http_perform(warm->client, &context, true) == ESP_OK) {
+                ESP_LOGI(TAG, "warm up %s: code %d in %d ms", url, esp_http_client_get_status_code(warm->client),
+                         (int)((esp_timer_get_time() - start_us) / 1000));
+                http_host_record(warm, &context, start_us);
+            }
+            xSemaphoreGive(warm->lock);
+            vEventGroupDelete(context.http_finish_event);
+        }
+    }
+    warm_up_running = false;
+    vTaskDelete(NULL);
+}
+
+void rtc_http_warm_up(const char* url) {
+    if (warm_up_running) {
+        return;
+    }
+    warm_up_running = true;
+    snprintf(warm_up_url, sizeof(warm_up_url), "%s", url);
+    if (task_topology_create(TASK_ID_HTTP_WARM, http_warm_up_task, warm_up_url, NULL) != pdPASS) {
+        warm_up_running = false;
+    }
+}
+#else
+void rtc_http_warm_up(const char* url) {
+}
+#endif
+
 void rtc_request_free(rtc_req_result_t *result) {
      if (result && result->response) {
-        heap_caps_free(result->response);
+        if (result->response_owned) {
+            mem_class_free(MEM_CLASS_CONTROL, result->response);
+        }
         result->response = NULL;
+        result->response_owned = false;
     }
 }
\ No newline at end of file
@@ -4,18 +4,30 @@
 #ifndef __RTC_HTTP_UTILS_H__
 #define __RTC_HTTP_UTILS_H__
 
+#include <stdbool.h>
+
 typedef struct {
     int code;
     char* response;
+    int response_len;
+    bool response_owned;   // response 由 rtc_http_post 分配，需要调用 rtc_request_free 释放
+    int retry_after_s;     // 响应的 Retry-After 头，单位 s，没有时为 0
 } rtc_req_result_t;
 
 typedef struct {
     const char* uri;
     const char** headers;  // key1,value1,key2,value2....keyn,valuen,NULL
     const char* post_data;
+    int post_data_len;     // 为 0 时 post_data 按字符串处理，二进制请求体需要设置
+    char* response_buffer; // 可选，调用方提供的响应 buffer，为 NULL 时内部分配
+    int response_buffer_size;
 } rtc_post_config_t;
 
 rtc_req_result_t rtc_http_post(rtc_post_config_t* config);
 void rtc_request_free(rtc_req_result_t *result);
 
+// 联网后调用，在后台任务中解析 url 的域名并建立连接（https 同时完成握手），之后同一 host 的请求复用连接；
+// 未开启 CONFIG_HTTP_WARM_CONNECTION 时什么都不做。上一次预热还没结束时忽略
+void rtc_http_warm_up(const char* url);
+
 #endif // __RTC_HTTP_UTILS_H__
\ No newline at end of file
@@ -0,0 +1,329 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "RtcStats.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_task_info.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+#include "MemPlacement.h"
+#include "TaskTopology.h"
+#if CONFIG_RTC_STATS_CONSOLE
+#include "esp_console.h"
+#endif
+
+static const char *TAG = "RTC_STATS";
+
+#if CONFIG_RTC_STATS_ENABLE
+
+#define SYSTEM_STATE_MAX_TASKS  48
+#define RTS_MESSAGE_SIZE        2048
+
+typedef struct {
+    SemaphoreHandle_t lock;
+    rtc_stats_snapshot_t* ring;
+    int ring_size;
+    int head;                  // 下一个写入位置
+    int count;
+    TaskStatus_t* prev;
+    TaskStatus_t* cur;
+    UBaseType_t prev_count;
+    configRUN_TIME_COUNTER_TYPE prev_total;
+    char* rts_buffer;          // RTS 消息 buffer，只在 rtc_stats_send_to_room 中使用
+} rtc_stats_t;
+
+static rtc_stats_t stats = {0};
+
+static const TaskStatus_t* find_task(const TaskStatus_t* tasks, UBaseType_t count, TaskHandle_t handle) {
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (tasks[i].xHandle == handle) {
+            return &tasks[i];
+        }
+    }
+    return NULL;
+}
+
+#if CONFIG_HEAP_TASK_TRACKING
+#define HEAP_TRACKING_MAX_TASKS SYSTEM_STATE_MAX_TASKS
+static heap_task_totals_t heap_totals[HEAP_TRACKING_MAX_TASKS];
+
+static size_t collect_heap_totals(void) {
+    size_t num_totals = 0;
+    heap_task_info_params_t params = {0};
+    params.caps[0] = MALLOC_CAP_INTERNAL;
+    params.mask[0] = MALLOC_CAP_INTERNAL;
+    params.caps[1] = MALLOC_CAP_SPIRAM;
+    params.mask[1] = MALLOC_CAP_SPIRAM;
+    params.totals = heap_totals;
+    params.num_totals = &num_totals;
+    params.max_totals = HEAP_TRACKING_MAX_TASKS;
+    heap_caps_get_per_task_info(&params);
+    return num_totals;
+}
+
+static void fill_task_heap(rtc_stats_task_t* task, TaskHandle_t handle, size_t num_totals) {
+    for (size_t i = 0; i < num_totals; i++) {
+        if (heap_totals[i].task == handle) {
+            task->heap_internal = heap_totals[i].size[0];
+            task->heap_psram = heap_totals[i].size[1];
+            return;
+        }
+    }
+}
+#endif // CONFIG_HEAP_TASK_TRACKING
+
+// 插入排序，只保留 cpu 占用最高的 RTC_STATS_MAX_TASKS 个任务
+static void insert_task(rtc_stats_snapshot_t* snapshot, const rtc_stats_task_t* task) {
+    int pos = snapshot->task_count;
+    if (pos == RTC_STATS_MAX_TASKS) {
+        if (snapshot->tasks[pos - 1].cpu_permille >= task->cpu_permille) {
+            return;
+        }
+        pos--;
+    } else {
+        snapshot->task_count++;
+    }
+    while (pos > 0 && snapshot->tasks[pos - 1].cpu_permille < task->cpu_permille) {
+        snapshot->tasks[pos] = snapshot->tasks[pos - 1];
+        pos--;
+    }
+    snapshot->tasks[pos] = *task;
+}
+
+static void sample(rtc_stats_snapshot_t* snapshot) {
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(stats.cur, SYSTEM_STATE_MAX_TASKS, &total);
+    uint32_t elapsed = (uint32_t)(total - stats.prev_total);
+
+    memset(snapshot, 0, sizeof(rtc_stats_snapshot_t));
+    snapshot->timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    snapshot->interval_ms = elapsed / 1000;
+    snapshot->internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    snapshot->internal_largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    snapshot->internal_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    snapshot->psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    snapshot->psram_largest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+
+#if CONFIG_HEAP_TASK_TRACKING
+    size_t num_totals = collect_heap_totals();
+#endif
+
+    for (int core = 0; core < configNUM_CORES && core < RTC_STATS_MAX_CORES && elapsed > 0; core++) {
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(core);
+        const TaskStatus_t* idle_now = find_task(stats.cur, count, idle);
+        const TaskStatus_t* idle_before = find_task(stats.prev, stats.prev_count, idle);
+        if (idle_now && idle_before) {
+            uint32_t idle_time = (uint32_t)(idle_now->ulRunTimeCounter - idle_before->ulRunTimeCounter);
+            snapshot->core_load[core] = idle_time >= elapsed ? 0 : 100 - (uint32_t)((uint64_t)idle_time * 100 / elapsed);
+        }
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t* now = &stats.cur[i];
+        const TaskStatus_t* before = find_task(stats.prev, stats.prev_count, now->xHandle);
+        rtc_stats_task_t task = {0};
+        strncpy(task.name, now->pcTaskName, RTC_STATS_NAME_LEN - 1);
+        task.core = now->xCoreID == tskNO_AFFINITY ? -1 : (int8_t)now->xCoreID;
+        task.prio = (uint8_t)now->uxCurrentPriority;
+        task.stack_hwm = now->usStackHighWaterMark > UINT16_MAX ? UINT16_MAX : (uint16_t)now->usStackHighWaterMark;
+        if (before && elapsed > 0) {
+            uint32_t run = (uint32_t)(now->ulRunTimeCounter - before->ulRunTimeCounter);
+            task.cpu_permille = (uint16_t)((uint64_t)run * 1000 / elapsed);
+        }
+#if CONFIG_HEAP_TASK_TRACKING
+        fill_task_heap(&task, now->xHandle, num_totals);
+#endif
+        insert_task(snapshot, &task);
+    }
+
+    TaskStatus_t* swap = stats.prev;
+    stats.prev = stats.cur;
+    stats.cur = swap;
+    stats.prev_count = count;
+    stats.prev_total = total;
+}
+
+static void log_snapshot(const rtc_stats_snapshot_t* snapshot, bool with_tasks) {
+    ESP_LOGI(TAG, "[%u ms] load core0 %u%% core1 %u%%, internal free %u largest %u min %u, psram free %u largest %u",
+             (unsigned)snapshot->timestamp_ms, snapshot->core_load[0], snapshot->core_load[1],
+             (unsigned)snapshot->internal_free, (unsigned)snapshot->internal_largest, (unsigned)snapshot->internal_min_free,
+             (unsigned)snapshot->psram_free, (unsigned)snapshot->psram_largest);
+    if (!with_tasks) {
+        return;
+    }
+    for (int i = 0; i < snapshot->task_count; i++) {
+        const rtc_stats_task_t* task = &snapshot->tasks[i];
+        ESP_LOGI(TAG, "  %-16s core %2d prio %2u cpu %2u.%u%% stack_hwm %5u heap %u/%u",
+                 task->name, task->core, task->prio,
+                 task->cpu_permille / 10, task->cpu_permille % 10, task->stack_hwm,
+                 (unsigned)task->heap_internal, (unsigned)task->heap_psram);
+    }
+}
+
+static void rtc_stats_task(void* arg) {
+    rtc_stats_snapshot_t* snapshot = mem_class_malloc(MEM_CLASS_BULK, sizeof(rtc_stats_snapshot_t));
+    if (snapshot == NULL) {
+        vTaskDelete(NULL);
+        return;
+    }
+    stats.prev_count = uxTaskGetSystemState(stats.prev, SYSTEM_STATE_MAX_TASKS, &stats.prev_total);
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_RTC_STATS_INTERVAL_MS));
+        sample(snapshot);
+
+        xSemaphoreTake(stats.lock, portMAX_DELAY);
+        memcpy(&stats.ring[stats.head], snapshot, sizeof(rtc_stats_snapshot_t));
+        stats.head = (stats.head + 1) % stats.ring_size;
+        if (stats.count < stats.ring_size) {
+            stats.count++;
+        }
+        xSemaphoreGive(stats.lock);
+
+#if CONFIG_TASK_TOPOLOGY_MEASURE
+        // 测量模式下每次采样都输出各核负载和各任务占用，用来调整 TaskTopology.c 中的布局
+        log_snapshot(snapshot, true);
+#endif
+    }
+}
+
+#if CONFIG_RTC_STATS_CONSOLE
+static int stats_cmd(int argc, char** argv) {
+    bool all = argc > 1 && strcmp(argv[1], "all") == 0;
+    rtc_stats_dump(all);
+    mem_class_dump_stats();
+    return 0;
+}
+
+static void register_console(void) {
+    esp_console_repl_t* repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "rtc>";
+    esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    if (esp_console_new_repl_uart(&uart_config, &repl_config, &repl) != ESP_OK) {
+        ESP_LOGE(TAG, "create console failed");
+        return;
+    }
+    const esp_console_cmd_t cmd = {
+        .command = "stats",
+        .help = "Print runtime cpu/stack/heap statistics, 'stats all' prints the whole ring",
+        .hint = "[all]",
+        .func = stats_cmd,
+    };
+    esp_console_cmd_register(&cmd);
+    esp_console_start_repl(repl);
+}
+#endif // CONFIG_RTC_STATS_CONSOLE
+
+void rtc_stats_start(void) {
+    if (stats.lock != NULL) {
+        return;
+    }
+    stats.ring_size = CONFIG_RTC_STATS_RING_SIZE;
+    stats.ring = mem_class_calloc(MEM_CLASS_BULK, stats.ring_size, sizeof(rtc_stats_snapshot_t));
+    stats.prev = mem_class_calloc(MEM_CLASS_BULK, SYSTEM_STATE_MAX_TASKS, sizeof(TaskStatus_t));
+    stats.cur = mem_class_calloc(MEM_CLASS_BULK, SYSTEM_STATE_MAX_TASKS, sizeof(TaskStatus_t));
+    stats.rts_buffer = mem_class_malloc(MEM_CLASS_BULK, RTS_MESSAGE_SIZE);
+    stats.lock = xSemaphoreCreateMutex();
+    if (!stats.ring || !stats.prev || !stats.cur || !stats.rts_buffer || !stats.lock) {
+        ESP_LOGE(TAG, "rtc stats init failed");
+        return;
+    }
+    task_topology_create(TASK_ID_STATS, rtc_stats_task, NULL, NULL);
+#if CONFIG_RTC_STATS_CONSOLE
+    register_console();
+#endif
+}
+
+bool rtc_stats_get_snapshot(int index, rtc_stats_snapshot_t* snapshot) {
+    if (stats.lock == NULL || index < 0) {
+        return false;
+    }
+    bool found = false;
+    xSemaphoreTake(stats.lock, portMAX_DELAY);
+    if (index < stats.count) {
+        int pos = (stats.head - 1 - index + stats.ring_size) % stats.ring_size;
+        memcpy(snapshot, &stats.ring[pos], sizeof(rtc_stats_snapshot_t));
+        found = true;
+    }
+    xSemaphoreGive(stats.lock);
+    return found;
+}
+
+void rtc_stats_dump(bool all) {
+    rtc_stats_snapshot_t* snapshot = mem_class_malloc(MEM_CLASS_BULK, sizeof(rtc_stats_snapshot_t));
+    if (snapshot == NULL) {
+        return;
+    }
+    int count = all ? CONFIG_RTC_STATS_RING_SIZE : 1;
+    for (int i = count - 1; i >= 0; i--) {
+        if (rtc_stats_get_snapshot(i, snapshot)) {
+            log_snapshot(snapshot, i == 0);
+        }
+    }
+    mem_class_free(MEM_CLASS_BULK, snapshot);
+}
+
+int rtc_stats_send_to_room(byte_rtc_engine_t engine, const char* room, const char* uid) {
+    static rtc_stats_snapshot_t snapshot;
+    if (stats.rts_buffer == NULL || !rtc_stats_get_snapshot(0, &snapshot)) {
+        return -1;
+    }
+    // stat|length(4)|json，和字幕、function calling 消息的格式保持一致
+    int len = rtc_stats_format_json(&snapshot, stats.rts_buffer + 8, RTS_MESSAGE_SIZE - 8);
+    if (len < 0) {
+        return -1;
+    }
+    memcpy(stats.rts_buffer, "stat", 4);
+    stats.rts_buffer[4] = (len >> 24) & 0xff;
+    stats.rts_buffer[5] = (len >> 16) & 0xff;
+    stats.rts_buffer[6] = (len >> 8) & 0xff;
+    stats.rts_buffer[7] = (len >> 0) & 0xff;
+    byte_rtc_rts_send_message(engine, room, uid, stats.rts_buffer, len + 8, 1, RTS_MESSAGE_RELIABLE);
+    return 0;
+}
+
+#else
+
+void rtc_stats_start(void) {}
+bool rtc_stats_get_snapshot(int index, rtc_stats_snapshot_t* snapshot) { return false; }
+void rtc_stats_dump(bool all) { ESP_LOGW(TAG, "rtc stats disabled"); }
+int rtc_stats_send_to_room(byte_rtc_engine_t engine, const char* room, const char* uid) { return -1; }
+
+#endif // CONFIG_RTC_STATS_ENABLE
+
+int rtc_stats_format_json(const rtc_stats_snapshot_t* snapshot, char* buffer, size_t size) {
+    int len = snprintf(buffer, size,
+                       "{\"ts\":%u,\"load\":[%u,%u],\"int\":[%u,%u,%u],\"psram\":[%u,%u],\"tasks\":[",
+                       (unsigned)snapshot->timestamp_ms, snapshot->core_load[0], snapshot->core_load[1],
+                       (unsigned)snapshot->internal_free, (unsigned)snapshot->internal_largest,
+                       (unsigned)snapshot->internal_min_free,
+                       (unsigned)snapshot->psram_free, (unsigned)snapshot->psram_largest);
+    if (len < 0 || (size_t)len >= size) {
+        return -1;
+    }
+    // 每个任务：[name, core, prio, cpu 千分比, 栈剩余, 内部 RAM, PSRAM]
+    for (int i = 0; i < snapshot->task_count; i++) {
+        const rtc_stats_task_t* task = &snapshot->tasks[i];
+        int n = snprintf(buffer + len, size - len, "%s[\"%s\",%d,%u,%u,%u,%u,%u]",
+                         i == 0 ? "" : ",", task->name, task->core, task->prio,
+                         task->cpu_permille, task->stack_hwm,
+                         (unsigned)task->heap_internal, (unsigned)task->heap_psram);
+        if (n < 0 || (size_t)(len + n) >= size) {
+            return -1;
+        }
+        len += n;
+    }
+    if ((size_t)(len + 2) >= size) {
+        return -1;
+    }
+    buffer[len++] = ']';
+    buffer[len++] = '}';
+    buffer[len] = 0;
+    return len;
+}
@@ -0,0 +1,61 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __RTC_STATS_H__
+#define __RTC_STATS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <VolcEngineRTCLite.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTC_STATS_MAX_TASKS     24
+#define RTC_STATS_MAX_CORES     2
+#define RTC_STATS_NAME_LEN      16
+
+typedef struct {
+    char name[RTC_STATS_NAME_LEN];
+    int8_t core;               // -1 表示未绑核
+    uint8_t prio;
+    uint16_t cpu_permille;     // 采样周期内占单核的千分比
+    uint16_t stack_hwm;        // 栈剩余最小值，单位字节
+    uint32_t heap_internal;    // 任务持有的内部 RAM，需开启 CONFIG_HEAP_TASK_TRACKING
+    uint32_t heap_psram;       // 任务持有的 PSRAM，需开启 CONFIG_HEAP_TASK_TRACKING
+} rtc_stats_task_t;
+
+typedef struct {
+    uint32_t timestamp_ms;
+    uint32_t interval_ms;
+    uint8_t core_load[RTC_STATS_MAX_CORES];  // 百分比
+    uint8_t task_count;
+    uint32_t internal_free;
+    uint32_t internal_largest;               // 最大空闲块，和 free 对比可以看出碎片化程度
+    uint32_t internal_min_free;
+    uint32_t psram_free;
+    uint32_t psram_largest;
+    rtc_stats_task_t tasks[RTC_STATS_MAX_TASKS];  // 按 cpu 占用从高到低排列
+} rtc_stats_snapshot_t;
+
+// 启动周期采样任务，采样结果写入环形缓冲区
+void rtc_stats_start(void);
+
+// 获取最近第 index 个快照（0 为最新），没有数据时返回 false
+bool rtc_stats_get_snapshot(int index, rtc_stats_snapshot_t* snapshot);
+
+// 输出到串口日志，all 为 true 时输出环形缓冲区中的所有快照
+void rtc_stats_dump(bool all);
+
+// 把快照编码成紧凑的 json，返回写入的长度，buffer 不足时返回 -1
+int rtc_stats_format_json(const rtc_stats_snapshot_t* snapshot, char* buffer, size_t size);
+
+// 以 "stat|length(4)|json" 的格式把最新快照通过 RTS 消息发送给房间内的用户
+int rtc_stats_send_to_room(byte_rtc_engine_t engine, const char* room, const char* uid);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __RTC_STATS_H__
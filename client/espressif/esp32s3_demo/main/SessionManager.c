@@ -0,0 +1,737 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "SessionManager.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "esp_event.h"
+#include "esp_wifi.h"
+#include "sdkconfig.h"
+#include "RtcBotUtils.h"
+#include "CozeBotUtils.h"
+#include "MemPlacement.h"
+#include "TaskTopology.h"
+#include "Backoff.h"
+#include "network.h"
+#include "LinkPolicy.h"
+#include "WakeWord.h"
+#include "AudioCapture.h"
+
+static const char *TAG = "SESSION";
+
+#define SESSION_CMD_QUEUE_LEN       4
+#define SESSION_JOIN_TIMEOUT_MS     10000
+#define SESSION_RENEW_RETRY_COUNT   3
+#define SESSION_RENEW_RETRY_MS      2000
+#define SESSION_REJOIN_ATTEMPTS     3       // 用原 token 重新进房的次数，之后重新启动智能体
+#define SESSION_BOT_WAIT_MS         5000    // 重新进房后等待智能体出现的时间
+#define SESSION_RECOVER_ATTEMPTS    10      // 断线恢复的最多尝试次数，之后结束对话
+#define SESSION_RECOVER_MAX_MS      (2 * 60 * 1000)     // 断线恢复的最长时间
+#define SESSION_BACKOFF_BASE_MS     500
+#define SESSION_BACKOFF_MAX_MS      (30 * 1000)
+#define SESSION_HEARTBEAT_MS        (60 * 1000)     // 服务端 SESSION_IDLE_TIMEOUT 的三分之一
+#define SESSION_START_ATTEMPTS      4       // 启动智能体遇到 429 或 5xx 时的尝试次数
+#define SESSION_START_MAX_RETRY_S   30      // 服务端建议的重试时间超过这个值时不再等待，本次对话直接失败
+#define SESSION_QUOTA_HOLD_MS       (10 * 60 * 1000)    // 配额用尽后在这段时间内不再启动对话
+
+#define SESSION_BIT_JOINED          BIT0    // 已进房，可以发送音频
+#define SESSION_BIT_STREAMING       BIT1    // 录音 pipeline 正在运行
+#define SESSION_BIT_BOT_PRESENT     BIT2    // 智能体在房间内
+
+typedef enum {
+    SESSION_CMD_BEGIN = 0,
+    SESSION_CMD_END,
+    SESSION_CMD_RESTART,
+    SESSION_CMD_RENEW_TOKEN,
+    SESSION_CMD_RECOVER,
+    SESSION_CMD_STANDBY,
+    SESSION_CMD_HEARTBEAT,
+} session_cmd_e;
+
+typedef struct {
+    volatile session_state_e state;
+    QueueHandle_t cmd_queue;
+    EventGroupHandle_t events;
+    byte_rtc_event_handler_t handler;
+    // engine 和 pipeline 在第一次对话时创建，之后一直保留
+    byte_rtc_engine_t engine;
+    recorder_pipeline_handle_t recorder;
+    player_pipeline_handle_t player;
+    rtc_room_info_t* room_info;
+    engine_context_t engine_context;
+    int64_t begin_time_us;
+    int session_count;
+    volatile bool recover_pending;
+    volatile int64_t lost_time_us;          // 断线时间，下行音频恢复后清零
+    wake_gate_t* wake_gate;                 // 开启唤醒词时非空，录音 pipeline 在会话之间保持运行
+    esp_timer_handle_t heartbeat_timer;     // 对话中定期通知服务端设备还在，掉电后服务端据此回收智能体
+    volatile int64_t quota_hold_until_us;   // 配额用尽时设置，之前的 begin 直接忽略
+} session_t;
+
+static session_t session = {0};
+
+// 会话状态决定链路模式：进房和恢复时全速，对话中先按 LISTENING 处理，收到下行音频后切到 TALKING
+static void session_set_state(session_state_e state) {
+    static const link_mode_e link_modes[] = {
+        [SESSION_STATE_IDLE]       = LINK_MODE_IDLE,
+        [SESSION_STATE_STARTING]   = LINK_MODE_JOINING,
+        [SESSION_STATE_ACTIVE]     = LINK_MODE_LISTENING,
+        [SESSION_STATE_STOPPING]   = LINK_MODE_JOINING,
+        [SESSION_STATE_RECOVERING] = LINK_MODE_JOINING,
+    };
+    session.state = state;
+    if (state == SESSION_STATE_IDLE && session.wake_gate) {
+        link_policy_set(LINK_MODE_STANDBY);
+    } else {
+        link_policy_set(link_modes[state]);
+    }
+}
+
+static bool session_post(session_cmd_e cmd) {
+    if (session.cmd_queue == NULL) {
+        return false;
+    }
+    if (xQueueSend(session.cmd_queue, &cmd, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "command queue full, drop cmd %d", cmd);
+        return false;
+    }
+    return true;
+}
+
+static void session_wake_tap(const int16_t* samples, int count, void* ctx) {
+    wake_gate_feed(session.wake_gate, samples, count);
+}
+
+// 打开并运行两条 pipeline，只在第一次需要时执行，之后一直保留
+static void session_open_pipelines(void) {
+    if (session.recorder != NULL) {
+        return;
+    }
+    session.recorder = recorder_pipeline_open();
+    session.player = player_pipeline_open();
+    if (session.wake_gate) {
+        recorder_pipeline_set_forward(session.recorder, false);
+        recorder_pipeline_set_tap(session.recorder, session_wake_tap, NULL);
+    }
+    recorder_pipeline_run(session.recorder);
+    player_pipeline_run(session.player);
+}
+
+// 回到等待唤醒词：AFE 输出只给检测器，不编码不上行
+static void session_enter_standby(void) {
+    if (session.wake_gate == NULL) {
+        return;
+    }
+    recorder_pipeline_set_forward(session.recorder, false);
+    wake_gate_set_session(session.wake_gate, false);
+}
+
+static void session_create_engine(void) {
+    session.engine = byte_rtc_create(session.room_info->app_id, &session.handler);
+    byte_rtc_set_log_level(session.engine, BYTE_RTC_LOG_LEVEL_ERROR);
+    byte_rtc_set_params(session.engine, "{\"debug\":{\"log_to_console\":1}}");
+#ifdef RTC_DEMO_AUDIO_PIPELINE_CODEC_PCM
+    byte_rtc_set_params(session.engine,"{\"audio\":{\"codec\":{\"internal\":{\"enable\":1}}}}");
+#endif
+
+    byte_rtc_init(session.engine);
+#ifdef CONFIG_AUDIO_CODEC_TYPE_OPUS
+    byte_rtc_set_audio_codec(session.engine, AUDIO_CODEC_TYPE_OPUS);
+#elif defined(CONFIG_AUDIO_CODEC_TYPE_PCM) || defined(CONFIG_AUDIO_CODEC_TYPE_G711A)
+    byte_rtc_set_audio_codec(session.engine, AUDIO_CODEC_TYPE_G711A);
+#elif defined(CONFIG_AUDIO_CODEC_TYPE_G722)
+    byte_rtc_set_audio_codec(session.engine, AUDIO_CODEC_TYPE_G722);
+#elif defined(CONFIG_AUDIO_CODEC_TYPE_AAC)
+    byte_rtc_set_audio_codec(session.engine, AUDIO_CODEC_TYPE_AACLC);
+#endif
+
+    // byte_rtc_set_video_codec(engine, VIDEO_CODEC_TYPE_H264); // 需要视频功能时设置
+
+    session.engine_context.player_pipeline = session.player;
+    session.engine_context.room_info = session.room_info;
+    byte_rtc_set_user_data(session.engine, &session.engine_context);
+}
+
+// 用 room_info 中的房间和 token 进房，等待进房成功
+static bool session_join_room(void) {
+    byte_rtc_room_options_t options;
+    options.auto_subscribe_audio = 1; // 接收远端音频
+    options.auto_subscribe_video = 0; // 不接收远端视频
+    options.auto_publish_audio = 1;   // 发送音频
+    options.auto_publish_video = 0;   // 发送视频
+    xEventGroupClearBits(session.events, SESSION_BIT_JOINED | SESSION_BIT_BOT_PRESENT);
+    byte_rtc_join_room(session.engine, session.room_info->room_id, session.room_info->uid, session.room_info->token, &options);
+
+    EventBits_t bits = xEventGroupWaitBits(session.events, SESSION_BIT_JOINED, pdFALSE, pdTRUE, pdMS_TO_TICKS(SESSION_JOIN_TIMEOUT_MS));
+    if (!(bits & SESSION_BIT_JOINED)) {
+        ESP_LOGE(TAG, "join room %s timeout", session.room_info->room_id);
+        return false;
+    }
+    return true;
+}
+
+static void session_do_end(void) {
+    if (session.state != SESSION_STATE_ACTIVE) {
+        return;
+    }
+    session_set_state(SESSION_STATE_STOPPING);
+    int64_t start_us = esp_timer_get_time();
+    esp_timer_stop(session.heartbeat_timer);
+    xEventGroupClearBits(session.events, SESSION_BIT_JOINED | SESSION_BIT_STREAMING);
+    audio_capture_stop();
+
+    // engine 保持初始化状态，只退房
+    byte_rtc_leave_room(session.engine, session.room_info->room_id);
+    // 不调用 stop 的话智能体要 3 分钟后才会停止
+    stop_voice_bot(session.room_info);
+
+    if (session.wake_gate) {
+        session_enter_standby();
+    } else {
+        recorder_pipeline_pause(session.recorder);
+    }
+    player_pipeline_pause(session.player);
+    session.engine_context.remote_uid[0] = 0;
+
+    session_set_state(SESSION_STATE_IDLE);
+    ESP_LOGI(TAG, "session %d ended in %d ms", session.session_count, (int)((esp_timer_get_time() - start_us) / 1000));
+    if (session.wake_gate) {
+        wake_stats_t stats;
+        wake_gate_get_stats(session.wake_gate, &stats);
+        ESP_LOGI(TAG, "wake stats: %u detections, %u false accepts, %u silence ends, latency avg %u max %u ms",
+                 (unsigned)stats.detections, (unsigned)stats.false_accepts, (unsigned)stats.silence_ends,
+                 (unsigned)(stats.latency_count ? stats.latency_ms_sum / stats.latency_count : 0), (unsigned)stats.latency_ms_max);
+    }
+    audio_plc_stats_t plc_stats;
+    if (player_pipeline_get_plc_stats(session.player, &plc_stats)) {
+        ESP_LOGI(TAG, "plc stats since boot: %u frames, %u concealed (%u early), %u fec recovered, %u late, %u duplicates, %u resyncs, %u decode errors",
+                 (unsigned)plc_stats.frames, (unsigned)plc_stats.concealed, (unsigned)plc_stats.early_concealed,
+                 (unsigned)plc_stats.fec_recovered,
+                 (unsigned)plc_stats.late, (unsigned)plc_stats.duplicates, (unsigned)plc_stats.resyncs,
+                 (unsigned)plc_stats.decode_errors);
+    }
+    reorder_window_stats_t reorder_stats;
+    if (player_pipeline_get_reorder_stats(session.player, &reorder_stats)) {
+        ESP_LOGI(TAG, "reorder stats since boot: %u released, %u reordered (max depth %u), %u late, %u duplicates, %u gaps, hold avg %u ms max %u ms",
+                 (unsigned)reorder_stats.released, (unsigned)reorder_stats.reordered, (unsigned)reorder_stats.max_depth,
+                 (unsigned)reorder_stats.late, (unsigned)reorder_stats.duplicates, (unsigned)reorder_stats.gaps,
+                 (unsigned)(reorder_stats.held_frames ? reorder_stats.hold_ms_sum / reorder_stats.held_frames : 0),
+                 (unsigned)reorder_stats.hold_ms_max);
+    }
+    audio_playout_stats_t playout_stats;
+    if (player_pipeline_get_playout_stats(session.player, &playout_stats)) {
+        ESP_LOGI(TAG, "playout stats since boot: target %u ms (jitter %u ms), %u frames, %u compressed, %u stretched, %u talkspurts, removed %u samples, inserted %u samples",
+                 (unsigned)playout_stats.target_ms, (unsigned)playout_stats.jitter_ms, (unsigned)playout_stats.frames,
+                 (unsigned)playout_stats.compressed, (unsigned)playout_stats.stretched, (unsigned)playout_stats.talkspurts,
+                 (unsigned)playout_stats.removed_samples, (unsigned)playout_stats.inserted_samples);
+    }
+}
+
+// 服务端限流（429）或暂时不可用（5xx、网络错误）时重试，等待时间优先用服务端的 Retry-After 并加上最多一半的随机抖动，
+// 让同时上电的设备错开；没有 Retry-After 时按指数退避。其他错误（例如 4xx）重试也不会成功，直接返回
+// resume 为 true 时先尝试恢复服务端保留的上一个会话（重启前的房间和智能体），没有时服务端启动新会话
+static int session_start_voice_bot(bool resume) {
+    backoff_t backoff;
+    backoff_init(&backoff, SESSION_BACKOFF_BASE_MS, SESSION_BACKOFF_MAX_MS);
+    int ret = -1;
+    for (int i = 0; i < SESSION_START_ATTEMPTS; i++) {
+        bool resumed = false;
+        ret = resume ? resume_voice_bot(session.room_info, &resumed) : start_voice_bot(session.room_info);
+        if (ret == 200 && resume) {
+            ESP_LOGI(TAG, "%s room %s", resumed ? "resumed" : "started new", session.room_info->room_id);
+        }
+        if (ret == 200 || (ret != 429 && ret < 500 && ret > 0)) {
+            return ret;
+        }
+        if (i == SESSION_START_ATTEMPTS - 1) {
+            break;
+        }
+        uint32_t wait_ms;
+        int retry_after_s = voice_bot_retry_after();
+        if (retry_after_s > SESSION_START_MAX_RETRY_S) {
+            ESP_LOGW(TAG, "server asks to retry after %d s, give up", retry_after_s);
+            break;
+        } else if (retry_after_s > 0) {
+            wait_ms = retry_after_s * 1000;
+            wait_ms += esp_random() % (wait_ms / 2 + 1);
+        } else {
+            wait_ms = backoff_next_ms(&backoff);
+        }
+        ESP_LOGW(TAG, "Bot start ret = %d, retry in %u ms", ret, (unsigned)wait_ms);
+        vTaskDelay(pdMS_TO_TICKS(wait_ms));
+    }
+    return ret;
+}
+
+static void session_do_begin(void) {
+    if (session.state != SESSION_STATE_IDLE) {
+        return;
+    }
+    if (session.quota_hold_until_us > esp_timer_get_time()) {
+        ESP_LOGW(TAG, "quota exceeded, not starting for another %d s",
+                 (int)((session.quota_hold_until_us - esp_timer_get_time()) / 1000000));
+        // 唤醒触发的 begin 到这里时 gate 已经进入会话，不回到待机的话之后不会再检测唤醒词
+        session_enter_standby();
+        return;
+    }
+    session_set_state(SESSION_STATE_STARTING);
+    session.begin_time_us = esp_timer_get_time();
+    bool cold = (session.engine == NULL);
+    if (session.wake_gate) {
+        // 唤醒触发时 gate 已经进入会话；直接调用 begin 时也要停止检测唤醒词
+        wake_gate_set_session(session.wake_gate, true);
+    }
+
+    // step 1: start ai agent & get room info
+    // 重启后的第一次对话先尝试恢复，重启前的智能体如果还在，可以接着之前的上下文继续对话
+    int start_ret = session_start_voice_bot(session.session_count == 0);
+    if (start_ret != 200) {
+        ESP_LOGE(TAG, "Bot start Failed, ret = %d", start_ret);
+        session_enter_standby();
+        session_set_state(SESSION_STATE_IDLE);
+        return;
+    }
+
+    // step 2: start audio capture & play，之后的对话只需要 resume
+    if (session.recorder == NULL) {
+        session_open_pipelines();
+    } else {
+        // 开启唤醒词时录音 pipeline 一直在运行
+        if (!session.wake_gate) {
+            recorder_pipeline_resume(session.recorder);
+        }
+        player_pipeline_resume(session.player);
+    }
+    player_pipeline_reset_plc(session.player);
+
+    // step 3: start byte rtc engine，只在第一次对话时创建
+    if (cold) {
+        session_create_engine();
+    }
+
+    // step 4: join room
+    audio_capture_start();
+    if (session.wake_gate) {
+        recorder_pipeline_set_forward(session.recorder, true);
+    }
+    xEventGroupSetBits(session.events, SESSION_BIT_STREAMING);
+    session.session_count++;
+    // 进房完成前链路保持 JOINING，进房失败时由 session_do_end 回到 IDLE
+    session.state = SESSION_STATE_ACTIVE;
+    if (!session_join_room()) {
+        session_do_end();
+        return;
+    }
+    session_set_state(SESSION_STATE_ACTIVE);
+    esp_timer_start_periodic(session.heartbeat_timer, SESSION_HEARTBEAT_MS * 1000);
+    ESP_LOGI(TAG, "session %d (%s) ready in %d ms", session.session_count, cold ? "cold" : "warm",
+             (int)((esp_timer_get_time() - session.begin_time_us) / 1000));
+    if (cold) {
+        mem_class_dump_stats();
+    }
+}
+
+// 在控制任务中请求新 token 并原地更新，不退房，上行和下行音频都不受影响
+// token 过期前 30 秒收到提醒，重试间隔要保证在过期前完成
+static void session_do_renew_token(void) {
+    if (session.state != SESSION_STATE_ACTIVE) {
+        return;
+    }
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < SESSION_RENEW_RETRY_COUNT; i++) {
+        int ret = renew_voice_bot_token(session.room_info);
+        if (ret == 200) {
+            ret = byte_rtc_renew_token(session.engine, session.room_info->room_id, session.room_info->token);
+            ESP_LOGI(TAG, "renew token ret %d in %d ms", ret, (int)((esp_timer_get_time() - start_us) / 1000));
+            return;
+        }
+        ESP_LOGW(TAG, "fetch new token failed, ret %d, retry %d", ret, i + 1);
+        vTaskDelay(pdMS_TO_TICKS(SESSION_RENEW_RETRY_MS));
+    }
+    // 服务端没有这个会话（例如已被回收或服务重启）时不会再给出 token，过期前重新开始对话
+    ESP_LOGE(TAG, "renew token failed, restart session");
+    session_do_end();
+    session_do_begin();
+}
+
+// 恢复过程中的退避等待，同时处理控制命令：END 和 RESTART 结束恢复，返回 false 并通过 stop_cmd 带回；
+// RENEW_TOKEN 记下来，恢复后再更新；其他命令（heartbeat、重复的 RECOVER 等）在恢复过程中没有意义，直接丢弃
+static bool session_recover_wait(uint32_t wait_ms, session_cmd_e* stop_cmd, bool* renew_pending) {
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)wait_ms * 1000;
+    session_cmd_e cmd;
+    while (true) {
+        int64_t remain_us = deadline_us - esp_timer_get_time();
+        if (remain_us <= 0) {
+            return true;
+        }
+        if (xQueueReceive(session.cmd_queue, &cmd, pdMS_TO_TICKS(remain_us / 1000) + 1) != pdTRUE) {
+            continue;
+        }
+        if (cmd == SESSION_CMD_END || cmd == SESSION_CMD_RESTART) {
+            *stop_cmd = cmd;
+            return false;
+        }
+        if (cmd == SESSION_CMD_RENEW_TOKEN) {
+            *renew_pending = true;
+        }
+    }
+}
+
+// 断线恢复：先等 Wi-Fi，再用原 token 重新进房，智能体还在房间内时对话可以直接继续；
+// 多次失败或智能体已经离开时才重新启动智能体。每次尝试之间按带抖动的指数退避等待
+// 恢复在控制任务中进行，尝试次数和总时间都有上限，收到 END 或配额用尽时也停止，之后结束对话回到 IDLE（或待机）
+static void session_do_recover(void) {
+    session.recover_pending = false;
+    if (session.state != SESSION_STATE_ACTIVE) {
+        return;
+    }
+    session_set_state(SESSION_STATE_RECOVERING);
+    xEventGroupClearBits(session.events, SESSION_BIT_JOINED);
+    if (session.lost_time_us == 0) {
+        session.lost_time_us = esp_timer_get_time();
+    }
+
+    backoff_t backoff;
+    backoff_init(&backoff, SESSION_BACKOFF_BASE_MS, SESSION_BACKOFF_MAX_MS);
+    int64_t start_us = esp_timer_get_time();
+    int rejoin_count = 0;
+    bool recovered = false;
+    bool restarted = false;
+    bool renew_pending = false;
+    session_cmd_e stop_cmd = SESSION_CMD_END;
+    const char* reason = "too many attempts";
+    for (int attempt = 0; attempt < SESSION_RECOVER_ATTEMPTS; attempt++) {
+        if (!session_recover_wait(backoff_next_ms(&backoff), &stop_cmd, &renew_pending)) {
+            reason = "session ended";
+            break;
+        }
+        if (esp_timer_get_time() - start_us > (int64_t)SESSION_RECOVER_MAX_MS * 1000) {
+            reason = "timeout";
+            break;
+        }
+        if (session.quota_hold_until_us > esp_timer_get_time()) {
+            reason = "quota exceeded";
+            break;
+        }
+        if (!network_wait_connected(0)) {
+            continue;
+        }
+        // SDK 自己重连成功时会回调 on_join_room_success(rejoin = true)
+        if (xEventGroupGetBits(session.events) & SESSION_BIT_JOINED) {
+            recovered = true;
+            break;
+        }
+        if (rejoin_count < SESSION_REJOIN_ATTEMPTS) {
+            rejoin_count++;
+            ESP_LOGI(TAG, "rejoin room %s, attempt %d", session.room_info->room_id, rejoin_count);
+            byte_rtc_leave_room(session.engine, session.room_info->room_id);
+            if (!session_join_room()) {
+                continue;
+            }
+            EventBits_t bits = xEventGroupWaitBits(session.events, SESSION_BIT_BOT_PRESENT, pdFALSE, pdTRUE, pdMS_TO_TICKS(SESSION_BOT_WAIT_MS));
+            if (bits & SESSION_BIT_BOT_PRESENT) {
+                recovered = true;
+                break;
+            }
+            ESP_LOGW(TAG, "bot not in room after rejoin, restart voice bot");
+            rejoin_count = SESSION_REJOIN_ATTEMPTS;
+        }
+
+        // 智能体已经不在了，重新启动智能体并进入新房间
+        byte_rtc_leave_room(session.engine, session.room_info->room_id);
+        stop_voice_bot(session.room_info);
+        int start_ret = session_start_voice_bot(false);
+        if (start_ret != 200) {
+            ESP_LOGE(TAG, "Bot start Failed, ret = %d", start_ret);
+            continue;
+        }
+        if (session_join_room()) {
+            recovered = true;
+            restarted = true;
+            break;
+        }
+    }
+
+    // 由 session_do_end 退房、停止智能体并回到 IDLE
+    session.state = SESSION_STATE_ACTIVE;
+    if (!recovered) {
+        ESP_LOGE(TAG, "give up recovering after %d ms: %s", (int)((esp_timer_get_time() - start_us) / 1000), reason);
+        session.lost_time_us = 0;
+        session_do_end();
+        if (stop_cmd == SESSION_CMD_RESTART) {
+            session_do_begin();
+        }
+        return;
+    }
+    session_set_state(SESSION_STATE_ACTIVE);
+    ESP_LOGI(TAG, "uplink audio recovered in %d ms by %s", (int)((esp_timer_get_time() - session.lost_time_us) / 1000),
+             restarted ? "restarting voice bot" : "rejoining room");
+    // 重新启动智能体时已经拿到了新 token
+    if (renew_pending && !restarted) {
+        session_do_renew_token();
+    }
+}
+
+// 只打开 pipeline 检测唤醒词，不启动智能体也不进房
+static void session_do_standby(void) {
+    if (session.state != SESSION_STATE_IDLE) {
+        return;
+    }
+    session_open_pipelines();
+    player_pipeline_pause(session.player);
+    session_enter_standby();
+    session_set_state(SESSION_STATE_IDLE);
+    ESP_LOGI(TAG, "waiting for wake word");
+}
+
+// 失败只记录，服务端超时前还有两次机会；恢复过程中 room_info 可能正在更新，跳过这一次
+static void session_do_heartbeat(void) {
+    if (session.state != SESSION_STATE_ACTIVE || session.recover_pending) {
+        return;
+    }
+    int ret = heartbeat_voice_bot(session.room_info);
+    if (ret != 200) {
+        ESP_LOGW(TAG, "heartbeat failed, ret = %d", ret);
+    }
+}
+
+static void session_heartbeat_cb(void* arg) {
+    session_post(SESSION_CMD_HEARTBEAT);
+}
+
+static void session_ctrl_task(void* arg) {
+    session_cmd_e cmd;
+    while (true) {
+        if (xQueueReceive(session.cmd_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        switch (cmd) {
+            case SESSION_CMD_BEGIN:
+                session_do_begin();
+                break;
+            case SESSION_CMD_END:
+                session_do_end();
+                break;
+            case SESSION_CMD_RESTART:
+                session_do_end();
+                session_do_begin();
+                break;
+            case SESSION_CMD_RENEW_TOKEN:
+                session_do_renew_token();
+                break;
+            case SESSION_CMD_RECOVER:
+                session_do_recover();
+                break;
+            case SESSION_CMD_STANDBY:
+                session_do_standby();
+                break;
+            case SESSION_CMD_HEARTBEAT:
+                session_do_heartbeat();
+                break;
+        }
+    }
+}
+
+// 上行任务只负责读取录音 pipeline 并发送，会话切换由控制任务完成
+static void session_uplink_task(void* arg) {
+    uint8_t* audio_buffer = NULL;
+    int read_size = 0;
+
+    while (true) {
+        xEventGroupWaitBits(session.events, SESSION_BIT_STREAMING, pdFALSE, pdTRUE, portMAX_DELAY);
+        if (audio_buffer == NULL) {
+            read_size = recorder_pipeline_get_default_read_size(session.recorder);
+            // 每个上行音频帧都会访问，放在内部 RAM
+            audio_buffer = mem_class_malloc(MEM_CLASS_HOT_AUDIO, read_size);
+            if (!audio_buffer) {
+                ESP_LOGE(TAG, "Failed to alloc audio buffer!");
+                vTaskDelete(NULL);
+                return;
+            }
+        }
+
+        int ret = recorder_pipeline_read(session.recorder, (char*) audio_buffer, read_size);
+        if (ret == read_size && (xEventGroupGetBits(session.events) & SESSION_BIT_JOINED)) {
+            // push_audio data
+#ifdef RTC_DEMO_AUDIO_PIPELINE_CODEC_PCM
+            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_PCM};
+#elif defined(CONFIG_AUDIO_CODEC_TYPE_G711A)
+            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_PCMA};
+#elif defined(CONFIG_AUDIO_CODEC_TYPE_G722)
+            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_G722};
+#elif defined(CONFIG_AUDIO_CODEC_TYPE_AAC)
+            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_AAC};
+#elif defined(CONFIG_AUDIO_CODEC_TYPE_OPUS)
+            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_OPUS};
+#endif
+            byte_rtc_send_audio_data(session.engine, session.room_info->room_id, audio_buffer, read_size, &audio_frame_info);
+            audio_capture_write(CAPTURE_STREAM_UPLINK, audio_buffer, read_size, 0);
+        }
+    }
+}
+
+static void session_wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    // Wi-Fi 断开时 RTC 房间一定也断了，不等 SDK 超时直接进入恢复流程
+    session_manager_on_connection_lost();
+}
+
+#if CONFIG_WAKE_WORD_ENABLE
+static void session_on_wake(void* ctx) {
+    session_manager_begin();
+}
+
+static void session_on_silence(void* ctx) {
+    session_manager_end();
+}
+
+static void session_create_wake_gate(void) {
+    wake_detector_t* detector = NULL;
+#if CONFIG_WAKE_WORD_DETECTOR_WAKENET
+    detector = wake_detector_wakenet_create();
+    if (detector == NULL) {
+        ESP_LOGW(TAG, "wakenet unavailable, fallback to energy detector");
+    }
+#endif
+    if (detector == NULL) {
+        detector = wake_detector_energy_create(CONFIG_WAKE_WORD_ENERGY_THRESHOLD, CONFIG_WAKE_WORD_ENERGY_HOLD_MS);
+    }
+    if (detector == NULL) {
+        ESP_LOGE(TAG, "create wake detector failed");
+        return;
+    }
+    wake_gate_config_t config = {
+        .on_wake = session_on_wake,
+        .on_silence = session_on_silence,
+        .ctx = NULL,
+        .vad_threshold = CONFIG_WAKE_WORD_VAD_THRESHOLD,
+        .silence_end_ms = CONFIG_WAKE_WORD_SILENCE_END_MS,
+    };
+    session.wake_gate = wake_gate_create(detector, &config);
+    if (session.wake_gate == NULL) {
+        detector->destroy(detector);
+    }
+}
+#endif
+
+void session_manager_start(const byte_rtc_event_handler_t* handler) {
+    if (session.cmd_queue != NULL) {
+        return;
+    }
+    session.handler = *handler;
+    // room_id 在每个上行音频帧里都会被访问，放在内部 RAM
+    session.room_info = mem_class_calloc(MEM_CLASS_HOT_AUDIO, 1, sizeof(rtc_room_info_t));
+    session.cmd_queue = xQueueCreate(SESSION_CMD_QUEUE_LEN, sizeof(session_cmd_e));
+    session.events = xEventGroupCreate();
+    const esp_timer_create_args_t heartbeat_args = {
+        .callback = session_heartbeat_cb,
+        .name = "session_heartbeat",
+    };
+    esp_timer_create(&heartbeat_args, &session.heartbeat_timer);
+    if (!session.room_info || !session.cmd_queue || !session.events || !session.heartbeat_timer) {
+        ESP_LOGE(TAG, "session manager init failed");
+        return;
+    }
+#if CONFIG_WAKE_WORD_ENABLE
+    session_create_wake_gate();
+#endif
+    session_set_state(SESSION_STATE_IDLE);
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, session_wifi_event_handler, NULL);
+    task_topology_create(TASK_ID_SESSION_CTRL, session_ctrl_task, NULL, NULL);
+    task_topology_create(TASK_ID_RTC_UPLINK, session_uplink_task, NULL, NULL);
+}
+
+bool session_manager_begin(void) {
+    return session_post(SESSION_CMD_BEGIN);
+}
+
+bool session_manager_standby(void) {
+    if (session.wake_gate == NULL) {
+        ESP_LOGW(TAG, "wake word not available, start session directly");
+        return session_manager_begin();
+    }
+    return session_post(SESSION_CMD_STANDBY);
+}
+
+bool session_manager_end(void) {
+    return session_post(SESSION_CMD_END);
+}
+
+bool session_manager_restart(void) {
+    return session_post(SESSION_CMD_RESTART);
+}
+
+session_state_e session_manager_get_state(void) {
+    return session.state;
+}
+
+void session_manager_on_join_room_success(void) {
+    if (session.events) {
+        xEventGroupSetBits(session.events, SESSION_BIT_JOINED);
+    }
+}
+
+void session_manager_on_user_joined(const char* uid) {
+    if (session.events && uid && strcmp(uid, session.room_info->bot_uid) == 0) {
+        xEventGroupSetBits(session.events, SESSION_BIT_BOT_PRESENT);
+    }
+}
+
+void session_manager_on_user_offline(const char* uid) {
+    if (session.events == NULL || uid == NULL || strcmp(uid, session.room_info->bot_uid) != 0) {
+        return;
+    }
+    xEventGroupClearBits(session.events, SESSION_BIT_BOT_PRESENT);
+    // 智能体空闲超时后会退房，此时结束本次对话并开始新的对话，engine 和 pipeline 不重建
+    // 断线恢复过程中智能体离开由恢复流程处理
+    if (session.state == SESSION_STATE_ACTIVE && !session.recover_pending) {
+        ESP_LOGI(TAG, "bot %s left the room", uid);
+        // 开启唤醒词时回到待机，等下一次唤醒再启动智能体
+        if (session.wake_gate) {
+            session_manager_end();
+        } else {
+            session_manager_restart();
+        }
+    }
+}
+
+void session_manager_on_connection_lost(void) {
+    if (session.state != SESSION_STATE_ACTIVE || session.recover_pending) {
+        return;
+    }
+    session.lost_time_us = esp_timer_get_time();
+    session.recover_pending = true;
+    xEventGroupClearBits(session.events, SESSION_BIT_JOINED);
+    if (!session_post(SESSION_CMD_RECOVER)) {
+        session.recover_pending = false;
+    }
+}
+
+void session_manager_on_audio_data(void) {
+    link_policy_on_downlink_audio();
+    if (session.wake_gate) {
+        wake_gate_note_downlink(session.wake_gate);
+    }
+    // 只在断线恢复后的第一帧下行音频输出一次日志
+    if (session.lost_time_us != 0 && session.state == SESSION_STATE_ACTIVE) {
+        ESP_LOGI(TAG, "downlink audio recovered in %d ms", (int)((esp_timer_get_time() - session.lost_time_us) / 1000));
+        session.lost_time_us = 0;
+    }
+}
+
+void session_manager_on_token_will_expire(void) {
+    ESP_LOGI(TAG, "token privilege will expire");
+    session_post(SESSION_CMD_RENEW_TOKEN);
+}
+
+void session_manager_on_quota_exceeded(const char* message) {
+    ESP_LOGE(TAG, "quota exceeded: %s", message ? message : "");
+    // 智能体会自动离房，结束当前对话，充值前反复启动只会继续失败
+    session.quota_hold_until_us = esp_timer_get_time() + (int64_t)SESSION_QUOTA_HOLD_MS * 1000;
+    session_post(SESSION_CMD_END);
+}
@@ -0,0 +1,58 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __SESSION_MANAGER_H__
+#define __SESSION_MANAGER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <VolcEngineRTCLite.h>
+#include "common.h"
+#include "AudioPipeline.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SESSION_STATE_IDLE = 0,    // engine 已初始化（首次会话之后），pipeline 暂停；开启唤醒词时录音 pipeline 保持运行
+    SESSION_STATE_STARTING,    // 正在启动智能体、进房
+    SESSION_STATE_ACTIVE,      // 已进房，正在收发音频
+    SESSION_STATE_STOPPING,    // 正在退房、停止智能体
+    SESSION_STATE_RECOVERING,  // 断线后正在重连
+} session_state_e;
+
+// 通过 byte_rtc_get_user_data 在回调中获取
+typedef struct {
+    player_pipeline_handle_t player_pipeline;
+    rtc_room_info_t* room_info;
+    char remote_uid[128];
+} engine_context_t;
+
+// 创建会话控制任务和上行音频任务，handler 中的回调在 engine 创建时注册
+void session_manager_start(const byte_rtc_event_handler_t* handler);
+
+// 异步开始/结束一次对话，只是向控制任务投递命令
+bool session_manager_begin(void);
+bool session_manager_end(void);
+// 结束当前对话并立即开始下一次
+bool session_manager_restart(void);
+// 打开 pipeline 只检测唤醒词，唤醒后开始对话，静音超时后自动结束；未开启唤醒词时等同于 begin
+bool session_manager_standby(void);
+
+session_state_e session_manager_get_state(void);
+
+// 以下由 RTC 回调调用
+void session_manager_on_join_room_success(void);
+void session_manager_on_user_joined(const char* uid);
+void session_manager_on_user_offline(const char* uid);
+void session_manager_on_token_will_expire(void);
+// 配额用尽，结束当前对话，SESSION_QUOTA_HOLD_MS 内不再开始新的对话
+void session_manager_on_quota_exceeded(const char* message);
+void session_manager_on_connection_lost(void);
+void session_manager_on_audio_data(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __SESSION_MANAGER_H__
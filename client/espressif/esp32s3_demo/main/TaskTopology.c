@@ -0,0 +1,59 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "TaskTopology.h"
+#include <string.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "AudioPipeline.h"
+
+static const char *TAG = "TASK_TOPOLOGY";
+
+// Wi-Fi/lwip 默认在 core 0，AEC 是最重的计算任务，放到 core 1；
+// 编码器和解码器分别跟随上行（core 0）和下行（core 1），避免和 AEC 挤在同一个核上。
+// i2s 任务计算量很小但对时延敏感，使用高优先级。
+static const task_topology_t topology_table[TASK_ID_MAX] = {
+    [TASK_ID_RTC_UPLINK]        = {"byte_rtc_task",  0, 5,  8 * 1024},
+    [TASK_ID_SESSION_CTRL]      = {"session_ctrl",   0, 4,  8 * 1024},
+    [TASK_ID_REC_I2S]           = {"rec_i2s",        0, 23, 3 * 1024},
+    [TASK_ID_REC_AEC]           = {"rec_aec",        1, 21, 5 * 1024},
+    [TASK_ID_REC_TAP]           = {"rec_tap",        0, 16, 6 * 1024},
+    [TASK_ID_REC_RSP]           = {"rec_rsp",        0, 15, 4 * 1024},
+#if defined(RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS)
+    [TASK_ID_REC_ENCODER]       = {"rec_opus_enc",   0, 10, 40 * 1024},
+    [TASK_ID_PLAY_DECODER]      = {"play_opus_dec",  1, 10, 30 * 1024},
+#else
+    [TASK_ID_REC_ENCODER]       = {"rec_enc",        0, 10, 4 * 1024},
+    [TASK_ID_PLAY_DECODER]      = {"play_dec",       1, 10, 4 * 1024},
+#endif
+    [TASK_ID_PLAY_RSP]          = {"play_rsp",       1, 15, 4 * 1024},
+    [TASK_ID_PLAY_I2S]          = {"play_i2s",       1, 23, 3 * 1024},
+    [TASK_ID_STATS]             = {"rtc_stats",      TASK_TOPOLOGY_NO_AFFINITY, 1, 4 * 1024},
+    [TASK_ID_CAPTURE]           = {"audio_capture",  TASK_TOPOLOGY_NO_AFFINITY, 2, 4 * 1024},
+    [TASK_ID_HTTP_WARM]         = {"http_warm",      TASK_TOPOLOGY_NO_AFFINITY, 3, 6 * 1024},
+    [TASK_ID_LINK_POLICY]       = {"link_policy",    0, 6,  3 * 1024},
+};
+
+const task_topology_t* task_topology_get(task_id_e id) {
+    if (id >= TASK_ID_MAX) {
+        id = TASK_ID_RTC_UPLINK;
+    }
+    return &topology_table[id];
+}
+
+BaseType_t task_topology_create(task_id_e id, TaskFunction_t task_func, void* arg, TaskHandle_t* handle) {
+    const task_topology_t* topology = task_topology_get(id);
+    BaseType_t core = topology->core < 0 ? tskNO_AFFINITY : topology->core;
+    BaseType_t ret = xTaskCreatePinnedToCore(task_func, topology->name, topology->stack_size, arg, topology->prio, handle, core);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "create task %s failed", topology->name);
+    }
+    return ret;
+}
+
+void task_topology_dump(void) {
+    for (int i = 0; i < TASK_ID_MAX; i++) {
+        const task_topology_t* topology = &topology_table[i];
+        ESP_LOGI(TAG, "%-16s core %2d prio %2d stack %6d", topology->name, topology->core, topology->prio, topology->stack_size);
+    }
+}
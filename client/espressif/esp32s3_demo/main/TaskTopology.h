@@ -0,0 +1,64 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __TASK_TOPOLOGY_H__
+#define __TASK_TOPOLOGY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TASK_TOPOLOGY_NO_AFFINITY   (-1)   // 仅用于 demo 自己的任务，ADF element 必须指定核
+
+// 所有 pipeline element 和 demo 自己创建的任务，统一在 TaskTopology.c 的表里配置核、优先级和栈大小
+typedef enum {
+    TASK_ID_RTC_UPLINK = 0,    // byte_rtc_task，读取录音 pipeline 并发送音频
+    TASK_ID_SESSION_CTRL,      // SessionManager 控制任务，启动/停止智能体、进退房
+    TASK_ID_REC_I2S,           // 录音 i2s reader
+    TASK_ID_REC_AEC,           // 录音 AEC/AGC 算法
+    TASK_ID_REC_TAP,           // AFE 输出旁路，唤醒词检测
+    TASK_ID_REC_RSP,           // 录音重采样
+    TASK_ID_REC_ENCODER,       // 录音编码器
+    TASK_ID_PLAY_DECODER,      // 播放解码器
+    TASK_ID_PLAY_RSP,          // 播放重采样
+    TASK_ID_PLAY_I2S,          // 播放 i2s writer
+    TASK_ID_STATS,             // RtcStats 周期采样
+    TASK_ID_CAPTURE,           // AudioCapture 写文件
+    TASK_ID_HTTP_WARM,         // 联网后预解析域名、预先建立控制面连接，完成后退出
+    TASK_ID_LINK_POLICY,       // LinkPolicy 切换 Wi-Fi 省电模式，音频回调只通知它
+    TASK_ID_MAX,
+} task_id_e;
+
+typedef struct {
+    const char* name;
+    int core;                  // 0/1 或 TASK_TOPOLOGY_NO_AFFINITY
+    int prio;
+    int stack_size;
+} task_topology_t;
+
+const task_topology_t* task_topology_get(task_id_e id);
+
+// 按表中配置创建 demo 自己的任务
+BaseType_t task_topology_create(task_id_e id, TaskFunction_t task_func, void* arg, TaskHandle_t* handle);
+
+// ADF element 的 cfg 里都有 task_core/task_prio/task_stack 字段，用这个宏统一套用表中的配置
+#define TASK_TOPOLOGY_APPLY(cfg, id)                                            \
+    do {                                                                        \
+        const task_topology_t* __topology = task_topology_get(id);              \
+        (cfg).task_core = __topology->core;                                     \
+        (cfg).task_prio = __topology->prio;                                     \
+        (cfg).task_stack = __topology->stack_size;                              \
+    } while (0)
+
+// 打印当前拓扑；开启 CONFIG_TASK_TOPOLOGY_MEASURE 时由 RtcStats 周期性输出各核负载和各任务占用
+void task_topology_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __TASK_TOPOLOGY_H__
@@ -31,29 +31,30 @@
 #include "board.h"
 #include "esp_peripherals.h"
 #include "periph_wifi.h"
-#include "fatfs_stream.h"
 #include "i2s_stream.h"
 #include "AudioPipeline.h"
 #include "RtcBotUtils.h"
 #include "CozeBotUtils.h"
 #include "cJSON.h"
 #include "network.h"
+#include "MemPlacement.h"
+#include "JsonArena.h"
+#include "BotRequest.h"
+#include "TaskTopology.h"
+#include "RtcStats.h"
+#include "SessionManager.h"
+#include "LinkPolicy.h"
+#include "AudioCapture.h"
 
-#define STATS_TASK_PRIO     5
+#define MESSAGE_BUFFER_SIZE 4096
 
 static const char* TAG = "VolcRTCDemo";
-static bool joined = false;
-static bool finished = false;
-
-typedef struct {
-    player_pipeline_handle_t player_pipeline;
-    rtc_room_info_t* room_info;
-    char remote_uid[128];
-} engine_context_t;
+
 // byte rtc lite callbacks
 static void byte_rtc_on_join_room_success(byte_rtc_engine_t engine, const char* channel, int elapsed_ms, bool rejoin) {
-    ESP_LOGI(TAG, "join channel success %s elapsed %d ms now %d ms\n", channel, elapsed_ms, elapsed_ms);
-    joined = true;
+    ESP_LOGI(TAG, "join channel success %s elapsed %d ms now %d ms rejoin %d\n", channel, elapsed_ms, elapsed_ms, rejoin);
+    // 断网重连后 SDK 会自动重新进房，rejoin 为 true
+    session_manager_on_join_room_success();
 };
 
 static void byte_rtc_on_rejoin_room_success(byte_rtc_engine_t engine, const char* channel, int elapsed_ms){
@@ -65,10 +66,12 @@ static void byte_rtc_on_user_joined(byte_rtc_engine_t engine, const char* channe
     ESP_LOGI(TAG, "remote user joined  %s:%s\n", channel, user_name);
     engine_context_t* context = (engine_context_t *) byte_rtc_get_user_data(engine);
     strcpy(context->remote_uid, user_name);
+    session_manager_on_user_joined(user_name);
 };
 
 static void byte_rtc_on_user_offline(byte_rtc_engine_t engine, const char* channel, const char* user_name, int reason){
     ESP_LOGI(TAG, "remote user offline  %s:%s\n", channel, user_name);
+    session_manager_on_user_offline(user_name);
 };
 
 static void byte_rtc_on_user_mute_audio(byte_rtc_engine_t engine, const char* channel, const char* user_name, int muted){
@@ -85,22 +88,36 @@ static void byte_rtc_on_connection_lost(byte_rtc_engine_t engine, const char* ch
 
 static void byte_rtc_on_room_error(byte_rtc_engine_t engine, const char* channel, int code, const char* msg){
     ESP_LOGE(TAG, "error occur %s %d %s\n", channel, code, msg?msg:"");
+    if (code == ERR_INVALID_TOKEN) {
+        session_manager_on_token_will_expire();
+    } else if (code == ERR_JOIN_ROOM || code == ERR_ROOM_DISMISS) {
+        session_manager_on_connection_lost();
+    }
 };
 
+static void byte_rtc_on_token_privilege_will_expire(byte_rtc_engine_t engine, const char* room){
+    ESP_LOGI(TAG, "token privilege will expire %s\n", room);
+    session_manager_on_token_will_expire();
+};
+
+// 每次拿到 IP（包括断线重连）都重新预热，DNS 结果和连接可能已经失效
+static void on_got_ip(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    voice_bot_warm_up();
+}
+
+static void byte_rtc_on_quota_exceeded(byte_rtc_engine_t engine, const char* message, void* extra) {
+    ESP_LOGE(TAG, "quota exceeded %s\n", message ? message : "");
+    session_manager_on_quota_exceeded(message);
+}
+
 // remote audio
 static void byte_rtc_on_audio_data(byte_rtc_engine_t engine, const char* channel, const char*  uid , uint16_t sent_ts,
                       audio_data_type_e codec, const void* data_ptr, size_t data_len){
     // ESP_LOGI(TAG, "byte_rtc_on_audio_data... len %d\n", data_len);
     engine_context_t* context = (engine_context_t *) byte_rtc_get_user_data(engine);
-#ifdef RTC_DEMO_AUDIO_PIPELINE_CODEC_OPUS
-    static char opus_data_cache[1024]; 
-    opus_data_cache[0] = (data_len >> 8) & 0xFF;
-    opus_data_cache[1] = data_len & 0xFF;
-    memcpy(opus_data_cache + 2, data_ptr, data_len);
-    player_pipeline_write(context->player_pipeline, opus_data_cache, data_len + 2);
-#else
-    player_pipeline_write(context->player_pipeline, data_ptr, data_len);
-#endif
+    session_manager_on_audio_data();
+    audio_capture_write(CAPTURE_STREAM_DOWNLINK, data_ptr, data_len, sent_ts);
+    player_pipeline_write_frame(context->player_pipeline, sent_ts, data_ptr, data_len);
 }
 
 // remote video
@@ -167,7 +184,7 @@ static void on_function_calling_message_received(byte_rtc_engine_t engine, const
 
     engine_context_t* context = (engine_context_t *) byte_rtc_get_user_data(engine);
     
-    // 服务端处理：
+    // 服务端处理：服务端的 tool_executor 按函数名执行注册的工具并传回结果，请求不等待执行完成
     // voice_bot_function_calling(context->room_info, json_str);
 
     // 在客户端处理,通过byte_rtc_rts_send_message接口通知智能体
@@ -258,9 +275,24 @@ void on_message_received(byte_rtc_engine_t engine, const char*  room, const char
     //
     // conversion status 消息，参考https://www.volcengine.com/docs/6348/1415216
     // conv|length(4)|json str
+    //
+    // 调试用的统计查询消息，收到后回复最新的统计快照
+    // stat|length(4)|json str
+
+    if (size >= 4 && _is_target_message(message, "stat")) {
+        rtc_stats_send_to_room(engine, room, uid);
+        return;
+    }
 
-    static char message_buffer[4096];
-    if (size > 8) {
+    // 消息 buffer 较大且访问不频繁，首次使用时从 PSRAM 分配，不占用内部 RAM
+    static char* message_buffer = NULL;
+    if (message_buffer == NULL) {
+        message_buffer = mem_class_malloc(MEM_CLASS_BULK, MESSAGE_BUFFER_SIZE);
+        if (message_buffer == NULL) {
+            return;
+        }
+    }
+    if (size > 8 && size + 2 <= MESSAGE_BUFFER_SIZE) {
         memcpy(message_buffer, message, size);
         message_buffer[size] = 0;
         message_buffer[size + 1] = 0;
@@ -289,125 +321,20 @@ void on_message_received(byte_rtc_engine_t engine, const char*  room, const char
 }
 
 void on_fini_notify(byte_rtc_engine_t engine) {
-    finished = true;
+    ESP_LOGI(TAG, "engine fini notify");
 }
 
 static void on_key_frame_gen_req(byte_rtc_engine_t engine, const char*  channel, const char*  uid) {}
 // byte rtc lite callbacks end.
 
 
-static void byte_rtc_task(void *pvParameters) {
-    rtc_room_info_t* room_info = heap_caps_malloc(sizeof(rtc_room_info_t),  MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    // step 1: start ai agent & get room info
-    int start_ret = start_voice_bot(room_info);
-    if (start_ret != 200) {
-        ESP_LOGE(TAG, "Bot start Failed, ret = %d", start_ret);
-        return;
-    }
-
-    // step 2: start audio capture & play
-    recorder_pipeline_handle_t pipeline = recorder_pipeline_open();
-    player_pipeline_handle_t player_pipeline = player_pipeline_open();
-    recorder_pipeline_run(pipeline);
-    player_pipeline_run(player_pipeline);
-
-    // step 3: start byte rtc engine
-    byte_rtc_event_handler_t handler = {
-        .on_join_room_success       =   byte_rtc_on_join_room_success,
-        .on_room_error              =   byte_rtc_on_room_error,
-        .on_user_joined             =   byte_rtc_on_user_joined,
-        .on_user_offline            =   byte_rtc_on_user_offline,
-        .on_user_mute_audio         =   byte_rtc_on_user_mute_audio,
-        .on_user_mute_video         =   byte_rtc_on_user_mute_video,
-        .on_audio_data              =   byte_rtc_on_audio_data,
-        .on_video_data              =   byte_rtc_on_video_data,
-        .on_key_frame_gen_req       =   on_key_frame_gen_req,
-        .on_message_received        =   on_message_received,
-        .on_fini_notify             =   on_fini_notify,
-    };
-
-    byte_rtc_engine_t engine = byte_rtc_create(room_info->app_id, &handler);
-    byte_rtc_set_log_level(engine, BYTE_RTC_LOG_LEVEL_ERROR);
-    byte_rtc_set_params(engine, "{\"debug\":{\"log_to_console\":1}}");
-#ifdef RTC_DEMO_AUDIO_PIPELINE_CODEC_PCM
-    byte_rtc_set_params(engine,"{\"audio\":{\"codec\":{\"internal\":{\"enable\":1}}}}");
-#endif
-
-    byte_rtc_init(engine);
-#ifdef CONFIG_AUDIO_CODEC_TYPE_OPUS
-    byte_rtc_set_audio_codec(engine, AUDIO_CODEC_TYPE_OPUS);
-#elif defined(CONFIG_AUDIO_CODEC_TYPE_PCM) || defined(CONFIG_AUDIO_CODEC_TYPE_G711A)
-    byte_rtc_set_audio_codec(engine, AUDIO_CODEC_TYPE_G711A);
-#elif defined(CONFIG_AUDIO_CODEC_TYPE_G722)
-    byte_rtc_set_audio_codec(engine, AUDIO_CODEC_TYPE_G722);
-#elif defined(CONFIG_AUDIO_CODEC_TYPE_AAC)
-    byte_rtc_set_audio_codec(engine, AUDIO_CODEC_TYPE_AACLC);
-#endif
-
-    // byte_rtc_set_video_codec(engine, VIDEO_CODEC_TYPE_H264); // 需要视频功能时设置
-
-    engine_context_t engine_context = {
-        .player_pipeline = player_pipeline,
-        .room_info = room_info
-    };
-    byte_rtc_set_user_data(engine, &engine_context);
-
-    // step 4: join room
-    byte_rtc_room_options_t options;
-    options.auto_subscribe_audio = 1; // 接收远端音频
-    options.auto_subscribe_video = 0; // 不接收远端视频
-    options.auto_publish_audio = 1;   // 发送音频
-    options.auto_publish_video = 0;   // 发送视频
-    byte_rtc_join_room(engine, room_info->room_id, room_info->uid, room_info->token, &options);
-
-    const int DEFAULT_READ_SIZE = recorder_pipeline_get_default_read_size(pipeline);
-    uint8_t *audio_buffer = heap_caps_malloc(DEFAULT_READ_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (!audio_buffer) {
-        ESP_LOGE(TAG, "Failed to alloc audio buffer!");
-        return;
-    }
-
-    // step 5: start sending audio data
-    while (true) {
-        int ret =  recorder_pipeline_read(pipeline, (char*) audio_buffer, DEFAULT_READ_SIZE);
-        if (ret == DEFAULT_READ_SIZE && joined) {
-            // push_audio data
-#ifdef RTC_DEMO_AUDIO_PIPELINE_CODEC_PCM
-            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_PCM};
-#elif defined(CONFIG_AUDIO_CODEC_TYPE_G711A)
-            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_PCMA};
-#elif defined(CONFIG_AUDIO_CODEC_TYPE_G722)
-            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_G722};
-#elif defined(CONFIG_AUDIO_CODEC_TYPE_AAC)
-            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_AAC};
-#elif defined(CONFIG_AUDIO_CODEC_TYPE_OPUS)
-            audio_frame_info_t audio_frame_info = {.data_type = AUDIO_DATA_TYPE_OPUS};
-#endif
-            byte_rtc_send_audio_data(engine, room_info->room_id, audio_buffer, DEFAULT_READ_SIZE, &audio_frame_info);
-        }
-    }
-
-    // step 6: leave room and destroy engine
-    byte_rtc_leave_room(engine, room_info->room_id);
-    usleep(1000 * 1000);
-    byte_rtc_fini(engine);
-    while(!finished) {
-        usleep(1000 * 100);
-    }
-    byte_rtc_destroy(engine);
-    
-    // step 7: stop ai agent or it will not stop until 3 minutes
-    stop_voice_bot(room_info);
-    heap_caps_free(room_info);
-
-    // step 8: stop audio capture & play
-    recorder_pipeline_close(pipeline);
-    player_pipeline_close(player_pipeline);
-    ESP_LOGI(TAG, "............. finished\n");
-}
-
 void app_main(void)
 {
+    // cJSON hooks 需要在任何 cJSON 调用之前安装
+    json_arena_install_hooks();
+    // 控制面请求的 arena 和响应 buffer 在任何任务发请求之前分配
+    bot_request_init();
+
     /* Initialize the default event loop */
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
@@ -426,11 +353,16 @@ void app_main(void)
     esp_periph_config_t periph_cfg = DEFAULT_ESP_PERIPH_SET_CONFIG();
     esp_periph_set_handle_t set = esp_periph_set_init(&periph_cfg);
 
+    // 在连接 Wi-Fi 之前注册，第一次拿到 IP 时就开始预热，和下面的音频初始化并行
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, on_got_ip, NULL));
+
    bool connected = configure_network();
    if (connected == false) {
        ESP_LOGE(TAG, "Failed to connect to network");
        return;
    }
+    // Wi-Fi 已启动，按会话阶段切换省电模式
+    link_policy_init();
 
     audio_board_handle_t board_handle = audio_board_init();   
     audio_hal_ctrl_codec(board_handle->audio_hal, AUDIO_HAL_CODEC_MODE_BOTH, AUDIO_HAL_CTRL_START);
@@ -440,6 +372,35 @@ void app_main(void)
     // Allow other core to finish initialization
     vTaskDelay(pdMS_TO_TICKS(2000));
 
-    // Create and start stats task
-    xTaskCreate(&byte_rtc_task, "byte_rtc_task", 8192, NULL, STATS_TASK_PRIO, NULL);
+    // 任务的核、优先级和栈大小统一在 TaskTopology.c 中配置
+    task_topology_dump();
+    rtc_stats_start();
+#if CONFIG_AUDIO_CAPTURE_ENABLE
+    // 每次对话写一个采集文件，用 tools/capture 在主机上分析和重放
+    audio_capture_init(set);
+#endif
+
+    // engine 和 pipeline 由 SessionManager 持有，对话之间只重新进房和启动智能体
+    byte_rtc_event_handler_t handler = {
+        .on_join_room_success       =   byte_rtc_on_join_room_success,
+        .on_room_error              =   byte_rtc_on_room_error,
+        .on_user_joined             =   byte_rtc_on_user_joined,
+        .on_user_offline            =   byte_rtc_on_user_offline,
+        .on_user_mute_audio         =   byte_rtc_on_user_mute_audio,
+        .on_user_mute_video         =   byte_rtc_on_user_mute_video,
+        .on_audio_data              =   byte_rtc_on_audio_data,
+        .on_video_data              =   byte_rtc_on_video_data,
+        .on_key_frame_gen_req       =   on_key_frame_gen_req,
+        .on_message_received        =   on_message_received,
+        .on_fini_notify             =   on_fini_notify,
+        .on_token_privilege_will_expire = byte_rtc_on_token_privilege_will_expire,
+        .on_quota_exceeded          =   byte_rtc_on_quota_exceeded,
+    };
+    session_manager_start(&handler);
+#if CONFIG_WAKE_WORD_ENABLE
+    // 唤醒词触发前不启动智能体，也不上行音频
+    session_manager_standby();
+#else
+    session_manager_begin();
+#endif
 }
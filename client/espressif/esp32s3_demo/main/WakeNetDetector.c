@@ -0,0 +1,80 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "WakeWord.h"
+#include <stdlib.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "WAKENET";
+
+#if CONFIG_WAKE_WORD_DETECTOR_WAKENET
+
+#include "esp_wn_iface.h"
+#include "esp_wn_models.h"
+#include "model_path.h"
+
+typedef struct {
+    const esp_wn_iface_t* wakenet;
+    model_iface_data_t* model;
+} wakenet_detector_t;
+
+static bool wakenet_detect(wake_detector_t* detector, const int16_t* samples) {
+    wakenet_detector_t* wn = detector->priv;
+    return wn->wakenet->detect(wn->model, (int16_t*)samples) == WAKENET_DETECTED;
+}
+
+static void wakenet_reset(wake_detector_t* detector) {
+    wakenet_detector_t* wn = detector->priv;
+    wn->wakenet->clean(wn->model);
+}
+
+static void wakenet_destroy(wake_detector_t* detector) {
+    wakenet_detector_t* wn = detector->priv;
+    wn->wakenet->destroy(wn->model);
+    free(wn);
+    free(detector);
+}
+
+wake_detector_t* wake_detector_wakenet_create(void) {
+    srmodel_list_t* models = esp_srmodel_init("model");
+    char* wn_name = esp_srmodel_filter(models, ESP_WN_PREFIX, NULL);
+    if (wn_name == NULL) {
+        ESP_LOGE(TAG, "no wakenet model in partition \"model\"");
+        return NULL;
+    }
+    const esp_wn_iface_t* wakenet = esp_wn_handle_from_name(wn_name);
+    model_iface_data_t* model = wakenet ? wakenet->create(wn_name, DET_MODE_95) : NULL;
+    if (model == NULL) {
+        ESP_LOGE(TAG, "create wakenet %s failed", wn_name);
+        return NULL;
+    }
+
+    wake_detector_t* detector = calloc(1, sizeof(wake_detector_t));
+    wakenet_detector_t* wn = calloc(1, sizeof(wakenet_detector_t));
+    if (!detector || !wn) {
+        wakenet->destroy(model);
+        free(detector);
+        free(wn);
+        return NULL;
+    }
+    wn->wakenet = wakenet;
+    wn->model = model;
+    detector->name = wn_name;
+    detector->chunk_samples = wakenet->get_samp_chunksize(model);
+    detector->detect = wakenet_detect;
+    detector->reset = wakenet_reset;
+    detector->destroy = wakenet_destroy;
+    detector->priv = wn;
+    ESP_LOGI(TAG, "wakenet %s loaded, chunk %d samples", wn_name, detector->chunk_samples);
+    return detector;
+}
+
+#else
+
+wake_detector_t* wake_detector_wakenet_create(void) {
+    ESP_LOGW(TAG, "wakenet detector not enabled");
+    return NULL;
+}
+
+#endif
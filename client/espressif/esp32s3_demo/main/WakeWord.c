@@ -0,0 +1,281 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 只依赖 libc 和 esp_log，可以在主机上用录音文件驱动 wake_gate_feed 做回归测试
+
+#include "WakeWord.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "WAKE_WORD";
+
+#define WAKE_LABEL_WINDOW_MS        2000    // 标注点之后多长时间内的触发算正确唤醒
+#define WAKE_SPEECH_HANGOVER_MS     300     // 低于阈值持续这么久才认为一段语音结束
+#define WAKE_ENERGY_CHUNK_SAMPLES   480     // 30ms
+
+#define MS_TO_SAMPLES(ms)           ((uint64_t)(ms) * WAKE_WORD_SAMPLE_RATE / 1000)
+#define SAMPLES_TO_MS(samples)      ((uint32_t)((samples) * 1000 / WAKE_WORD_SAMPLE_RATE))
+
+enum {
+    SESSION_REQUEST_NONE = -1,
+    SESSION_REQUEST_END = 0,
+    SESSION_REQUEST_BEGIN = 1,
+};
+
+struct wake_gate_t {
+    wake_detector_t* detector;
+    wake_gate_config_t config;
+    int16_t* chunk;
+    int chunk_fill;
+    uint64_t position;              // 已处理的样本数，作为时钟
+    // 以下两个由其他任务写入，在 feed 中处理，避免和 detector 并发
+    volatile int session_request;
+    volatile bool downlink_seen;
+    volatile bool session;
+    bool woken;                     // 当前会话由唤醒词触发
+    bool user_spoke;                // 唤醒后出现了新的语音
+    uint64_t wake_position;
+    bool speech;
+    uint64_t speech_start;
+    uint64_t last_speech;
+    uint64_t last_activity;
+    bool labeled;                   // 出现过标注后按标注统计误唤醒
+    bool label_pending;
+    uint64_t label_position;
+    wake_stats_t stats;
+};
+
+typedef struct {
+    int threshold;
+    uint64_t hold_samples;
+    uint64_t run_samples;
+} energy_detector_t;
+
+static uint32_t mean_abs(const int16_t* samples, int count) {
+    uint64_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += samples[i] < 0 ? -(int32_t)samples[i] : samples[i];
+    }
+    return count > 0 ? (uint32_t)(sum / count) : 0;
+}
+
+static bool energy_detect(wake_detector_t* detector, const int16_t* samples) {
+    energy_detector_t* energy = detector->priv;
+    if (mean_abs(samples, detector->chunk_samples) > (uint32_t)energy->threshold) {
+        energy->run_samples += detector->chunk_samples;
+    } else {
+        energy->run_samples = 0;
+    }
+    if (energy->run_samples >= energy->hold_samples) {
+        energy->run_samples = 0;
+        return true;
+    }
+    return false;
+}
+
+static void energy_reset(wake_detector_t* detector) {
+    energy_detector_t* energy = detector->priv;
+    energy->run_samples = 0;
+}
+
+static void energy_destroy(wake_detector_t* detector) {
+    free(detector->priv);
+    free(detector);
+}
+
+wake_detector_t* wake_detector_energy_create(int threshold, int hold_ms) {
+    wake_detector_t* detector = calloc(1, sizeof(wake_detector_t));
+    energy_detector_t* energy = calloc(1, sizeof(energy_detector_t));
+    if (!detector || !energy) {
+        free(detector);
+        free(energy);
+        return NULL;
+    }
+    energy->threshold = threshold;
+    energy->hold_samples = MS_TO_SAMPLES(hold_ms);
+    detector->name = "energy";
+    detector->chunk_samples = WAKE_ENERGY_CHUNK_SAMPLES;
+    detector->detect = energy_detect;
+    detector->reset = energy_reset;
+    detector->destroy = energy_destroy;
+    detector->priv = energy;
+    return detector;
+}
+
+wake_gate_t* wake_gate_create(wake_detector_t* detector, const wake_gate_config_t* config) {
+    if (detector == NULL || config == NULL || detector->chunk_samples <= 0) {
+        return NULL;
+    }
+    wake_gate_t* gate = calloc(1, sizeof(wake_gate_t));
+    if (gate == NULL) {
+        return NULL;
+    }
+    gate->chunk = calloc(detector->chunk_samples, sizeof(int16_t));
+    if (gate->chunk == NULL) {
+        free(gate);
+        return NULL;
+    }
+    gate->detector = detector;
+    gate->config = *config;
+    gate->session_request = SESSION_REQUEST_NONE;
+    ESP_LOGI(TAG, "wake gate with %s detector, chunk %d samples", detector->name, detector->chunk_samples);
+    return gate;
+}
+
+void wake_gate_destroy(wake_gate_t* gate) {
+    if (gate == NULL) {
+        return;
+    }
+    gate->detector->destroy(gate->detector);
+    free(gate->chunk);
+    free(gate);
+}
+
+static void wake_gate_record_latency(wake_gate_t* gate, uint64_t samples) {
+    uint32_t latency_ms = SAMPLES_TO_MS(samples);
+    gate->stats.latency_count++;
+    gate->stats.latency_ms_last = latency_ms;
+    gate->stats.latency_ms_sum += latency_ms;
+    if (latency_ms > gate->stats.latency_ms_max) {
+        gate->stats.latency_ms_max = latency_ms;
+    }
+}
+
+static void wake_gate_end_session(wake_gate_t* gate) {
+    // 没有标注时，唤醒后用户一直没说话就算一次误唤醒
+    if (gate->woken && !gate->labeled && !gate->user_spoke) {
+        gate->stats.false_accepts++;
+    }
+    gate->session = false;
+    gate->woken = false;
+    gate->detector->reset(gate->detector);
+}
+
+static void wake_gate_on_detect(wake_gate_t* gate, uint64_t end) {
+    gate->stats.detections++;
+    if (gate->labeled) {
+        if (gate->label_pending && end - gate->label_position <= MS_TO_SAMPLES(WAKE_LABEL_WINDOW_MS)) {
+            gate->label_pending = false;
+            wake_gate_record_latency(gate, end - gate->label_position);
+        } else {
+            gate->stats.false_accepts++;
+        }
+    } else if (gate->speech) {
+        wake_gate_record_latency(gate, end - gate->speech_start);
+    }
+    ESP_LOGI(TAG, "wake word detected at %u ms, latency %u ms, %u detections, %u false accepts",
+             (unsigned)SAMPLES_TO_MS(end), (unsigned)gate->stats.latency_ms_last,
+             (unsigned)gate->stats.detections, (unsigned)gate->stats.false_accepts);
+
+    gate->session = true;
+    gate->woken = true;
+    gate->user_spoke = false;
+    gate->wake_position = end;
+    gate->last_activity = end;
+    gate->detector->reset(gate->detector);
+    if (gate->config.on_wake) {
+        gate->config.on_wake(gate->config.ctx);
+    }
+}
+
+static void wake_gate_process_chunk(wake_gate_t* gate) {
+    int count = gate->detector->chunk_samples;
+    uint64_t end = gate->position + count;
+
+    int request = gate->session_request;
+    if (request != SESSION_REQUEST_NONE) {
+        gate->session_request = SESSION_REQUEST_NONE;
+        if (request == SESSION_REQUEST_BEGIN && !gate->session) {
+            // 不是由唤醒词触发的会话（例如启动时直接开始），不参与误唤醒统计
+            gate->session = true;
+            gate->woken = false;
+            gate->last_activity = gate->position;
+        } else if (request == SESSION_REQUEST_END && gate->session) {
+            wake_gate_end_session(gate);
+        }
+    }
+
+    // 简单的能量 VAD，AFE 已经做过 AEC 和 NS，智能体的声音基本不会触发
+    if (mean_abs(gate->chunk, count) > (uint32_t)gate->config.vad_threshold) {
+        if (!gate->speech) {
+            gate->speech = true;
+            gate->speech_start = gate->position;
+            if (gate->woken && gate->position >= gate->wake_position) {
+                gate->user_spoke = true;
+            }
+        }
+        gate->last_speech = end;
+    } else if (gate->speech && end - gate->last_speech > MS_TO_SAMPLES(WAKE_SPEECH_HANGOVER_MS)) {
+        gate->speech = false;
+    }
+
+    if (!gate->session) {
+        if (gate->detector->detect(gate->detector, gate->chunk)) {
+            wake_gate_on_detect(gate, end);
+        }
+    } else {
+        if (gate->downlink_seen) {
+            gate->downlink_seen = false;
+            gate->last_activity = end;
+        }
+        if (gate->speech) {
+            gate->last_activity = end;
+        }
+        if (end - gate->last_activity > MS_TO_SAMPLES(gate->config.silence_end_ms)) {
+            // 会话结束前可能还会再次超时，每个静音周期只通知一次
+            gate->last_activity = end;
+            gate->stats.silence_ends++;
+            ESP_LOGI(TAG, "silence for %d ms, end session", gate->config.silence_end_ms);
+            if (gate->config.on_silence) {
+                gate->config.on_silence(gate->config.ctx);
+            }
+        }
+    }
+    gate->position = end;
+}
+
+void wake_gate_feed(wake_gate_t* gate, const int16_t* samples, int count) {
+    int chunk_samples = gate->detector->chunk_samples;
+    while (count > 0) {
+        int copy = chunk_samples - gate->chunk_fill;
+        if (copy > count) {
+            copy = count;
+        }
+        memcpy(gate->chunk + gate->chunk_fill, samples, copy * sizeof(int16_t));
+        gate->chunk_fill += copy;
+        samples += copy;
+        count -= copy;
+        if (gate->chunk_fill == chunk_samples) {
+            wake_gate_process_chunk(gate);
+            gate->chunk_fill = 0;
+        }
+    }
+}
+
+void wake_gate_set_session(wake_gate_t* gate, bool active) {
+    gate->session_request = active ? SESSION_REQUEST_BEGIN : SESSION_REQUEST_END;
+}
+
+bool wake_gate_in_session(wake_gate_t* gate) {
+    return gate->session;
+}
+
+void wake_gate_note_downlink(wake_gate_t* gate) {
+    gate->downlink_seen = true;
+}
+
+void wake_gate_mark_keyword_end(wake_gate_t* gate) {
+    gate->labeled = true;
+    if (gate->label_pending) {
+        // 上一个标注没有被检测到
+        ESP_LOGW(TAG, "keyword at %u ms missed", (unsigned)SAMPLES_TO_MS(gate->label_position));
+    }
+    gate->label_pending = true;
+    gate->label_position = gate->position + gate->chunk_fill;
+    gate->stats.labeled_keywords++;
+}
+
+void wake_gate_get_stats(wake_gate_t* gate, wake_stats_t* stats) {
+    *stats = gate->stats;
+}
@@ -0,0 +1,75 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __WAKE_WORD_H__
+#define __WAKE_WORD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WAKE_WORD_SAMPLE_RATE   16000   // AFE 输出，16k 单声道 16bit
+
+// 唤醒词检测器接口，WakeNet 之外的实现（能量触发、主机上的测试桩）都通过它接入
+typedef struct wake_detector_t wake_detector_t;
+struct wake_detector_t {
+    const char* name;
+    int chunk_samples;      // 每次 detect 需要的样本数
+    bool (*detect)(wake_detector_t* detector, const int16_t* samples);
+    void (*reset)(wake_detector_t* detector);
+    void (*destroy)(wake_detector_t* detector);
+    void* priv;
+};
+
+// 声音持续超过 hold_ms 即触发，不依赖模型，用于没有烧录模型的板子和主机测试
+wake_detector_t* wake_detector_energy_create(int threshold, int hold_ms);
+// esp-sr WakeNet，模型从 "model" 分区加载，失败返回 NULL
+wake_detector_t* wake_detector_wakenet_create(void);
+
+typedef struct {
+    uint32_t detections;
+    uint32_t false_accepts;     // 有标注时：不在标注窗口内的触发；无标注时：唤醒后用户没有再说话
+    uint32_t labeled_keywords;  // wake_gate_mark_keyword_end 的次数
+    uint32_t latency_count;
+    uint32_t latency_ms_last;   // 有标注时从唤醒词结束算起，无标注时从语音开始算起
+    uint32_t latency_ms_max;
+    uint64_t latency_ms_sum;
+    uint32_t silence_ends;      // 因静音结束的会话数
+} wake_stats_t;
+
+typedef struct {
+    void (*on_wake)(void* ctx);     // 在 feed 的调用线程中回调，不能阻塞
+    void (*on_silence)(void* ctx);  // 会话中用户和智能体都静音超过 silence_end_ms
+    void* ctx;
+    int vad_threshold;              // 平均幅度超过此值视为有语音
+    int silence_end_ms;
+} wake_gate_config_t;
+
+typedef struct wake_gate_t wake_gate_t;
+
+// gate 持有 detector，destroy 时一起释放
+wake_gate_t* wake_gate_create(wake_detector_t* detector, const wake_gate_config_t* config);
+void wake_gate_destroy(wake_gate_t* gate);
+
+// 喂入任意长度的 AFE 输出，内部按 detector 的 chunk 拼帧；所有时间都按样本数计算，主机上可以重放录音
+void wake_gate_feed(wake_gate_t* gate, const int16_t* samples, int count);
+
+// 会话开始/结束，结束后重新开始检测唤醒词
+void wake_gate_set_session(wake_gate_t* gate, bool active);
+bool wake_gate_in_session(wake_gate_t* gate);
+
+// 收到下行音频，智能体说话期间不算静音
+void wake_gate_note_downlink(wake_gate_t* gate);
+
+// 测试用：标注当前位置是唤醒词结束点，用来统计检测时延和误唤醒；tools/wake/wake_check 按标注文件调用
+void wake_gate_mark_keyword_end(wake_gate_t* gate);
+
+void wake_gate_get_stats(wake_gate_t* gate, wake_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __WAKE_WORD_H__
@@ -189,6 +189,8 @@ void save(char *ssid, char *password)
   // Write the SSID and password to the NVS flash
   ESP_ERROR_CHECK(nvs_set_str(nvs_handle, "ssid", ssid));
   ESP_ERROR_CHECK(nvs_set_str(nvs_handle, "password", password));
+  // 新的 Wi-Fi 配置，清除上一个 AP 的快速连接缓存
+  nvs_erase_key(nvs_handle, "fast_connect");
 
   // Commit the changes
   ESP_ERROR_CHECK(nvs_commit(nvs_handle));
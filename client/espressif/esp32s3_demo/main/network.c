@@ -10,16 +10,146 @@
 #include <esp_log.h>
 #include <nvs.h>
 #include <nvs_flash.h>
+#include <esp_timer.h>
+#include <esp_netif.h>
+#include <sdkconfig.h>
 
 #include "configuration_ap.h"
+#include "Backoff.h"
+#include "LinkPolicy.h"
 
 #define TAG "NETWORK"
 
 #define WIFI_EVENT_CONNECTED BIT0
 #define WIFI_EVENT_FAILED BIT1
 #define MAX_RECONNECT_COUNT 5
+#define RECONNECT_BACKOFF_BASE_MS 500
+#define RECONNECT_BACKOFF_MAX_MS (30 * 1000)
 
 static network_t network;
+// 连上过一次之后断线不再放弃，按退避时间一直重连
+static bool connected_once = false;
+static backoff_t reconnect_backoff;
+static esp_timer_handle_t reconnect_timer = NULL;
+static esp_netif_t *sta_netif = NULL;
+
+// 上次成功连接的 AP 和 IP 信息，保存在 "wifi" 命名空间，下次启动时跳过全信道扫描直接连接
+#define FAST_CONNECT_KEY "fast_connect"
+typedef struct
+{
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint32_t ip;
+  uint32_t netmask;
+  uint32_t gw;
+  uint32_t dns;
+} wifi_fast_connect_t;
+
+static wifi_fast_connect_t fast_connect;
+static bool fast_connect_active = false;
+
+static void reconnect_timer_cb(void *arg)
+{
+  esp_wifi_connect();
+}
+
+static bool fast_connect_load(void)
+{
+#if CONFIG_WIFI_FAST_CONNECT
+  nvs_handle_t nvs_handle;
+  if (nvs_open("wifi", NVS_READONLY, &nvs_handle) != ESP_OK)
+  {
+    return false;
+  }
+  size_t length = sizeof(fast_connect);
+  esp_err_t ret = nvs_get_blob(nvs_handle, FAST_CONNECT_KEY, &fast_connect, &length);
+  nvs_close(nvs_handle);
+  return ret == ESP_OK && length == sizeof(fast_connect) && fast_connect.channel != 0;
+#else
+  return false;
+#endif
+}
+
+static void fast_connect_save(void)
+{
+#if CONFIG_WIFI_FAST_CONNECT
+  wifi_ap_record_t ap_info;
+  esp_netif_ip_info_t ip_info;
+  esp_netif_dns_info_t dns_info;
+  if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK || esp_netif_get_ip_info(sta_netif, &ip_info) != ESP_OK)
+  {
+    return;
+  }
+  wifi_fast_connect_t cache = {0};
+  memcpy(cache.bssid, ap_info.bssid, sizeof(cache.bssid));
+  cache.channel = ap_info.primary;
+  cache.ip = ip_info.ip.addr;
+  cache.netmask = ip_info.netmask.addr;
+  cache.gw = ip_info.gw.addr;
+  if (esp_netif_get_dns_info(sta_netif, ESP_NETIF_DNS_MAIN, &dns_info) == ESP_OK)
+  {
+    cache.dns = dns_info.ip.u_addr.ip4.addr;
+  }
+  // 没有变化时不写 flash
+  if (fast_connect_active && memcmp(&cache, &fast_connect, sizeof(cache)) == 0)
+  {
+    return;
+  }
+  nvs_handle_t nvs_handle;
+  if (nvs_open("wifi", NVS_READWRITE, &nvs_handle) != ESP_OK)
+  {
+    return;
+  }
+  nvs_set_blob(nvs_handle, FAST_CONNECT_KEY, &cache, sizeof(cache));
+  nvs_commit(nvs_handle);
+  nvs_close(nvs_handle);
+  fast_connect = cache;
+  ESP_LOGI(TAG, "Fast connect cache saved, channel %d", cache.channel);
+#endif
+}
+
+static void fast_connect_apply(wifi_config_t *wifi_config)
+{
+  wifi_config->sta.bssid_set = true;
+  memcpy(wifi_config->sta.bssid, fast_connect.bssid, sizeof(fast_connect.bssid));
+  wifi_config->sta.channel = fast_connect.channel;
+#if CONFIG_WIFI_FAST_CONNECT_STATIC_IP
+  // 同一个 AP 下租约通常不变，直接复用可以省掉 DHCP 交互；连接失败时由 fast_connect_disable 恢复 DHCP
+  if (fast_connect.ip != 0)
+  {
+    esp_netif_ip_info_t ip_info = {0};
+    ip_info.ip.addr = fast_connect.ip;
+    ip_info.netmask.addr = fast_connect.netmask;
+    ip_info.gw.addr = fast_connect.gw;
+    esp_netif_dhcpc_stop(sta_netif);
+    esp_netif_set_ip_info(sta_netif, &ip_info);
+    if (fast_connect.dns != 0)
+    {
+      esp_netif_dns_info_t dns_info = {0};
+      dns_info.ip.type = ESP_IPADDR_TYPE_V4;
+      dns_info.ip.u_addr.ip4.addr = fast_connect.dns;
+      esp_netif_set_dns_info(sta_netif, ESP_NETIF_DNS_MAIN, &dns_info);
+    }
+  }
+#endif
+  fast_connect_active = true;
+}
+
+static void fast_connect_disable(void)
+{
+  fast_connect_active = false;
+  network.reconnect_count = 0;
+  wifi_config_t wifi_config;
+  if (esp_wifi_get_config(WIFI_IF_STA, &wifi_config) == ESP_OK)
+  {
+    wifi_config.sta.bssid_set = false;
+    wifi_config.sta.channel = 0;
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+  }
+#if CONFIG_WIFI_FAST_CONNECT_STATIC_IP
+  esp_netif_dhcpc_start(sta_netif);
+#endif
+}
 
 int8_t get_rssi()
 {
@@ -46,7 +176,28 @@ void handler_event_wifi_st(void *arg, esp_event_base_t event_base, int32_t event
   else if (event_id == WIFI_EVENT_STA_DISCONNECTED)
   {
     xEventGroupClearBits(network.event_group, WIFI_EVENT_CONNECTED);
-    if (network.reconnect_count < MAX_RECONNECT_COUNT)
+    if (connected_once)
+    {
+      if (fast_connect_active)
+      {
+        // 只在启动时使用缓存，之后的重连允许漫游到其他 AP
+        fast_connect_disable();
+      }
+      // 事件回调里不能阻塞，用定时器延迟重连
+      uint32_t delay_ms = backoff_next_ms(&reconnect_backoff);
+      network.reconnect_count++;
+      ESP_LOGI(TAG, "WiFi disconnected, reconnecting in %u ms (attempt %d)", (unsigned)delay_ms, network.reconnect_count);
+      esp_timer_stop(reconnect_timer);
+      esp_timer_start_once(reconnect_timer, (uint64_t)delay_ms * 1000);
+    }
+    else if (fast_connect_active)
+    {
+      // 缓存的 AP 连不上（换了路由器或信道），回退到完整扫描和 DHCP
+      ESP_LOGW(TAG, "Fast connect failed, fallback to full scan");
+      fast_connect_disable();
+      esp_wifi_connect();
+    }
+    else if (network.reconnect_count < MAX_RECONNECT_COUNT)
     {
       esp_wifi_connect();
       network.reconnect_count++;
@@ -65,7 +216,11 @@ void handler_event_ip_st(void *arg, esp_event_base_t event_base, int32_t event_i
   ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
 
   esp_ip4addr_ntoa(&event->ip_info.ip, network.ip_address, sizeof(network.ip_address));
-  ESP_LOGI(TAG, "Got IP: %s", network.ip_address);
+  ESP_LOGI(TAG, "Got IP: %s, %d ms since boot%s", network.ip_address, (int)(esp_timer_get_time() / 1000),
+           fast_connect_active ? " (fast connect)" : "");
+  connected_once = true;
+  network.reconnect_count = 0;
+  backoff_reset(&reconnect_backoff);
   xEventGroupSetBits(network.event_group, WIFI_EVENT_CONNECTED);
 }
 
@@ -74,6 +229,15 @@ bool is_connected()
   return xEventGroupGetBits(network.event_group) & WIFI_EVENT_CONNECTED;
 }
 
+bool network_wait_connected(TickType_t timeout)
+{
+  if (network.event_group == NULL)
+  {
+    return false;
+  }
+  return xEventGroupWaitBits(network.event_group, WIFI_EVENT_CONNECTED, pdFALSE, pdTRUE, timeout) & WIFI_EVENT_CONNECTED;
+}
+
 bool configure_network()
 {
 
@@ -83,6 +247,12 @@ bool configure_network()
   network.reconnect_count = 0;
   network.ip_address[0] = '\0';
   network.event_group = xEventGroupCreate();
+  backoff_init(&reconnect_backoff, RECONNECT_BACKOFF_BASE_MS, RECONNECT_BACKOFF_MAX_MS);
+  const esp_timer_create_args_t timer_args = {
+      .callback = reconnect_timer_cb,
+      .name = "wifi_reconnect",
+  };
+  ESP_ERROR_CHECK(esp_timer_create(&timer_args, &reconnect_timer));
 
   // Get ssid and password from NVS
   nvs_handle_t nvs_handle;
@@ -116,7 +286,7 @@ bool configure_network()
                                                         &instance_got_ip));
 
     // Create the default event loop
-    esp_netif_create_default_wifi_sta();
+    sta_netif = esp_netif_create_default_wifi_sta();
 
     // Initialize the WiFi stack in station mode
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
@@ -128,6 +298,13 @@ bool configure_network()
     bzero(&wifi_config, sizeof(wifi_config));
     strcpy((char *)wifi_config.sta.ssid, network.ssid);
     strcpy((char *)wifi_config.sta.password, network.password);
+    // 空闲时 WIFI_PS_MAX_MODEM 按这个间隔唤醒，只能在关联前设置
+    wifi_config.sta.listen_interval = link_policy_listen_interval();
+    if (fast_connect_load())
+    {
+      ESP_LOGI(TAG, "Fast connect to " MACSTR " channel %d", MAC2STR(fast_connect.bssid), fast_connect.channel);
+      fast_connect_apply(&wifi_config);
+    }
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
 
     // Start the WiFi stack
@@ -149,6 +326,7 @@ bool configure_network()
       // return false;
     } else {
         ESP_LOGI(TAG, "Connected to %s rssi=%d channel=%d", network.ssid, get_rssi(), get_channel());
+        fast_connect_save();
     }
   }
 
@@ -11,4 +11,7 @@ typedef struct
   char ip_address[16];
 } network_t;
 
-bool configure_network();
\ No newline at end of file
+bool configure_network();
+bool is_connected();
+// 等待 Wi-Fi 连接并获取到 IP，已连接时立即返回 true
+bool network_wait_connected(TickType_t timeout);
\ No newline at end of file
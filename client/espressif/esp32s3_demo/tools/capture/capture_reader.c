@@ -0,0 +1,46 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "capture_reader.h"
+#include <string.h>
+
+int capture_reader_open(capture_reader_t* reader, const char* path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        return -1;
+    }
+    if (fread(&reader->header, 1, sizeof(reader->header), reader->file) != sizeof(reader->header)
+        || memcmp(reader->header.magic, CAPTURE_MAGIC, sizeof(reader->header.magic)) != 0
+        || reader->header.version != CAPTURE_VERSION) {
+        fclose(reader->file);
+        reader->file = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+bool capture_reader_next(capture_reader_t* reader) {
+    if (fread(&reader->record, 1, sizeof(reader->record), reader->file) != sizeof(reader->record)) {
+        return false;
+    }
+    // 设备异常重启时最后一条记录可能不完整
+    return fread(reader->payload, 1, reader->record.length, reader->file) == reader->record.length;
+}
+
+void capture_reader_close(capture_reader_t* reader) {
+    if (reader->file) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
+
+const char* capture_stream_name(int stream) {
+    static const char* names[CAPTURE_STREAM_MAX] = {"mic", "aec", "uplink", "downlink"};
+    return stream >= 0 && stream < CAPTURE_STREAM_MAX ? names[stream] : "unknown";
+}
+
+const char* capture_codec_name(int codec) {
+    static const char* names[] = {"pcm16", "pcm32", "opus", "g711a", "g722", "aac"};
+    return codec >= 0 && codec < (int)(sizeof(names) / sizeof(names[0])) ? names[codec] : "unknown";
+}
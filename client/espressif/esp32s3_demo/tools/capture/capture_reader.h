@@ -0,0 +1,36 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __CAPTURE_READER_H__
+#define __CAPTURE_READER_H__
+
+#include <stdio.h>
+#include "AudioCapture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 主机端读取 AudioCapture 生成的 .RCP 文件，按记录顺序（即设备上的时间顺序）返回
+typedef struct {
+    FILE* file;
+    capture_file_header_t header;
+    capture_record_header_t record;
+    uint8_t payload[UINT16_MAX];
+} capture_reader_t;
+
+// 成功返回 0，文件头不合法返回 -1
+int capture_reader_open(capture_reader_t* reader, const char* path);
+
+// 读取下一条记录到 reader->record 和 reader->payload，结束或文件截断返回 false
+bool capture_reader_next(capture_reader_t* reader);
+
+void capture_reader_close(capture_reader_t* reader);
+
+const char* capture_stream_name(int stream);
+const char* capture_codec_name(int codec);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __CAPTURE_READER_H__
@@ -0,0 +1,225 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// AudioCapture 文件的主机工具：
+//   info    FILE                       各路流的统计，下行到达间隔和 sent_ts 抖动
+//   dump    FILE                       按时间顺序打印每条记录
+//   extract FILE STREAM OUT            导出一路流，PCM16 写成 wav，opus 按播放器的 2 字节长度前缀拼接
+//   wake    FILE [THRESHOLD HOLD_MS]   用主机编译的 WakeWord.c 重放 AEC 输出和下行时序，复现唤醒和静音结束
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "capture_reader.h"
+#include "WakeWord.h"
+
+typedef struct {
+    uint32_t records;
+    uint64_t bytes;
+    uint64_t first_us;
+    uint64_t last_us;
+    uint64_t max_gap_us;
+} stream_stats_t;
+
+static int find_stream(const char* name) {
+    for (int i = 0; i < CAPTURE_STREAM_MAX; i++) {
+        if (strcmp(name, capture_stream_name(i)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int cmd_info(capture_reader_t* reader) {
+    stream_stats_t stats[CAPTURE_STREAM_MAX] = {0};
+    // RFC 3550 的到达间隔抖动，sent_ts 单位为 ms，16bit 回绕
+    double jitter_ms = 0;
+    uint32_t reorder = 0;
+    bool have_prev = false;
+    uint16_t prev_sent = 0;
+    uint64_t prev_arrival = 0;
+
+    while (capture_reader_next(reader)) {
+        const capture_record_header_t* record = &reader->record;
+        if (record->stream >= CAPTURE_STREAM_MAX) {
+            continue;
+        }
+        stream_stats_t* s = &stats[record->stream];
+        if (s->records == 0) {
+            s->first_us = record->timestamp_us;
+        } else if (record->timestamp_us - s->last_us > s->max_gap_us) {
+            s->max_gap_us = record->timestamp_us - s->last_us;
+        }
+        s->last_us = record->timestamp_us;
+        s->records++;
+        s->bytes += record->length;
+
+        if (record->stream == CAPTURE_STREAM_DOWNLINK) {
+            uint16_t sent = (uint16_t)record->extra;
+            if (have_prev) {
+                int16_t sent_delta = (int16_t)(sent - prev_sent);
+                if (sent_delta < 0) {
+                    reorder++;
+                }
+                double transit = (double)(record->timestamp_us - prev_arrival) / 1000.0 - sent_delta;
+                jitter_ms += ((transit < 0 ? -transit : transit) - jitter_ms) / 16.0;
+            }
+            have_prev = true;
+            prev_sent = sent;
+            prev_arrival = record->timestamp_us;
+        }
+    }
+
+    printf("%-9s %-6s %6s %3s %8s %10s %9s %11s\n", "stream", "codec", "rate", "ch", "records", "bytes", "dur_ms", "max_gap_ms");
+    for (int i = 0; i < CAPTURE_STREAM_MAX; i++) {
+        const capture_stream_format_t* format = &reader->header.formats[i];
+        stream_stats_t* s = &stats[i];
+        printf("%-9s %-6s %6u %3u %8u %10llu %9llu %11.1f\n", capture_stream_name(i), capture_codec_name(format->codec),
+               (unsigned)format->sample_rate, (unsigned)format->channels, (unsigned)s->records, (unsigned long long)s->bytes,
+               (unsigned long long)((s->last_us - s->first_us) / 1000), s->max_gap_us / 1000.0);
+    }
+    printf("downlink jitter %.1f ms, %u out of order\n", jitter_ms, (unsigned)reorder);
+    return 0;
+}
+
+static int cmd_dump(capture_reader_t* reader) {
+    while (capture_reader_next(reader)) {
+        const capture_record_header_t* record = &reader->record;
+        printf("%12.3f %-9s len %5u extra %u\n", record->timestamp_us / 1000.0, capture_stream_name(record->stream),
+               (unsigned)record->length, (unsigned)record->extra);
+    }
+    return 0;
+}
+
+static void write_le(FILE* file, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        fputc((value >> (8 * i)) & 0xFF, file);
+    }
+}
+
+static void write_wav_header(FILE* file, uint32_t sample_rate, uint16_t channels, uint32_t data_bytes) {
+    fwrite("RIFF", 1, 4, file);
+    write_le(file, 36 + data_bytes, 4);
+    fwrite("WAVEfmt ", 1, 8, file);
+    write_le(file, 16, 4);
+    write_le(file, 1, 2);
+    write_le(file, channels, 2);
+    write_le(file, sample_rate, 4);
+    write_le(file, sample_rate * channels * 2, 4);
+    write_le(file, channels * 2, 2);
+    write_le(file, 16, 2);
+    fwrite("data", 1, 4, file);
+    write_le(file, data_bytes, 4);
+}
+
+static int cmd_extract(capture_reader_t* reader, const char* stream_name, const char* out_path) {
+    int stream = find_stream(stream_name);
+    if (stream < 0) {
+        fprintf(stderr, "unknown stream %s\n", stream_name);
+        return 1;
+    }
+    FILE* out = fopen(out_path, "wb");
+    if (out == NULL) {
+        perror(out_path);
+        return 1;
+    }
+    const capture_stream_format_t* format = &reader->header.formats[stream];
+    bool wav = format->codec == CAPTURE_CODEC_PCM16;
+    if (wav) {
+        // 先写占位，结束后回填长度
+        write_wav_header(out, format->sample_rate, format->channels ? format->channels : 1, 0);
+    }
+    uint32_t data_bytes = 0;
+    while (capture_reader_next(reader)) {
+        if (reader->record.stream != stream) {
+            continue;
+        }
+        if (format->codec == CAPTURE_CODEC_OPUS) {
+            fputc(reader->record.length >> 8, out);
+            fputc(reader->record.length & 0xFF, out);
+        }
+        fwrite(reader->payload, 1, reader->record.length, out);
+        data_bytes += reader->record.length;
+    }
+    if (wav) {
+        fseek(out, 0, SEEK_SET);
+        write_wav_header(out, format->sample_rate, format->channels ? format->channels : 1, data_bytes);
+    }
+    fclose(out);
+    printf("%s: %u bytes of %s written to %s\n", stream_name, (unsigned)data_bytes, capture_codec_name(format->codec), out_path);
+    return 0;
+}
+
+static uint64_t replay_now_us;
+
+static void replay_on_wake(void* ctx) {
+    printf("%12.3f wake\n", replay_now_us / 1000.0);
+}
+
+static void replay_on_silence(void* ctx) {
+    printf("%12.3f silence end\n", replay_now_us / 1000.0);
+}
+
+static int cmd_wake(capture_reader_t* reader, int threshold, int hold_ms) {
+    if (reader->header.formats[CAPTURE_STREAM_AEC].codec != CAPTURE_CODEC_PCM16) {
+        fprintf(stderr, "aec stream is not pcm16\n");
+        return 1;
+    }
+    wake_gate_config_t config = {
+        .on_wake = replay_on_wake,
+        .on_silence = replay_on_silence,
+        .vad_threshold = 600,
+        .silence_end_ms = 20000,
+    };
+    wake_gate_t* gate = wake_gate_create(wake_detector_energy_create(threshold, hold_ms), &config);
+    if (gate == NULL) {
+        return 1;
+    }
+    // 按设备上的记录顺序交错送入 AEC 输出和下行事件，和设备上的时序一致
+    while (capture_reader_next(reader)) {
+        replay_now_us = reader->record.timestamp_us;
+        if (reader->record.stream == CAPTURE_STREAM_AEC) {
+            wake_gate_feed(gate, (const int16_t*)reader->payload, reader->record.length / sizeof(int16_t));
+        } else if (reader->record.stream == CAPTURE_STREAM_DOWNLINK) {
+            wake_gate_note_downlink(gate);
+        }
+    }
+    wake_stats_t stats;
+    wake_gate_get_stats(gate, &stats);
+    printf("%u detections, %u false accepts, %u silence ends, latency max %u ms\n", (unsigned)stats.detections,
+           (unsigned)stats.false_accepts, (unsigned)stats.silence_ends, (unsigned)stats.latency_ms_max);
+    wake_gate_destroy(gate);
+    return 0;
+}
+
+static int usage(void) {
+    fprintf(stderr, "usage: capture_tool info|dump FILE\n"
+                    "       capture_tool extract FILE mic|aec|uplink|downlink OUT\n"
+                    "       capture_tool wake FILE [THRESHOLD HOLD_MS]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        return usage();
+    }
+    static capture_reader_t reader;
+    if (capture_reader_open(&reader, argv[2]) != 0) {
+        fprintf(stderr, "%s is not a capture file\n", argv[2]);
+        return 1;
+    }
+    int ret;
+    if (strcmp(argv[1], "info") == 0) {
+        ret = cmd_info(&reader);
+    } else if (strcmp(argv[1], "dump") == 0) {
+        ret = cmd_dump(&reader);
+    } else if (strcmp(argv[1], "extract") == 0 && argc == 5) {
+        ret = cmd_extract(&reader, argv[3], argv[4]);
+    } else if (strcmp(argv[1], "wake") == 0) {
+        ret = cmd_wake(&reader, argc > 3 ? atoi(argv[3]) : 1500, argc > 4 ? atoi(argv[4]) : 600);
+    } else {
+        ret = usage();
+    }
+    capture_reader_close(&reader);
+    return ret;
+}
@@ -0,0 +1,176 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 主机上检查控制面请求不产生堆分配：用 main/ 下的 BotRequest.c、JsonArena.c、MemPlacement.c 和 ESP-IDF 的 cJSON，
+// 按 startvoicechat 的请求体和响应重复请求，统计 bot_request_init 之后的 heap_caps 分配次数，不为 0 时返回失败。
+// rtc_http_post 由这里替代，把固定的响应写入调用方的响应 buffer。
+//   control_check [REQUESTS]
+//
+// 编译（cJSON 使用 ESP-IDF 中的源码）：
+//   cd client/espressif/esp32s3_demo/tools/control
+//   gcc -Ihost -I../capture/host -I../../main -I$IDF_PATH/components/json/cJSON \
+//       control_check.c ../../main/BotRequest.c ../../main/JsonArena.c ../../main/MemPlacement.c \
+//       $IDF_PATH/components/json/cJSON/cJSON.c -o control_check
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "freertos/task.h"
+#include "BotRequest.h"
+#include "JsonArena.h"
+#include "MemPlacement.h"
+
+#define POST_DATA_SIZE      1024
+
+static const char* START_RESPONSE =
+    "{\"code\":200,\"msg\":\"\",\"data\":{\"room_id\":\"OPUSLOWbf410694b3a34a3aa980b6e85613200d\","
+    "\"uid\":\"userbf410694b3a34a3aa980b6e85613200d\",\"app_id\":\"0123456789abcdef01234567\","
+    "\"token\":\"001012345678********************************************************************************"
+    "****************************************************************************************************==\","
+    "\"task_id\":\"bf410694b3a34a3aa980b6e85613200d\",\"bot_uid\":\"botbf410694b3a34a3aa980b6e85613200d\"}}";
+static const char* ERROR_RESPONSE = "{\"code\":429,\"message\":\"too many voice chat starts, retry later.\",\"retry_after\":3}";
+
+TaskHandle_t host_current_task = (TaskHandle_t)1;
+static int heap_allocs = 0;
+static int heap_frees = 0;
+static const char* next_response = NULL;
+static int next_code = 200;
+static int missing_response_buffer = 0;
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    heap_allocs++;
+    return malloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    heap_allocs++;
+    return calloc(n, size);
+}
+
+void heap_caps_free(void* ptr) {
+    heap_frees++;
+    free(ptr);
+}
+
+size_t heap_caps_get_allocated_size(void* ptr) {
+    return 0;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    return 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    return 0;
+}
+
+rtc_req_result_t rtc_http_post(rtc_post_config_t* config) {
+    rtc_req_result_t result = {0};
+    if (config->response_buffer == NULL) {
+        missing_response_buffer++;
+        result.code = -1;
+        return result;
+    }
+    int len = (int)strlen(next_response);
+    if (len > config->response_buffer_size) {
+        len = config->response_buffer_size;
+    }
+    memcpy(config->response_buffer, next_response, len);
+    result.code = next_code;
+    result.response = config->response_buffer;
+    result.response_len = len;
+    return result;
+}
+
+void rtc_request_free(rtc_req_result_t* result) {
+    if (result->response_owned) {
+        free(result->response);
+    }
+    result->response = NULL;
+}
+
+// 和 RtcBotUtils 的 startvoicechat 相同的请求体和响应处理
+static int start_request(char* room_id, size_t room_id_size) {
+    char post_data[POST_DATA_SIZE];
+    if (!bot_request_begin()) {
+        return -1;
+    }
+    cJSON* body = cJSON_CreateObject();
+    cJSON_AddStringToObject(body, "audio_codec", "OPUS");
+    cJSON_AddStringToObject(body, "room_identifier", "OPUSLOW");
+    cJSON_AddBoolToObject(body, "enable_burst", false);
+    cJSON_AddNumberToObject(body, "burst_buffer_size", 500);
+    cJSON_AddNumberToObject(body, "burst_interval", 20);
+    cJSON_AddStringToObject(body, "device_id", "7CDFA1E2F3A4");
+    int ret = -1;
+    if (bot_request_print_json(body, post_data, sizeof(post_data))) {
+        const char* headers[] = {"Content-Type", "application/json", NULL};
+        rtc_req_result_t result = bot_request_post("http://127.0.0.1/startvoicechat", headers, post_data, 0);
+        cJSON* data = NULL;
+        bool parsed = bot_request_parse_json(result.response, result.response_len, result.code, &data);
+        if (parsed) {
+            const char* value = cJSON_GetStringValue(cJSON_GetObjectItem(data, "room_id"));
+            snprintf(room_id, room_id_size, "%s", value ? value : "");
+        }
+        rtc_request_free(&result);
+        ret = result.code != 200 ? result.code : (parsed ? 200 : -1);
+    }
+    bot_request_end();
+    return ret;
+}
+
+int main(int argc, char** argv) {
+    int requests = argc > 1 ? atoi(argv[1]) : 1000;
+    int failures = 0;
+    char room_id[129];
+
+    json_arena_install_hooks();
+    if (bot_request_begin()) {
+        fprintf(stderr, "FAIL: bot_request_begin succeeded before bot_request_init\n");
+        failures++;
+    }
+    if (!bot_request_init()) {
+        fprintf(stderr, "FAIL: bot_request_init\n");
+        return 1;
+    }
+    int init_allocs = heap_allocs;
+
+    next_response = START_RESPONSE;
+    next_code = 200;
+    for (int i = 0; i < requests; i++) {
+        room_id[0] = 0;
+        if (start_request(room_id, sizeof(room_id)) != 200 || strcmp(room_id, "OPUSLOWbf410694b3a34a3aa980b6e85613200d") != 0) {
+            failures++;
+        }
+    }
+    next_response = ERROR_RESPONSE;
+    next_code = 429;
+    for (int i = 0; i < requests; i++) {
+        if (start_request(room_id, sizeof(room_id)) != 429) {
+            failures++;
+        }
+    }
+    int request_allocs = heap_allocs - init_allocs;
+
+    // arena 活动期间其它任务的 cJSON 调用仍然走堆，不占用 arena
+    bot_request_begin();
+    host_current_task = (TaskHandle_t)2;
+    cJSON* other = cJSON_CreateObject();
+    cJSON_Delete(other);
+    host_current_task = (TaskHandle_t)1;
+    bot_request_end();
+    int other_allocs = heap_allocs - init_allocs - request_allocs;
+
+    mem_class_stats_t stats;
+    mem_class_get_stats(MEM_CLASS_CONTROL, &stats);
+    printf("%d requests: %d failures, %d heap allocations after init (%d at init), control class alloc %u free %u\n",
+           requests * 2, failures, request_allocs, init_allocs, (unsigned)stats.alloc_count, (unsigned)stats.free_count);
+    printf("other task during request: %d heap allocations, %d frees\n", other_allocs, heap_frees);
+    if (failures > 0 || request_allocs != 0 || missing_response_buffer != 0 || other_allocs != 1 || heap_frees != 1) {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,19 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 主机编译 JsonArena.c、MemPlacement.c、BotRequest.c 时替代 FreeRTOS，单线程运行，锁都是空操作
+#pragma once
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef int portMUX_TYPE;
+
+#define pdTRUE                          1
+#define pdFALSE                         0
+#define portMAX_DELAY                   0xffffffffu
+#define portMUX_INITIALIZER_UNLOCKED    0
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
@@ -0,0 +1,12 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+// 当前任务由 control_check 设置，用来模拟其它任务在 arena 活动期间调用 cJSON
+extern TaskHandle_t host_current_task;
+
+static inline TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return host_current_task;
+}
@@ -0,0 +1,5 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 主机编译时不开启 PSRAM 和 TLV，控制面请求按 json 编码，和默认配置相同
+#pragma once
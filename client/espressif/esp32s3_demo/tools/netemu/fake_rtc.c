@@ -0,0 +1,225 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "fake_rtc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    byte_rtc_event_handler_t handler;
+    void* user_data;
+    char room[128];
+    bool joined;
+    netemu_config_t uplink_config;
+    netemu_config_t downlink_config;
+    netemu_t* uplink;
+    netemu_t* downlink;
+    uint64_t now_us;
+    fake_rtc_uplink_cb_t uplink_cb;
+    void* uplink_ctx;
+} fake_rtc_t;
+
+// 包的 tag：低 16bit 为 sent_ts，高 16bit 为编码类型
+#define PACKET_TAG(ts, codec) (((uint32_t)(codec) << 16) | ((ts) & 0xFFFF))
+
+static const netemu_config_t lossless = {0};
+
+const char* byte_rtc_get_version(void) {
+    return "fake-" BYTE_RTC_API_VERSION;
+}
+
+const char* byte_rtc_err_2_str(int err) {
+    return err == 0 ? "ok" : "fake error";
+}
+
+void byte_rtc_set_log_level(byte_rtc_engine_t engine, int level) {
+}
+
+int byte_rtc_config_log(byte_rtc_engine_t engine, const char* log_path, int size_per_file, int max_file_count) {
+    return 0;
+}
+
+byte_rtc_engine_t byte_rtc_create(const char* app_id, const byte_rtc_event_handler_t* event_handler) {
+    fake_rtc_t* rtc = calloc(1, sizeof(fake_rtc_t));
+    if (rtc == NULL) {
+        return NULL;
+    }
+    if (event_handler) {
+        rtc->handler = *event_handler;
+    }
+    rtc->uplink_config = lossless;
+    rtc->downlink_config = lossless;
+    return rtc;
+}
+
+int byte_rtc_init(byte_rtc_engine_t engine) {
+    return engine ? 0 : -1;
+}
+
+int byte_rtc_fini(byte_rtc_engine_t engine) {
+    fake_rtc_t* rtc = engine;
+    if (rtc && rtc->handler.on_fini_notify) {
+        rtc->handler.on_fini_notify(engine);
+    }
+    return 0;
+}
+
+void byte_rtc_destroy(byte_rtc_engine_t engine) {
+    fake_rtc_t* rtc = engine;
+    if (rtc == NULL) {
+        return;
+    }
+    netemu_destroy(rtc->uplink);
+    netemu_destroy(rtc->downlink);
+    free(rtc);
+}
+
+void byte_rtc_set_user_data(byte_rtc_engine_t engine, void* user_data) {
+    ((fake_rtc_t*)engine)->user_data = user_data;
+}
+
+void* byte_rtc_get_user_data(byte_rtc_engine_t engine) {
+    return ((fake_rtc_t*)engine)->user_data;
+}
+
+int byte_rtc_set_audio_codec(byte_rtc_engine_t engine, audio_codec_type_e audio_codec_type) {
+    return 0;
+}
+
+int byte_rtc_set_video_codec(byte_rtc_engine_t engine, video_codec_type_e video_codec_type) {
+    return 0;
+}
+
+int byte_rtc_set_params(byte_rtc_engine_t engine, const char* params) {
+    return 0;
+}
+
+int byte_rtc_join_room(byte_rtc_engine_t engine, const char* room, const char* uid, const char* token,
+                       byte_rtc_room_options_t* options) {
+    fake_rtc_t* rtc = engine;
+    if (rtc == NULL || room == NULL) {
+        return -2;
+    }
+    snprintf(rtc->room, sizeof(rtc->room), "%s", room);
+    netemu_destroy(rtc->uplink);
+    netemu_destroy(rtc->downlink);
+    rtc->uplink = netemu_create(&rtc->uplink_config);
+    rtc->downlink = netemu_create(&rtc->downlink_config);
+    rtc->joined = true;
+    // 进房和智能体进房都立即回调，时延只体现在音频上
+    if (rtc->handler.on_join_room_success) {
+        rtc->handler.on_join_room_success(engine, rtc->room, 0, false);
+    }
+    if (rtc->handler.on_user_joined) {
+        rtc->handler.on_user_joined(engine, rtc->room, FAKE_RTC_BOT_UID, 0);
+    }
+    return 0;
+}
+
+int byte_rtc_leave_room(byte_rtc_engine_t engine, const char* room) {
+    fake_rtc_t* rtc = engine;
+    if (rtc == NULL) {
+        return -2;
+    }
+    rtc->joined = false;
+    return 0;
+}
+
+int byte_rtc_renew_token(byte_rtc_engine_t engine, const char* room, const char* token) {
+    return 0;
+}
+
+int byte_rtc_mute(byte_rtc_engine_t engine, const char* room, const char* uid, bool video, bool mute) {
+    return 0;
+}
+
+int64_t byte_rtc_rts_send_message(byte_rtc_engine_t engine, const char* room, const char* target, const void* data_ptr,
+                                  size_t data_len, bool binary, rts_message_type type) {
+    return 0;
+}
+
+int byte_rtc_send_audio_data(byte_rtc_engine_t engine, const char* room, const void* data_ptr, size_t data_len,
+                             audio_frame_info_t* info_ptr) {
+    fake_rtc_t* rtc = engine;
+    if (rtc == NULL || data_ptr == NULL || info_ptr == NULL) {
+        return -2;
+    }
+    if (!rtc->joined) {
+        return -1;
+    }
+    netemu_send(rtc->uplink, rtc->now_us, data_ptr, data_len, PACKET_TAG(rtc->now_us / 1000, info_ptr->data_type));
+    return 0;
+}
+
+void fake_rtc_set_network(byte_rtc_engine_t engine, const netemu_config_t* uplink, const netemu_config_t* downlink) {
+    fake_rtc_t* rtc = engine;
+    rtc->uplink_config = uplink ? *uplink : lossless;
+    rtc->downlink_config = downlink ? *downlink : lossless;
+}
+
+void fake_rtc_set_uplink_callback(byte_rtc_engine_t engine, fake_rtc_uplink_cb_t cb, void* ctx) {
+    fake_rtc_t* rtc = engine;
+    rtc->uplink_cb = cb;
+    rtc->uplink_ctx = ctx;
+}
+
+void fake_rtc_inject_downlink(byte_rtc_engine_t engine, const void* data, size_t length, audio_data_type_e codec) {
+    fake_rtc_t* rtc = engine;
+    if (!rtc->joined) {
+        return;
+    }
+    netemu_send(rtc->downlink, rtc->now_us, data, length, PACKET_TAG(rtc->now_us / 1000, codec));
+}
+
+void fake_rtc_advance(byte_rtc_engine_t engine, uint64_t now_us) {
+    fake_rtc_t* rtc = engine;
+    if (!rtc->joined) {
+        rtc->now_us = now_us;
+        return;
+    }
+    // 两条链路按到达时间交错处理，回调中看到的 fake_rtc_now_us 就是包的到达时间
+    while (true) {
+        uint64_t up_us = netemu_next_deliver_us(rtc->uplink);
+        uint64_t down_us = netemu_next_deliver_us(rtc->downlink);
+        uint64_t next_us = up_us < down_us ? up_us : down_us;
+        if (next_us > now_us) {
+            break;
+        }
+        if (next_us > rtc->now_us) {
+            rtc->now_us = next_us;
+        }
+        netemu_packet_t packet;
+        if (up_us <= down_us) {
+            netemu_receive(rtc->uplink, next_us, &packet);
+            if (rtc->uplink_cb) {
+                rtc->uplink_cb(rtc->uplink_ctx, &packet);
+            }
+        } else {
+            netemu_receive(rtc->downlink, next_us, &packet);
+            if (rtc->handler.on_audio_data) {
+                rtc->handler.on_audio_data(engine, rtc->room, FAKE_RTC_BOT_UID, packet.tag & 0xFFFF,
+                                           (audio_data_type_e)(packet.tag >> 16), packet.data, packet.length);
+            }
+        }
+        if (!rtc->joined) {
+            break;
+        }
+    }
+    rtc->now_us = now_us;
+}
+
+uint64_t fake_rtc_now_us(byte_rtc_engine_t engine) {
+    return ((fake_rtc_t*)engine)->now_us;
+}
+
+void fake_rtc_get_stats(byte_rtc_engine_t engine, fake_rtc_stats_t* stats) {
+    fake_rtc_t* rtc = engine;
+    memset(stats, 0, sizeof(*stats));
+    if (rtc->uplink) {
+        netemu_get_stats(rtc->uplink, &stats->uplink);
+    }
+    if (rtc->downlink) {
+        netemu_get_stats(rtc->downlink, &stats->downlink);
+    }
+}
@@ -0,0 +1,43 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __FAKE_RTC_H__
+#define __FAKE_RTC_H__
+
+#include "VolcEngineRTCLite.h"
+#include "netemu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 主机上替代 VolcEngineRTCLite 的最小实现：上行 byte_rtc_send_audio_data 和下行 on_audio_data
+// 分别经过一条 netemu 链路，时间由 fake_rtc_advance 推进，不依赖主机时钟
+#define FAKE_RTC_BOT_UID    "bot"
+
+typedef struct {
+    netemu_stats_t uplink;
+    netemu_stats_t downlink;
+} fake_rtc_stats_t;
+
+// 在 join_room 之前调用，NULL 表示无损链路
+void fake_rtc_set_network(byte_rtc_engine_t engine, const netemu_config_t* uplink, const netemu_config_t* downlink);
+
+// 模拟智能体在当前时间发送一帧下行音频，sent_ts 为当前毫秒数的低 16bit
+void fake_rtc_inject_downlink(byte_rtc_engine_t engine, const void* data, size_t length, audio_data_type_e codec);
+
+// 推进虚拟时钟到 now_us，按到达时间依次投递上行到服务端、下行到 on_audio_data
+void fake_rtc_advance(byte_rtc_engine_t engine, uint64_t now_us);
+
+uint64_t fake_rtc_now_us(byte_rtc_engine_t engine);
+
+// 服务端收到上行包的回调，可以为 NULL
+typedef void (*fake_rtc_uplink_cb_t)(void* ctx, const netemu_packet_t* packet);
+void fake_rtc_set_uplink_callback(byte_rtc_engine_t engine, fake_rtc_uplink_cb_t cb, void* ctx);
+
+void fake_rtc_get_stats(byte_rtc_engine_t engine, fake_rtc_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __FAKE_RTC_H__
@@ -0,0 +1,238 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#include "netemu.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t deliver_us;
+    uint64_t seq;               // 到达时间相同时按发送顺序
+    uint64_t send_us;
+    uint32_t tag;
+    size_t length;
+    uint8_t* data;
+} netemu_entry_t;
+
+struct netemu_t {
+    netemu_config_t config;
+    uint64_t rng;
+    bool bad_state;
+    uint64_t link_free_us;      // 瓶颈链路空闲的时间
+    uint64_t last_deliver_us;   // 抖动不乱序：到达时间不早于上一个包
+    uint64_t max_delivered_send_seq;
+    uint64_t seq;               // 发送序号
+    netemu_entry_t* heap;
+    size_t heap_size;
+    size_t heap_capacity;
+    uint8_t* received;          // 最近一次 receive 返回的数据
+    netemu_stats_t stats;
+};
+
+static const struct {
+    const char* name;
+    netemu_config_t config;
+} presets[] = {
+    {"good",      {.delay_ms = 20, .jitter_ms = 5}},
+    // 家用 Wi-Fi：偶发的几十毫秒抖动和零星丢包
+    {"wifi",      {.p_good_to_bad = 0.01, .p_bad_to_good = 0.5, .loss_bad = 0.3, .delay_ms = 30, .jitter_ms = 40,
+                   .reorder_prob = 0.005, .reorder_ms = 30, .duplicate_prob = 0.002}},
+    // 突发丢包：进入 bad 状态后平均持续 5 个包，期间丢一半
+    {"bursty",    {.p_good_to_bad = 0.02, .p_bad_to_good = 0.2, .loss_good = 0.005, .loss_bad = 0.5, .delay_ms = 50,
+                   .jitter_ms = 60, .reorder_prob = 0.01, .reorder_ms = 40, .duplicate_prob = 0.005}},
+    // 瓶颈带宽低于音频码率时的排队和尾丢弃
+    {"congested", {.delay_ms = 40, .jitter_ms = 20, .bandwidth_kbps = 24, .queue_ms = 300}},
+};
+
+bool netemu_preset(const char* name, netemu_config_t* config) {
+    for (size_t i = 0; i < sizeof(presets) / sizeof(presets[0]); i++) {
+        if (strcmp(presets[i].name, name) == 0) {
+            uint32_t seed = config->seed;
+            *config = presets[i].config;
+            config->seed = seed;
+            return true;
+        }
+    }
+    return false;
+}
+
+// splitmix64，不依赖 libc 的 rand，保证不同平台结果一致
+static uint64_t netemu_rand(netemu_t* emu) {
+    uint64_t z = (emu->rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double netemu_uniform(netemu_t* emu) {
+    return (netemu_rand(emu) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static bool entry_before(const netemu_entry_t* a, const netemu_entry_t* b) {
+    return a->deliver_us < b->deliver_us || (a->deliver_us == b->deliver_us && a->seq < b->seq);
+}
+
+static bool heap_push(netemu_t* emu, const netemu_entry_t* entry) {
+    if (emu->heap_size == emu->heap_capacity) {
+        size_t capacity = emu->heap_capacity ? emu->heap_capacity * 2 : 64;
+        netemu_entry_t* heap = realloc(emu->heap, capacity * sizeof(netemu_entry_t));
+        if (heap == NULL) {
+            return false;
+        }
+        emu->heap = heap;
+        emu->heap_capacity = capacity;
+    }
+    size_t i = emu->heap_size++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!entry_before(entry, &emu->heap[parent])) {
+            break;
+        }
+        emu->heap[i] = emu->heap[parent];
+        i = parent;
+    }
+    emu->heap[i] = *entry;
+    return true;
+}
+
+static netemu_entry_t heap_pop(netemu_t* emu) {
+    netemu_entry_t top = emu->heap[0];
+    netemu_entry_t last = emu->heap[--emu->heap_size];
+    size_t i = 0;
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= emu->heap_size) {
+            break;
+        }
+        if (child + 1 < emu->heap_size && entry_before(&emu->heap[child + 1], &emu->heap[child])) {
+            child++;
+        }
+        if (!entry_before(&emu->heap[child], &last)) {
+            break;
+        }
+        emu->heap[i] = emu->heap[child];
+        i = child;
+    }
+    if (emu->heap_size > 0) {
+        emu->heap[i] = last;
+    }
+    return top;
+}
+
+netemu_t* netemu_create(const netemu_config_t* config) {
+    netemu_t* emu = calloc(1, sizeof(netemu_t));
+    if (emu == NULL) {
+        return NULL;
+    }
+    emu->config = *config;
+    emu->rng = config->seed;
+    return emu;
+}
+
+void netemu_destroy(netemu_t* emu) {
+    if (emu == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < emu->heap_size; i++) {
+        free(emu->heap[i].data);
+    }
+    free(emu->heap);
+    free(emu->received);
+    free(emu);
+}
+
+static void netemu_enqueue(netemu_t* emu, uint64_t seq, uint64_t send_us, uint64_t deliver_us, const void* data, size_t length, uint32_t tag) {
+    netemu_entry_t entry = {
+        .deliver_us = deliver_us,
+        .seq = seq,
+        .send_us = send_us,
+        .tag = tag,
+        .length = length,
+        .data = malloc(length ? length : 1),
+    };
+    if (entry.data == NULL) {
+        return;
+    }
+    memcpy(entry.data, data, length);
+    if (!heap_push(emu, &entry)) {
+        free(entry.data);
+    }
+}
+
+void netemu_send(netemu_t* emu, uint64_t now_us, const void* data, size_t length, uint32_t tag) {
+    const netemu_config_t* config = &emu->config;
+    emu->stats.sent++;
+
+    // 随机数的使用顺序固定，任何参数为 0 时也照常消耗，保证改一个参数不会打乱其他损伤的序列
+    double r_state = netemu_uniform(emu);
+    double r_loss = netemu_uniform(emu);
+    double r_jitter = netemu_uniform(emu);
+    double r_reorder = netemu_uniform(emu);
+    double r_duplicate = netemu_uniform(emu);
+
+    emu->bad_state = emu->bad_state ? (r_state >= config->p_bad_to_good) : (r_state < config->p_good_to_bad);
+    if (r_loss < (emu->bad_state ? config->loss_bad : config->loss_good)) {
+        emu->stats.lost_random++;
+        return;
+    }
+
+    uint64_t depart_us = now_us;
+    if (config->bandwidth_kbps > 0) {
+        uint64_t start_us = emu->link_free_us > now_us ? emu->link_free_us : now_us;
+        if (start_us - now_us > (uint64_t)config->queue_ms * 1000) {
+            emu->stats.lost_queue++;
+            return;
+        }
+        // kbps 即每毫秒 bit 数
+        emu->link_free_us = start_us + (uint64_t)length * 8 * 1000 / config->bandwidth_kbps;
+        depart_us = emu->link_free_us;
+    }
+
+    uint64_t deliver_us = depart_us + (uint64_t)config->delay_ms * 1000 + (uint64_t)(r_jitter * config->jitter_ms * 1000);
+    if (deliver_us < emu->last_deliver_us) {
+        deliver_us = emu->last_deliver_us;
+    }
+    emu->last_deliver_us = deliver_us;
+    if (r_reorder < config->reorder_prob) {
+        // 不更新 last_deliver_us，后面的包可以先到
+        deliver_us += (uint64_t)config->reorder_ms * 1000;
+    }
+    // 重复包使用相同的 seq，不计入乱序
+    uint64_t seq = emu->seq++;
+    netemu_enqueue(emu, seq, now_us, deliver_us, data, length, tag);
+    if (r_duplicate < config->duplicate_prob) {
+        emu->stats.duplicated++;
+        netemu_enqueue(emu, seq, now_us, deliver_us + 1000, data, length, tag);
+    }
+}
+
+bool netemu_receive(netemu_t* emu, uint64_t now_us, netemu_packet_t* packet) {
+    if (emu->heap_size == 0 || emu->heap[0].deliver_us > now_us) {
+        return false;
+    }
+    netemu_entry_t entry = heap_pop(emu);
+    free(emu->received);
+    emu->received = entry.data;
+    emu->stats.delivered++;
+    // seq 代表发送顺序，比已经交付的包更早发送就是乱序（重复包不算）
+    if (entry.seq + 1 < emu->max_delivered_send_seq) {
+        emu->stats.reordered++;
+    }
+    if (entry.seq + 1 > emu->max_delivered_send_seq) {
+        emu->max_delivered_send_seq = entry.seq + 1;
+    }
+    packet->send_us = entry.send_us;
+    packet->deliver_us = entry.deliver_us;
+    packet->tag = entry.tag;
+    packet->length = entry.length;
+    packet->data = entry.data;
+    return true;
+}
+
+uint64_t netemu_next_deliver_us(netemu_t* emu) {
+    return emu->heap_size ? emu->heap[0].deliver_us : UINT64_MAX;
+}
+
+void netemu_get_stats(netemu_t* emu, netemu_stats_t* stats) {
+    *stats = emu->stats;
+}
@@ -0,0 +1,70 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+#ifndef __NETEMU_H__
+#define __NETEMU_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 单向链路损伤模拟，只在主机上使用。时间全部由调用者传入，同样的 seed 和输入得到完全相同的结果
+typedef struct {
+    uint32_t seed;
+    // Gilbert-Elliott 两状态丢包：每个包先按转移概率切换 good/bad，再按所在状态的丢包率丢弃
+    double p_good_to_bad;
+    double p_bad_to_good;
+    double loss_good;
+    double loss_bad;
+    uint32_t delay_ms;          // 固定单向时延
+    uint32_t jitter_ms;         // [0, jitter_ms] 均匀分布的附加时延，不会造成乱序
+    double reorder_prob;        // 以该概率再额外延迟 reorder_ms，越过后面的包造成乱序
+    uint32_t reorder_ms;
+    double duplicate_prob;
+    uint32_t bandwidth_kbps;    // 瓶颈带宽，0 表示不限
+    uint32_t queue_ms;          // 瓶颈队列最长排队时间，超过后尾丢弃
+} netemu_config_t;
+
+typedef struct {
+    uint64_t sent;
+    uint64_t delivered;         // 包含重复包
+    uint64_t lost_random;       // Gilbert-Elliott 丢包
+    uint64_t lost_queue;        // 带宽受限时队列溢出
+    uint64_t duplicated;
+    uint64_t reordered;
+} netemu_stats_t;
+
+typedef struct {
+    uint64_t send_us;
+    uint64_t deliver_us;
+    uint32_t tag;               // 调用者自定义，例如 sent_ts
+    size_t length;
+    uint8_t* data;              // 由 netemu 持有，下一次 netemu_receive 前有效
+} netemu_packet_t;
+
+typedef struct netemu_t netemu_t;
+
+// 预置的网络场景：good、wifi、bursty、congested，未知名称返回 false
+bool netemu_preset(const char* name, netemu_config_t* config);
+
+netemu_t* netemu_create(const netemu_config_t* config);
+void netemu_destroy(netemu_t* emu);
+
+void netemu_send(netemu_t* emu, uint64_t now_us, const void* data, size_t length, uint32_t tag);
+
+// 取出 deliver_us <= now_us 的下一个包，按到达时间排序
+bool netemu_receive(netemu_t* emu, uint64_t now_us, netemu_packet_t* packet);
+
+// 下一个包的到达时间，没有包时返回 UINT64_MAX
+uint64_t netemu_next_deliver_us(netemu_t* emu);
+
+void netemu_get_stats(netemu_t* emu, netemu_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __NETEMU_H__
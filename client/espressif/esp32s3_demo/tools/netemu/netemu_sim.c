@@ -0,0 +1,836 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 用 fake_rtc + netemu 模拟一次通话，上下行各发送一路 20ms 音频帧，下行按固定深度的 jitter buffer 播放，
+// 输出迟到帧、需要隐藏（PLC）的帧和附加时延分位数。全部使用虚拟时钟，同样的参数每次结果相同。
+//   netemu_sim [--preset NAME] [--seed N] [--seconds N] [--buffer-ms N] [--frame-ms N] [--frame-bytes N]
+//              [--loss P] [--burst P_GB P_BG LOSS_BAD] [--delay MS] [--jitter MS] [--reorder P MS]
+//              [--duplicate P] [--kbps N] [--capture FILE] [--plc] [--hold-ms N] [--playout] [--drift-ppm N]
+// --plc 时下行改为 16k PCM 的合成语音，按播放时刻把准时的帧送入 main/AudioPlc.c，和缺帧补零对比误差
+// 下行同时按到达顺序送入 main/ReorderWindow.c（等待时间 --hold-ms），输出重排前后的乱序帧数和附加等待
+// --playout 时同样使用合成语音，按设备上的顺序（乱序窗口、AudioPlc、播放缓冲）模拟播放，播放时钟比发送端
+// 快 --drift-ppm，对比固定预缓冲 --buffer-ms 和 main/AudioPlayout.c 的自适应播放
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fake_rtc.h"
+#include "capture_reader.h"
+#include "AudioPlc.h"
+#include "ReorderWindow.h"
+#include "AudioPlayout.h"
+
+#define DRAIN_US        (5 * 1000 * 1000)
+#define PLC_SAMPLE_RATE 16000
+#define REORDER_DEPTH   4
+#define PLAYOUT_LOW_WATER_MS    5
+
+typedef struct {
+    uint64_t send_us;
+    uint64_t arrival_us;        // 第一次到达的时间，未到达为 UINT64_MAX
+    uint16_t length;
+    uint8_t* data;              // capture 重放时的原始帧
+} sim_frame_t;
+
+typedef struct {
+    sim_frame_t* frames;
+    size_t count;
+    size_t capacity;
+    uint64_t duplicates;
+    uint64_t unknown;
+    uint64_t last_ms;           // 用于 sent_ts 回绕展开
+} sim_stream_t;
+
+typedef struct {
+    reorder_window_t* window;
+    uint64_t arrived;
+    uint64_t arrived_out_of_order;
+    uint64_t released_out_of_order;
+    bool has_arrived;
+    bool has_released;
+    uint16_t last_arrived;
+    uint16_t last_released;
+} sim_reorder_t;
+
+typedef struct {
+    uint16_t sent_ts;
+    uint64_t arrival_us;
+} sim_arrival_t;
+
+typedef struct {
+    byte_rtc_engine_t engine;
+    sim_stream_t uplink;
+    sim_stream_t downlink;
+    sim_reorder_t reorder;
+    sim_arrival_t* arrivals;    // 下行到达顺序，包括重复包
+    size_t arrival_count;
+    size_t arrival_capacity;
+} sim_t;
+
+static sim_frame_t* stream_add(sim_stream_t* stream, uint64_t send_us) {
+    if (stream->count == stream->capacity) {
+        stream->capacity = stream->capacity ? stream->capacity * 2 : 1024;
+        stream->frames = realloc(stream->frames, stream->capacity * sizeof(sim_frame_t));
+        if (stream->frames == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    sim_frame_t* frame = &stream->frames[stream->count++];
+    memset(frame, 0, sizeof(*frame));
+    frame->send_us = send_us;
+    frame->arrival_us = UINT64_MAX;
+    return frame;
+}
+
+// sent_ts 是发送时刻毫秒数的低 16bit，按离上一次最近的方向展开后找到对应的帧
+static void stream_arrive(sim_stream_t* stream, uint16_t sent_ts, uint64_t now_us) {
+    int16_t delta = (int16_t)(sent_ts - (uint16_t)stream->last_ms);
+    uint64_t ms = stream->last_ms + delta;
+    if (delta > 0) {
+        stream->last_ms = ms;
+    }
+    size_t lo = 0;
+    size_t hi = stream->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (stream->frames[mid].send_us / 1000 < ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    // 同一毫秒发出的多帧按顺序认领
+    for (; lo < stream->count && stream->frames[lo].send_us / 1000 == ms; lo++) {
+        if (stream->frames[lo].arrival_us == UINT64_MAX) {
+            stream->frames[lo].arrival_us = now_us;
+            return;
+        }
+    }
+    if (lo > 0 && stream->frames[lo - 1].send_us / 1000 == ms) {
+        stream->duplicates++;
+    } else {
+        stream->unknown++;
+    }
+}
+
+static void on_audio_data(byte_rtc_engine_t engine, const char* room, const char* uid, uint16_t sent_ts,
+                          audio_data_type_e codec, const void* data, size_t len) {
+    sim_t* sim = byte_rtc_get_user_data(engine);
+    uint64_t now_us = fake_rtc_now_us(engine);
+    stream_arrive(&sim->downlink, sent_ts, now_us);
+
+    // 设备上等待超时由解码任务的读超时触发，这里在下一个包到达之前先按超时时间放行
+    sim_reorder_t* reorder = &sim->reorder;
+    uint32_t now_ms = (uint32_t)(now_us / 1000);
+    uint32_t deadline_ms;
+    while (reorder_window_next_deadline(reorder->window, &deadline_ms) && (int32_t)(deadline_ms - now_ms) < 0) {
+        reorder_window_poll(reorder->window, deadline_ms);
+    }
+    reorder->arrived++;
+    if (reorder->has_arrived && (int16_t)(sent_ts - reorder->last_arrived) < 0) {
+        reorder->arrived_out_of_order++;
+    } else {
+        reorder->last_arrived = sent_ts;
+    }
+    reorder->has_arrived = true;
+    reorder_window_push(reorder->window, sent_ts, now_ms, data, len);
+
+    if (sim->arrival_count == sim->arrival_capacity) {
+        sim->arrival_capacity = sim->arrival_capacity ? sim->arrival_capacity * 2 : 1024;
+        sim->arrivals = realloc(sim->arrivals, sim->arrival_capacity * sizeof(sim_arrival_t));
+        if (sim->arrivals == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    sim->arrivals[sim->arrival_count++] = (sim_arrival_t){.sent_ts = sent_ts, .arrival_us = now_us};
+}
+
+static void on_reorder_release(uint16_t sent_ts, const uint8_t* data, size_t length, void* ctx) {
+    sim_reorder_t* reorder = ctx;
+    if (reorder->has_released && (int16_t)(sent_ts - reorder->last_released) <= 0) {
+        reorder->released_out_of_order++;
+    }
+    reorder->has_released = true;
+    reorder->last_released = sent_ts;
+}
+
+static void on_uplink(void* ctx, const netemu_packet_t* packet) {
+    sim_t* sim = ctx;
+    stream_arrive(&sim->uplink, packet->tag & 0xFFFF, packet->deliver_us);
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile_ms(const uint64_t* sorted, size_t count, double p) {
+    if (count == 0) {
+        return 0;
+    }
+    size_t index = (size_t)(p * count + 0.999999);
+    index = index ? index - 1 : 0;
+    return sorted[index < count ? index : count - 1] / 1000.0;
+}
+
+// 附加时延为到达时间减发送时间，只统计到达的帧
+static void report_latency(const char* name, const sim_stream_t* stream) {
+    uint64_t* latency = malloc((stream->count + 1) * sizeof(uint64_t));
+    size_t count = 0;
+    for (size_t i = 0; i < stream->count; i++) {
+        if (stream->frames[i].arrival_us != UINT64_MAX) {
+            latency[count++] = stream->frames[i].arrival_us - stream->frames[i].send_us;
+        }
+    }
+    qsort(latency, count, sizeof(uint64_t), compare_u64);
+    printf("%-9s %7.1f %7.1f %7.1f %7.1f %7.1f\n", name, percentile_ms(latency, count, 0.50),
+           percentile_ms(latency, count, 0.90), percentile_ms(latency, count, 0.95), percentile_ms(latency, count, 0.99),
+           count ? latency[count - 1] / 1000.0 : 0);
+    free(latency);
+}
+
+// 固定深度 jitter buffer：第一帧到达后再等 buffer_ms 开始播放，之后每帧的播放时刻 = 发送时刻 + 固定偏移。
+// 播放时刻还没到达的帧需要隐藏，其中之后才到的计为迟到
+static void report_playout(const sim_stream_t* stream, uint32_t buffer_ms) {
+    const sim_frame_t* first = NULL;
+    for (size_t i = 0; i < stream->count; i++) {
+        const sim_frame_t* frame = &stream->frames[i];
+        if (frame->arrival_us != UINT64_MAX && (first == NULL || frame->arrival_us < first->arrival_us)) {
+            first = frame;
+        }
+    }
+    if (first == NULL) {
+        printf("downlink playout: nothing arrived\n");
+        return;
+    }
+    uint64_t offset_us = first->arrival_us - first->send_us + (uint64_t)buffer_ms * 1000;
+    uint64_t late = 0;
+    uint64_t concealed = 0;
+    uint64_t longest_gap = 0;
+    uint64_t gap = 0;
+    for (size_t i = 0; i < stream->count; i++) {
+        const sim_frame_t* frame = &stream->frames[i];
+        uint64_t deadline_us = frame->send_us + offset_us;
+        if (frame->arrival_us <= deadline_us) {
+            gap = 0;
+            continue;
+        }
+        concealed++;
+        if (frame->arrival_us != UINT64_MAX) {
+            late++;
+        }
+        if (++gap > longest_gap) {
+            longest_gap = gap;
+        }
+    }
+    double total = stream->count ? stream->count / 100.0 : 1;
+    printf("downlink playout: buffer %u ms, mouth-to-ear %.1f ms, late %llu (%.2f%%), concealed %llu (%.2f%%), "
+           "longest concealment %llu frames\n",
+           (unsigned)buffer_ms, offset_us / 1000.0, (unsigned long long)late, late / total,
+           (unsigned long long)concealed, concealed / total, (unsigned long long)longest_gap);
+}
+
+static void report_link(const char* name, const netemu_stats_t* stats, const sim_stream_t* stream) {
+    printf("%-9s %8llu %9llu %10llu %10llu %6llu %8llu\n", name, (unsigned long long)stats->sent,
+           (unsigned long long)stats->delivered, (unsigned long long)stats->lost_random,
+           (unsigned long long)stats->lost_queue, (unsigned long long)stream->duplicates,
+           (unsigned long long)stats->reordered);
+}
+
+static void report_reorder(sim_reorder_t* reorder, uint32_t hold_ms) {
+    reorder_window_stats_t stats;
+    reorder_window_get_stats(reorder->window, &stats);
+    printf("reorder window %u ms / %d frames: %llu arrived, %llu out of order before, %llu after; "
+           "%u reordered (max depth %u), %u late, %u duplicates, %u gaps (%u frames)\n",
+           (unsigned)hold_ms, REORDER_DEPTH, (unsigned long long)reorder->arrived,
+           (unsigned long long)reorder->arrived_out_of_order, (unsigned long long)reorder->released_out_of_order,
+           (unsigned)stats.reordered, (unsigned)stats.max_depth, (unsigned)stats.late, (unsigned)stats.duplicates,
+           (unsigned)stats.gaps, (unsigned)stats.skipped_frames);
+    printf("reorder hold: %u of %u frames waited, avg %.1f ms, max %u ms, %.2f ms per released frame\n",
+           (unsigned)stats.held_frames, (unsigned)stats.released,
+           stats.held_frames ? (double)stats.hold_ms_sum / stats.held_frames : 0.0, (unsigned)stats.hold_ms_max,
+           stats.released ? (double)stats.hold_ms_sum / stats.released : 0.0);
+}
+
+// 浊音为主的合成语音：基音在 110~170Hz 之间缓慢变化，4Hz 音节包络，每 3 秒停顿 600ms
+static int16_t* synth_speech(size_t samples) {
+    int16_t* pcm = malloc(samples * sizeof(int16_t));
+    double phase = 0;
+    for (size_t n = 0; n < samples; n++) {
+        double t = (double)n / PLC_SAMPLE_RATE;
+        double f0 = 140 + 30 * sin(2 * M_PI * 0.7 * t);
+        phase += 2 * M_PI * f0 / PLC_SAMPLE_RATE;
+        double value = 0;
+        for (int k = 1; k * f0 < 4000; k++) {
+            // 500Hz 和 1500Hz 附近的两个共振峰
+            double f = k * f0;
+            double formant = 1.0 / (1 + pow((f - 500) / 200, 2)) + 0.5 / (1 + pow((f - 1500) / 300, 2));
+            value += formant * sin(k * phase) / k;
+        }
+        double envelope = 0.6 + 0.4 * sin(2 * M_PI * 4 * t);
+        if (fmod(t, 3.0) > 2.4) {
+            envelope = 0;
+        }
+        pcm[n] = (int16_t)(6000 * envelope * value);
+    }
+    return pcm;
+}
+
+static double snr_db(double signal, double noise) {
+    if (noise <= 0) {
+        return 99.0;
+    }
+    return signal > 0 ? 10 * log10(signal / noise) : 0;
+}
+
+typedef struct {
+    int16_t* out;
+    size_t position;
+    size_t capacity;
+} plc_sink_t;
+
+static void plc_sink_output(const int16_t* pcm, int samples, void* ctx) {
+    plc_sink_t* sink = ctx;
+    for (int i = 0; i < samples && sink->position < sink->capacity; i++) {
+        sink->out[sink->position++] = pcm[i];
+    }
+}
+
+// 按播放时刻决定每帧是否可用：准时到达的送入 AudioPlc，缺的帧由它根据 sent_ts 的间隔补出来；
+// 对照组直接补零。只统计需要隐藏的帧和紧随其后的一帧（交叉淡化）上的误差
+static void report_plc(const sim_stream_t* stream, const int16_t* reference, int frame_samples, uint32_t buffer_ms) {
+    const sim_frame_t* first = NULL;
+    for (size_t i = 0; i < stream->count; i++) {
+        if (stream->frames[i].arrival_us != UINT64_MAX &&
+            (first == NULL || stream->frames[i].arrival_us < first->arrival_us)) {
+            first = &stream->frames[i];
+        }
+    }
+    if (first == NULL) {
+        return;
+    }
+    uint64_t offset_us = first->arrival_us - first->send_us + (uint64_t)buffer_ms * 1000;
+    size_t total = stream->count * frame_samples;
+    plc_sink_t sink = {.out = calloc(total, sizeof(int16_t)), .capacity = total};
+    int16_t* zero_fill = calloc(total, sizeof(int16_t));
+    bool* missing = calloc(stream->count, sizeof(bool));
+
+    audio_plc_config_t config = {
+        .frame_ms = frame_samples * 1000 / PLC_SAMPLE_RATE,
+        .max_gap_ms = 120,
+        .output = plc_sink_output,
+        .ctx = &sink,
+    };
+    audio_plc_t* plc = audio_plc_create(audio_plc_codec_pcm_create(PLC_SAMPLE_RATE), &config);
+    long last = -1;
+    for (long i = 0; i < (long)stream->count; i++) {
+        const sim_frame_t* frame = &stream->frames[i];
+        const int16_t* pcm = reference + i * frame_samples;
+        if (frame->arrival_us > frame->send_us + offset_us) {
+            missing[i] = true;
+            continue;
+        }
+        // 和 AudioPlc 相同的规则：第一帧之前或间隔超过 max_gap_ms 时不做隐藏，输出位置直接对齐到这一帧，两种方式都补零
+        if (last < 0 || (i - last) * config.frame_ms > config.max_gap_ms) {
+            sink.position = i * frame_samples;
+        }
+        last = i;
+        audio_plc_push(plc, (uint16_t)(frame->send_us / 1000), (const uint8_t*)pcm, frame_samples * sizeof(int16_t));
+        memcpy(zero_fill + i * frame_samples, pcm, frame_samples * sizeof(int16_t));
+    }
+    audio_plc_stats_t stats;
+    audio_plc_get_stats(plc, &stats);
+    audio_plc_destroy(plc);
+
+    double signal = 0, plc_noise = 0, zero_noise = 0;
+    double all_signal = 0, all_plc_noise = 0, all_zero_noise = 0;
+    for (size_t i = 0; i < stream->count; i++) {
+        bool region = missing[i] || (i > 0 && missing[i - 1]);
+        for (int k = 0; k < frame_samples; k++) {
+            size_t n = i * frame_samples + k;
+            double ref = reference[n];
+            double e_plc = ref - sink.out[n];
+            double e_zero = ref - zero_fill[n];
+            all_signal += ref * ref;
+            all_plc_noise += e_plc * e_plc;
+            all_zero_noise += e_zero * e_zero;
+            if (region) {
+                signal += ref * ref;
+                plc_noise += e_plc * e_plc;
+                zero_noise += e_zero * e_zero;
+            }
+        }
+    }
+    printf("plc: %u concealed, %u resyncs; snr on concealed frames zero fill %.1f dB, plc %.1f dB; "
+           "overall zero fill %.1f dB, plc %.1f dB\n",
+           (unsigned)stats.concealed, (unsigned)stats.resyncs, snr_db(signal, zero_noise), snr_db(signal, plc_noise),
+           snr_db(all_signal, all_zero_noise), snr_db(all_signal, all_plc_noise));
+    free(sink.out);
+    free(zero_fill);
+    free(missing);
+}
+
+// 播放模拟：到达的包按设备上的顺序经过乱序窗口和 AudioPlc，输出进入播放缓冲，播放端按自己的时钟匀速取数，
+// 缓冲空了就是欠载（播放静音，之后的数据整体推迟）。固定方式在第一帧之后预缓冲 buffer_ms 再开始播放，
+// 自适应方式由 AudioPlayout 按估计的抖动补静音和伸缩，缓冲将空时提前隐藏。时延统计每一帧播放结束的时刻减去
+// 它发送结束的时刻
+typedef struct {
+    bool adaptive;
+    double drift;               // 设备时钟相对发送端的比例，1 + ppm / 1e6
+    double samples_per_us;      // 播放端每微秒取走的样本数
+    const int16_t* reference;
+    int frame_samples;
+    uint32_t frame_ms;
+    size_t frame_count;
+    uint32_t prebuffer_ms;
+    reorder_window_t* window;
+    audio_plc_t* plc;
+    audio_playout_t* playout;
+    double now_us;
+    double fill;                // 缓冲中的样本数
+    bool started;
+    bool ended;
+    bool in_underrun;
+    bool conceal_blocked;       // 提前隐藏已经达到 max_gap_ms，等下一帧
+    uint64_t underruns;
+    double underrun_us;
+    uint64_t last_ms;           // sent_ts 展开
+    double* latency;
+    size_t latency_count;
+    double depth_sum;           // 每帧写入前的缓冲深度
+} player_sim_t;
+
+static uint32_t player_device_ms(const player_sim_t* player, double real_us) {
+    return (uint32_t)(uint64_t)(real_us * player->drift / 1000);
+}
+
+static double player_real_us(const player_sim_t* player, uint32_t device_ms) {
+    return device_ms * 1000.0 / player->drift;
+}
+
+static void player_advance(player_sim_t* player, double to_us) {
+    if (to_us <= player->now_us) {
+        return;
+    }
+    double need = (to_us - player->now_us) * player->samples_per_us;
+    player->now_us = to_us;
+    if (!player->started) {
+        return;
+    }
+    if (player->fill >= need) {
+        player->fill -= need;
+        return;
+    }
+    if (!player->ended) {
+        player->underrun_us += (need - player->fill) / player->samples_per_us;
+        if (!player->in_underrun) {
+            player->underruns++;
+        }
+        player->in_underrun = true;
+    }
+    player->fill = 0;
+}
+
+static double player_depth_ms(const player_sim_t* player) {
+    return player->fill / player->samples_per_us / 1000 * player->drift;
+}
+
+static void player_enqueue(const int16_t* pcm, int samples, void* ctx) {
+    player_sim_t* player = ctx;
+    player->fill += samples;
+    player->in_underrun = false;
+    if (!player->started && (player->adaptive || player_depth_ms(player) >= player->prebuffer_ms)) {
+        player->started = true;
+    }
+}
+
+static void player_decoded(const int16_t* pcm, int samples, void* ctx) {
+    player_sim_t* player = ctx;
+    if (player->adaptive) {
+        audio_playout_push(player->playout, pcm, samples, (int)player_depth_ms(player),
+                           player_device_ms(player, player->now_us));
+    } else {
+        player_enqueue(pcm, samples, player);
+    }
+}
+
+static void player_release(uint16_t sent_ts, const uint8_t* data, size_t length, void* ctx) {
+    player_sim_t* player = ctx;
+    int16_t delta = (int16_t)(sent_ts - (uint16_t)player->last_ms);
+    player->last_ms += delta;
+    size_t index = player->last_ms / player->frame_ms;
+    if (index >= player->frame_count) {
+        return;
+    }
+    player->depth_sum += player_depth_ms(player);
+    audio_plc_push(player->plc, sent_ts, (const uint8_t*)(player->reference + index * player->frame_samples),
+                   player->frame_samples * sizeof(int16_t));
+    player->conceal_blocked = false;
+    if (player->started) {
+        double end_us = player->now_us + player->fill / player->samples_per_us;
+        double sent_end_us = (double)(player->last_ms + player->frame_ms) * 1000;
+        player->latency[player->latency_count++] = (end_us - sent_end_us) / 1000;
+    }
+}
+
+// 运行到 until_us：乱序窗口的等待超时，以及自适应方式下缓冲低于 PLAYOUT_LOW_WATER_MS 时不再等乱序的帧，
+// 窗口中没有帧时提前隐藏
+static void player_run_until(player_sim_t* player, double until_us) {
+    for (;;) {
+        uint32_t deadline_ms;
+        double deadline_us = INFINITY;
+        if (reorder_window_next_deadline(player->window, &deadline_ms)) {
+            deadline_us = player_real_us(player, deadline_ms);
+        }
+        double low_us = INFINITY;
+        if (player->adaptive && player->started && !player->ended && !player->conceal_blocked) {
+            low_us = player->now_us + player->fill / player->samples_per_us - PLAYOUT_LOW_WATER_MS * 1000.0;
+            if (low_us < player->now_us) {
+                low_us = player->now_us;
+            }
+        }
+        if (deadline_us >= until_us && low_us >= until_us) {
+            break;
+        }
+        if (deadline_us <= low_us) {
+            player_advance(player, deadline_us);
+            reorder_window_poll(player->window, deadline_ms);
+        } else {
+            player_advance(player, low_us);
+            uint32_t deadline_ms;
+            if (reorder_window_next_deadline(player->window, &deadline_ms)) {
+                reorder_window_flush(player->window);
+            } else {
+                player->conceal_blocked = !audio_plc_conceal_next(player->plc);
+            }
+        }
+    }
+    player_advance(player, until_us);
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void run_player(const sim_t* sim, player_sim_t* player, uint32_t hold_ms) {
+    reorder_window_config_t reorder_config = {
+        .frame_ms = player->frame_ms,
+        .max_hold_ms = hold_ms,
+        .max_depth = REORDER_DEPTH,
+        .max_gap_ms = 120,
+        .adapt_ms = 10000,
+        .max_frame_bytes = 0,
+        .release = player_release,
+        .ctx = player,
+    };
+    audio_plc_config_t plc_config = {
+        .frame_ms = player->frame_ms,
+        .max_gap_ms = 120,
+        .output = player_decoded,
+        .ctx = player,
+    };
+    audio_playout_config_t playout_config = {
+        .sample_rate = PLC_SAMPLE_RATE,
+        .min_delay_ms = 20,
+        .max_delay_ms = 200,
+        .max_gap_ms = 120,
+        .output = player_enqueue,
+        .ctx = player,
+    };
+    player->window = reorder_window_create(&reorder_config);
+    player->plc = audio_plc_create(audio_plc_codec_pcm_create(PLC_SAMPLE_RATE), &plc_config);
+    player->playout = player->adaptive ? audio_playout_create(&playout_config) : NULL;
+    player->latency = calloc(player->frame_count + 1, sizeof(double));
+
+    // 模拟中不需要帧数据，乱序窗口只传 sent_ts，数据在放行时按 sent_ts 取
+    for (size_t i = 0; i < sim->arrival_count; i++) {
+        const sim_arrival_t* arrival = &sim->arrivals[i];
+        player_run_until(player, arrival->arrival_us);
+        uint32_t device_ms = player_device_ms(player, arrival->arrival_us);
+        if (player->adaptive) {
+            audio_playout_on_arrival(player->playout, arrival->sent_ts, device_ms);
+        }
+        reorder_window_push(player->window, arrival->sent_ts, device_ms, (const uint8_t*)"", 0);
+    }
+    player->ended = true;
+    player_run_until(player, INFINITY);
+}
+
+static void report_player(player_sim_t* player) {
+    size_t count = player->latency_count;
+    qsort(player->latency, count, sizeof(double), compare_double);
+    // 最后 10s 的平均时延反映时钟漂移的累积
+    size_t tail = 10000 / player->frame_ms;
+    double tail_sum = 0;
+    size_t tail_count = 0;
+    for (size_t i = 0; i < count && tail_count < tail; i++, tail_count++) {
+        tail_sum += player->latency[count - 1 - i];
+    }
+    printf("%-8s %7.1f %7.1f %7.1f %7.1f %9llu %10.0f %9.1f\n", player->adaptive ? "adaptive" : "fixed",
+           count ? player->latency[count / 2] : 0, count ? player->latency[(size_t)(count * 0.95)] : 0,
+           count ? player->latency[count - 1] : 0, player->latency_count ? player->depth_sum / count : 0,
+           (unsigned long long)player->underruns, player->underrun_us / 1000, tail_count ? tail_sum / tail_count : 0);
+}
+
+static void report_playout_adaptive(const sim_t* sim, const int16_t* reference, int frame_samples, uint32_t frame_ms,
+                                    size_t frame_count, uint32_t buffer_ms, double drift_ppm, uint32_t hold_ms) {
+    player_sim_t players[2];
+    for (int i = 0; i < 2; i++) {
+        player_sim_t* player = &players[i];
+        memset(player, 0, sizeof(*player));
+        player->adaptive = i == 1;
+        player->drift = 1 + drift_ppm / 1e6;
+        player->samples_per_us = PLC_SAMPLE_RATE * player->drift / 1e6;
+        player->reference = reference;
+        player->frame_samples = frame_samples;
+        player->frame_ms = frame_ms;
+        player->frame_count = frame_count;
+        player->prebuffer_ms = buffer_ms;
+        run_player(sim, player, hold_ms);
+    }
+    printf("playout drift %+.0f ppm, fixed prebuffer %u ms\n", drift_ppm, (unsigned)buffer_ms);
+    printf("%-8s %7s %7s %7s %7s %9s %10s %9s\n", "player", "p50", "p95", "max", "depth", "underruns",
+           "silence_ms", "last10s");
+    for (int i = 0; i < 2; i++) {
+        report_player(&players[i]);
+    }
+    audio_playout_stats_t stats;
+    audio_playout_get_stats(players[1].playout, &stats);
+    audio_plc_stats_t plc_stats;
+    audio_plc_get_stats(players[1].plc, &plc_stats);
+    printf("adaptive: target %u ms (jitter p98 %u ms), %u of %u frames compressed, %u stretched, "
+           "removed %.0f ms, inserted %.0f ms, %u frames concealed early, %u late\n",
+           (unsigned)stats.target_ms, (unsigned)stats.jitter_ms, (unsigned)stats.compressed, (unsigned)stats.frames,
+           (unsigned)stats.stretched, stats.removed_samples * 1000.0 / PLC_SAMPLE_RATE,
+           stats.inserted_samples * 1000.0 / PLC_SAMPLE_RATE, (unsigned)plc_stats.early_concealed,
+           (unsigned)plc_stats.late);
+    for (int i = 0; i < 2; i++) {
+        reorder_window_destroy(players[i].window);
+        audio_plc_destroy(players[i].plc);
+        audio_playout_destroy(players[i].playout);
+        free(players[i].latency);
+    }
+}
+
+static int load_capture(sim_stream_t* downlink, const char* path, audio_data_type_e* codec) {
+    static capture_reader_t reader;
+    if (capture_reader_open(&reader, path) != 0) {
+        fprintf(stderr, "%s is not a capture file\n", path);
+        return -1;
+    }
+    static const audio_data_type_e codecs[] = {
+        [CAPTURE_CODEC_OPUS] = AUDIO_DATA_TYPE_OPUS,
+        [CAPTURE_CODEC_G711A] = AUDIO_DATA_TYPE_PCMA,
+        [CAPTURE_CODEC_G722] = AUDIO_DATA_TYPE_G722,
+        [CAPTURE_CODEC_AAC] = AUDIO_DATA_TYPE_AACLC,
+    };
+    uint8_t format = reader.header.formats[CAPTURE_STREAM_DOWNLINK].codec;
+    *codec = format < sizeof(codecs) / sizeof(codecs[0]) && codecs[format] ? codecs[format] : AUDIO_DATA_TYPE_PCM;
+    // 用设备上收到下行帧的时间作为发送时间，重放真实的帧大小和发送节奏
+    while (capture_reader_next(&reader)) {
+        if (reader.record.stream != CAPTURE_STREAM_DOWNLINK) {
+            continue;
+        }
+        sim_frame_t* frame = stream_add(downlink, reader.record.timestamp_us);
+        frame->length = reader.record.length;
+        frame->data = malloc(frame->length ? frame->length : 1);
+        memcpy(frame->data, reader.payload, frame->length);
+    }
+    capture_reader_close(&reader);
+    return downlink->count ? 0 : -1;
+}
+
+static int usage(void) {
+    fprintf(stderr, "usage: netemu_sim [--preset good|wifi|bursty|congested] [--seed N] [--seconds N] [--buffer-ms N]\n"
+                    "                  [--frame-ms N] [--frame-bytes N] [--loss P] [--burst P_GB P_BG LOSS_BAD]\n"
+                    "                  [--delay MS] [--jitter MS] [--reorder P MS] [--duplicate P] [--kbps N]\n"
+                    "                  [--capture FILE] [--plc] [--hold-ms N] [--playout] [--drift-ppm N]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* preset = "good";
+    const char* capture_path = NULL;
+    uint32_t seed = 1;
+    uint32_t seconds = 60;
+    uint32_t buffer_ms = 60;
+    uint32_t frame_ms = 20;
+    uint32_t frame_bytes = 80;
+    bool plc = false;
+    bool playout = false;
+    double drift_ppm = 0;
+    uint32_t hold_ms = 60;
+
+    // 先取预置场景，其余参数在预置的基础上覆盖
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--preset") == 0) {
+            preset = argv[i + 1];
+        }
+    }
+    netemu_config_t config = {0};
+    if (!netemu_preset(preset, &config)) {
+        fprintf(stderr, "unknown preset %s\n", preset);
+        return usage();
+    }
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        int left = argc - i - 1;
+        if (strcmp(arg, "--preset") == 0 && left >= 1) {
+            i++;
+        } else if (strcmp(arg, "--seed") == 0 && left >= 1) {
+            seed = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(arg, "--seconds") == 0 && left >= 1) {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(arg, "--buffer-ms") == 0 && left >= 1) {
+            buffer_ms = atoi(argv[++i]);
+        } else if (strcmp(arg, "--frame-ms") == 0 && left >= 1) {
+            frame_ms = atoi(argv[++i]);
+        } else if (strcmp(arg, "--frame-bytes") == 0 && left >= 1) {
+            frame_bytes = atoi(argv[++i]);
+        } else if (strcmp(arg, "--loss") == 0 && left >= 1) {
+            config.loss_good = atof(argv[++i]);
+        } else if (strcmp(arg, "--burst") == 0 && left >= 3) {
+            config.p_good_to_bad = atof(argv[++i]);
+            config.p_bad_to_good = atof(argv[++i]);
+            config.loss_bad = atof(argv[++i]);
+        } else if (strcmp(arg, "--delay") == 0 && left >= 1) {
+            config.delay_ms = atoi(argv[++i]);
+        } else if (strcmp(arg, "--jitter") == 0 && left >= 1) {
+            config.jitter_ms = atoi(argv[++i]);
+        } else if (strcmp(arg, "--reorder") == 0 && left >= 2) {
+            config.reorder_prob = atof(argv[++i]);
+            config.reorder_ms = atoi(argv[++i]);
+        } else if (strcmp(arg, "--duplicate") == 0 && left >= 1) {
+            config.duplicate_prob = atof(argv[++i]);
+        } else if (strcmp(arg, "--kbps") == 0 && left >= 1) {
+            config.bandwidth_kbps = atoi(argv[++i]);
+            config.queue_ms = config.queue_ms ? config.queue_ms : 300;
+        } else if (strcmp(arg, "--capture") == 0 && left >= 1) {
+            capture_path = argv[++i];
+        } else if (strcmp(arg, "--plc") == 0) {
+            plc = true;
+        } else if (strcmp(arg, "--hold-ms") == 0 && left >= 1) {
+            hold_ms = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(arg, "--playout") == 0) {
+            playout = true;
+        } else if (strcmp(arg, "--drift-ppm") == 0 && left >= 1) {
+            drift_ppm = atof(argv[++i]);
+        } else {
+            return usage();
+        }
+    }
+    if (frame_ms == 0 || frame_bytes == 0 || frame_bytes > UINT16_MAX || ((plc || playout) && capture_path)) {
+        return usage();
+    }
+    int frame_samples = PLC_SAMPLE_RATE * frame_ms / 1000;
+    int16_t* reference = NULL;
+    if (plc || playout) {
+        frame_bytes = frame_samples * sizeof(int16_t);
+        reference = synth_speech((size_t)seconds * 1000 / frame_ms * frame_samples);
+    }
+
+    // 上下行使用不同的随机序列，避免两个方向的丢包完全相关
+    netemu_config_t uplink_config = config;
+    netemu_config_t downlink_config = config;
+    uplink_config.seed = seed;
+    downlink_config.seed = seed ^ 0x5A5A5A5A;
+
+    static sim_t sim = {0};
+    audio_data_type_e codec = AUDIO_DATA_TYPE_OPUS;
+    if (capture_path && load_capture(&sim.downlink, capture_path, &codec) != 0) {
+        return 1;
+    }
+    uint64_t end_us = (uint64_t)seconds * 1000 * 1000;
+    if (capture_path) {
+        end_us = sim.downlink.frames[sim.downlink.count - 1].send_us + 1;
+    }
+
+    reorder_window_config_t reorder_config = {
+        .frame_ms = frame_ms,
+        .max_hold_ms = hold_ms,
+        .max_depth = REORDER_DEPTH,
+        .max_gap_ms = 120,
+        .adapt_ms = 10000,
+        .max_frame_bytes = capture_path ? UINT16_MAX : frame_bytes,
+        .release = on_reorder_release,
+        .ctx = &sim.reorder,
+    };
+    sim.reorder.window = reorder_window_create(&reorder_config);
+
+    byte_rtc_event_handler_t handler = {
+        .on_audio_data = on_audio_data,
+    };
+    sim.engine = byte_rtc_create("netemu", &handler);
+    byte_rtc_set_user_data(sim.engine, &sim);
+    fake_rtc_set_network(sim.engine, &uplink_config, &downlink_config);
+    fake_rtc_set_uplink_callback(sim.engine, on_uplink, &sim);
+    byte_rtc_init(sim.engine);
+    byte_rtc_join_room(sim.engine, "netemu", "device", "", &(byte_rtc_room_options_t){.auto_subscribe_audio = true});
+
+    uint8_t* payload = calloc(1, frame_bytes);
+    audio_frame_info_t info = {.data_type = AUDIO_DATA_TYPE_OPUS};
+    if (plc || playout) {
+        codec = AUDIO_DATA_TYPE_PCM;
+    }
+    size_t next_downlink = 0;
+    for (uint64_t now_us = 0; now_us < end_us; now_us += (uint64_t)frame_ms * 1000) {
+        // 上行和生成的下行每帧一个包；capture 重放时下行按记录的时间发送
+        while (capture_path && next_downlink < sim.downlink.count && sim.downlink.frames[next_downlink].send_us <= now_us) {
+            sim_frame_t* frame = &sim.downlink.frames[next_downlink++];
+            fake_rtc_advance(sim.engine, frame->send_us);
+            fake_rtc_inject_downlink(sim.engine, frame->data, frame->length, codec);
+        }
+        fake_rtc_advance(sim.engine, now_us);
+        stream_add(&sim.uplink, now_us);
+        byte_rtc_send_audio_data(sim.engine, "netemu", payload, frame_bytes, &info);
+        if (!capture_path) {
+            const void* frame = reference ? (const void*)(reference + sim.downlink.count * frame_samples) : payload;
+            stream_add(&sim.downlink, now_us);
+            fake_rtc_inject_downlink(sim.engine, frame, frame_bytes, codec);
+        }
+    }
+    while (capture_path && next_downlink < sim.downlink.count) {
+        sim_frame_t* frame = &sim.downlink.frames[next_downlink++];
+        fake_rtc_advance(sim.engine, frame->send_us);
+        fake_rtc_inject_downlink(sim.engine, frame->data, frame->length, codec);
+    }
+    fake_rtc_advance(sim.engine, end_us + DRAIN_US);
+    uint32_t deadline_ms;
+    while (reorder_window_next_deadline(sim.reorder.window, &deadline_ms)) {
+        reorder_window_poll(sim.reorder.window, deadline_ms);
+    }
+
+    fake_rtc_stats_t stats;
+    fake_rtc_get_stats(sim.engine, &stats);
+    printf("preset %s, seed %u, %s\n", preset, (unsigned)seed, capture_path ? capture_path : "generated frames");
+    printf("%-9s %8s %9s %10s %10s %6s %8s\n", "link", "sent", "delivered", "lost_rand", "lost_queue", "dup", "reorder");
+    report_link("uplink", &stats.uplink, &sim.uplink);
+    report_link("downlink", &stats.downlink, &sim.downlink);
+    printf("%-9s %7s %7s %7s %7s %7s\n", "added_ms", "p50", "p90", "p95", "p99", "max");
+    report_latency("uplink", &sim.uplink);
+    report_latency("downlink", &sim.downlink);
+    report_playout(&sim.downlink, buffer_ms);
+    report_reorder(&sim.reorder, hold_ms);
+    if (plc) {
+        report_plc(&sim.downlink, reference, frame_samples, buffer_ms);
+    }
+    if (playout) {
+        report_playout_adaptive(&sim, reference, frame_samples, frame_ms, sim.downlink.count, buffer_ms, drift_ppm,
+                                hold_ms);
+    }
+
+    byte_rtc_leave_room(sim.engine, "netemu");
+    byte_rtc_fini(sim.engine);
+    byte_rtc_destroy(sim.engine);
+    reorder_window_destroy(sim.reorder.window);
+    free(payload);
+    free(reference);
+    free(sim.arrivals);
+    return 0;
+}
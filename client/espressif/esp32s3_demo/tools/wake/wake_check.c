@@ -0,0 +1,237 @@
+// Copyright (2025) Beijing Volcano Engine Technology Ltd.
+// SPDX-License-Identifier: MIT
+
+// 主机上用带标注的录音检查唤醒词检测：按 10ms 把 PCM 喂给 main/ 下的 WakeWord.c，
+// 在每个标注的唤醒词结束点调用 wake_gate_mark_keyword_end，输出检测次数、命中、漏检、误唤醒和检测时延。
+//   wake_check PCM LABELS [THRESHOLD HOLD_MS [SESSION_MS]]
+//   wake_check                          不带参数时生成合成的录音和标注自检，结果和预期不一致时返回失败
+// PCM 为 16k 单声道 16bit 的裸数据或 wav；LABELS 每行一个唤醒词结束时间（ms），按时间排序，# 开头的行忽略。
+// SESSION_MS 为唤醒后会话持续的时间，期间不检测唤醒词，默认 2000；为 0 时唤醒后马上回到检测，
+// 唤醒词后面接着说的话会再次触发。每次唤醒的位置和时延由 WakeWord.c 的日志输出。
+//
+// 编译：
+//   cd client/espressif/esp32s3_demo/tools/wake
+//   gcc -I../capture/host -I../../main wake_check.c ../../main/WakeWord.c -o wake_check
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WakeWord.h"
+
+#define FEED_SAMPLES        (WAKE_WORD_SAMPLE_RATE / 100)   // 10ms，和 AFE 输出的节奏接近
+#define MAX_LABELS          4096
+#define SAMPLES_TO_MS(n)    ((double)(n) * 1000 / WAKE_WORD_SAMPLE_RATE)
+#define MS_TO_SAMPLES(ms)   ((uint64_t)(ms) * WAKE_WORD_SAMPLE_RATE / 1000)
+
+typedef struct {
+    uint64_t position;          // 已喂入的样本数
+    uint64_t wake_position;     // 误差不超过一次喂入的长度
+    bool woken;
+} check_state_t;
+
+static void check_on_wake(void* ctx) {
+    check_state_t* state = ctx;
+    state->woken = true;
+    state->wake_position = state->position;
+}
+
+// 读入整个文件；wav 跳到 data 块，只接受 16k 单声道 16bit
+static int16_t* load_pcm(const char* path, size_t* count) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "open %s failed\n", path);
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t* data = malloc(size > 0 ? size : 1);
+    if (data == NULL || fread(data, 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "read %s failed\n", path);
+        fclose(fp);
+        free(data);
+        return NULL;
+    }
+    fclose(fp);
+
+    size_t offset = 0;
+    size_t length = size;
+    if (size >= 12 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WAVE", 4) == 0) {
+        offset = 12;
+        length = 0;
+        while (offset + 8 <= (size_t)size) {
+            uint32_t chunk_size = data[offset + 4] | data[offset + 5] << 8 | data[offset + 6] << 16 | (uint32_t)data[offset + 7] << 24;
+            if (memcmp(data + offset, "fmt ", 4) == 0 && chunk_size >= 16) {
+                uint16_t channels = data[offset + 10] | data[offset + 11] << 8;
+                uint32_t rate = data[offset + 12] | data[offset + 13] << 8 | data[offset + 14] << 16 | (uint32_t)data[offset + 15] << 24;
+                uint16_t bits = data[offset + 22] | data[offset + 23] << 8;
+                if (channels != 1 || rate != WAKE_WORD_SAMPLE_RATE || bits != 16) {
+                    fprintf(stderr, "%s: %u ch %u Hz %u bit, need 1 ch %d Hz 16 bit\n", path, channels, (unsigned)rate, bits,
+                            WAKE_WORD_SAMPLE_RATE);
+                    free(data);
+                    return NULL;
+                }
+            } else if (memcmp(data + offset, "data", 4) == 0) {
+                offset += 8;
+                length = chunk_size < size - offset ? chunk_size : size - offset;
+                break;
+            }
+            offset += 8 + chunk_size + (chunk_size & 1);
+        }
+    }
+    *count = length / sizeof(int16_t);
+    int16_t* samples = malloc(*count * sizeof(int16_t) + 1);
+    if (samples != NULL) {
+        memcpy(samples, data + offset, *count * sizeof(int16_t));
+    }
+    free(data);
+    return samples;
+}
+
+static int load_labels(const char* path, uint64_t* labels) {
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "open %s failed\n", path);
+        return -1;
+    }
+    char line[128];
+    int count = 0;
+    while (fgets(line, sizeof(line), fp) && count < MAX_LABELS) {
+        char* end = NULL;
+        double ms = strtod(line, &end);
+        if (line[0] == '#' || end == line) {
+            continue;
+        }
+        labels[count++] = (uint64_t)(ms * WAKE_WORD_SAMPLE_RATE / 1000);
+    }
+    fclose(fp);
+    return count;
+}
+
+// 合成自检用的录音：底噪上叠加几段语音，前 500ms 是唤醒词，后面接着说指令
+//   2s、6s、10s  1500ms，标注在 +500ms，能量检测在约 600ms 触发，应当命中
+//   14s          1000ms，没有标注，触发后算误唤醒
+//   17s          400ms，标注在 +400ms，不够 hold_ms，应当漏检
+static int16_t* make_synthetic(size_t* count, uint64_t* labels, int* label_count) {
+    static const struct {
+        int start_ms;
+        int length_ms;
+        int label_ms;       // 相对 start_ms，-1 为没有标注
+    } bursts[] = {
+        {2000, 1500, 500}, {6000, 1500, 500}, {10000, 1500, 500}, {14000, 1000, -1}, {17000, 400, 400},
+    };
+    *count = MS_TO_SAMPLES(20000);
+    int16_t* samples = malloc(*count * sizeof(int16_t));
+    if (samples == NULL) {
+        return NULL;
+    }
+    uint32_t seed = 1;
+    for (size_t i = 0; i < *count; i++) {
+        seed = seed * 1103515245 + 12345;
+        samples[i] = (int16_t)((int)((seed >> 16) % 401) - 200);
+    }
+    *label_count = 0;
+    for (size_t b = 0; b < sizeof(bursts) / sizeof(bursts[0]); b++) {
+        uint64_t start = MS_TO_SAMPLES(bursts[b].start_ms);
+        uint64_t end = start + MS_TO_SAMPLES(bursts[b].length_ms);
+        for (uint64_t i = start; i < end; i++) {
+            // 约 300Hz 的方波，平均幅度 4000
+            samples[i] += ((i / 26) & 1) ? 4000 : -4000;
+        }
+        if (bursts[b].label_ms >= 0) {
+            labels[(*label_count)++] = start + MS_TO_SAMPLES(bursts[b].label_ms);
+        }
+    }
+    return samples;
+}
+
+int main(int argc, char** argv) {
+    bool self_test = argc < 3;
+    int threshold = argc > 3 ? atoi(argv[3]) : 1500;
+    int hold_ms = argc > 4 ? atoi(argv[4]) : 600;
+    int session_ms = argc > 5 ? atoi(argv[5]) : 2000;
+    if (argc == 2) {
+        fprintf(stderr, "usage: wake_check PCM LABELS [THRESHOLD HOLD_MS [SESSION_MS]]\n"
+                        "       wake_check\n");
+        return 1;
+    }
+
+    static uint64_t labels[MAX_LABELS];
+    int label_count = 0;
+    size_t count = 0;
+    int16_t* samples = NULL;
+    if (self_test) {
+        samples = make_synthetic(&count, labels, &label_count);
+    } else {
+        samples = load_pcm(argv[1], &count);
+        label_count = samples ? load_labels(argv[2], labels) : -1;
+    }
+    if (samples == NULL || label_count < 0) {
+        free(samples);
+        return 1;
+    }
+
+    check_state_t state = {0};
+    wake_gate_config_t config = {
+        .on_wake = check_on_wake,
+        .ctx = &state,
+        .vad_threshold = 600,
+        .silence_end_ms = 20000,
+    };
+    wake_gate_t* gate = wake_gate_create(wake_detector_energy_create(threshold, hold_ms), &config);
+    if (gate == NULL) {
+        free(samples);
+        return 1;
+    }
+
+    // 每次最多喂 10ms，遇到标注点时先喂到标注点再标注，标注落在准确的样本位置
+    int next_label = 0;
+    while (state.position < count) {
+        uint64_t end = state.position + FEED_SAMPLES;
+        if (end > count) {
+            end = count;
+        }
+        if (next_label < label_count && labels[next_label] < end) {
+            end = labels[next_label] > state.position ? labels[next_label] : state.position;
+        }
+        if (end > state.position) {
+            wake_gate_feed(gate, samples + state.position, (int)(end - state.position));
+            state.position = end;
+        }
+        while (next_label < label_count && labels[next_label] <= state.position) {
+            wake_gate_mark_keyword_end(gate);
+            next_label++;
+        }
+        if (state.woken && state.position - state.wake_position >= MS_TO_SAMPLES(session_ms)) {
+            state.woken = false;
+            wake_gate_set_session(gate, false);
+        }
+    }
+
+    wake_stats_t stats;
+    wake_gate_get_stats(gate, &stats);
+    wake_gate_destroy(gate);
+    free(samples);
+
+    // 有标注时命中的检测才记录时延，没有被检测到的标注就是漏检
+    uint32_t hits = stats.latency_count;
+    uint32_t misses = stats.labeled_keywords - hits;
+    double hours = SAMPLES_TO_MS(count) / 3600000.0;
+    printf("%.1f s audio, %u labeled keywords\n", SAMPLES_TO_MS(count) / 1000, (unsigned)stats.labeled_keywords);
+    printf("%u detections: %u hits, %u misses, %u false accepts (%.1f per hour)\n", (unsigned)stats.detections,
+           (unsigned)hits, (unsigned)misses, (unsigned)stats.false_accepts, hours > 0 ? stats.false_accepts / hours : 0.0);
+    printf("latency from keyword end: avg %u ms, max %u ms\n",
+           hits > 0 ? (unsigned)(stats.latency_ms_sum / hits) : 0, (unsigned)stats.latency_ms_max);
+    if (stats.labeled_keywords == 0) {
+        printf("no labels, false accepts and latency are counted without labels\n");
+    }
+
+    if (self_test) {
+        if (stats.detections != 4 || hits != 3 || misses != 1 || stats.false_accepts != 1 || stats.latency_ms_max > 200) {
+            printf("FAIL\n");
+            return 1;
+        }
+        printf("PASS\n");
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# startvoicechat 的准入控制：令牌桶限制每秒转发到 StartVoiceChat 的数量，没有令牌时最多 max_waiters 个请求
+# 排队等待 max_wait 秒，之后拒绝并给出建议的重试时间（Retry-After）。
+# OpenAPI 返回配额或并发超限时，在 quota_cooldown 秒内直接拒绝所有启动，不再把请求转发过去。
+# 集中上电时设备按 Retry-After 加随机抖动重试，请求被摊开，不会变成重试风暴
+
+import math
+import threading
+import time
+
+
+class Admission:
+    def __init__(self, rate, burst, max_waiters, max_wait, quota_cooldown):
+        self._rate = float(rate)
+        self._burst = float(burst)
+        self._max_waiters = max_waiters
+        self._max_wait = max_wait
+        self._quota_cooldown = quota_cooldown
+        self._cond = threading.Condition()
+        self._tokens = self._burst
+        self._last_refill = time.monotonic()
+        self._waiters = 0
+        self._blocked_until = 0.0
+        self._wait_seconds = 0.0
+        self._counts = {
+            "admitted" : 0,
+            "admitted_after_wait" : 0,
+            "rejected_queue_full" : 0,
+            "rejected_wait_timeout" : 0,
+            "rejected_quota" : 0,
+            "quota_exceeded" : 0
+        }
+
+    def _refill(self, now):
+        self._tokens = min(self._burst, self._tokens + (now - self._last_refill) * self._rate)
+        self._last_refill = now
+
+    @staticmethod
+    def _retry_after(seconds):
+        return max(1, int(math.ceil(seconds)))
+
+    # 返回 0 表示可以转发，否则为建议的重试时间，单位 s
+    def acquire(self):
+        with self._cond:
+            now = time.monotonic()
+            if now < self._blocked_until:
+                self._counts["rejected_quota"] += 1
+                return self._retry_after(self._blocked_until - now)
+            self._refill(now)
+            if self._waiters == 0 and self._tokens >= 1:
+                self._tokens -= 1
+                self._counts["admitted"] += 1
+                return 0
+            if self._waiters >= self._max_waiters:
+                self._counts["rejected_queue_full"] += 1
+                # 排在前面的请求用完令牌之后才轮到
+                return self._retry_after((self._waiters + 1 - self._tokens) / self._rate)
+
+            self._waiters += 1
+            start = now
+            deadline = now + self._max_wait
+            try:
+                while True:
+                    if now < self._blocked_until:
+                        self._counts["rejected_quota"] += 1
+                        return self._retry_after(self._blocked_until - now)
+                    if self._tokens >= 1:
+                        self._tokens -= 1
+                        self._counts["admitted"] += 1
+                        self._counts["admitted_after_wait"] += 1
+                        self._wait_seconds += now - start
+                        return 0
+                    if now >= deadline:
+                        self._counts["rejected_wait_timeout"] += 1
+                        return self._retry_after(self._waiters / self._rate)
+                    self._cond.wait(min((1 - self._tokens) / self._rate, deadline - now))
+                    now = time.monotonic()
+                    self._refill(now)
+            finally:
+                self._waiters -= 1
+
+    # OpenAPI 返回配额或并发超限
+    def on_quota_exceeded(self):
+        with self._cond:
+            self._counts["quota_exceeded"] += 1
+            self._blocked_until = time.monotonic() + self._quota_cooldown
+            self._cond.notify_all()
+
+    # 因配额超限还要拒绝多久，单位 s，没有时为 0
+    def blocked_for(self):
+        with self._cond:
+            remaining = self._blocked_until - time.monotonic()
+        return self._retry_after(remaining) if remaining > 0 else 0
+
+    def stats(self):
+        with self._cond:
+            self._refill(time.monotonic())
+            stats = dict(self._counts)
+            stats["waiting"] = self._waiters
+            stats["tokens"] = round(self._tokens, 2)
+            stats["wait_ms_avg"] = round(self._wait_seconds * 1000 / self._counts["admitted_after_wait"], 1) if self._counts["admitted_after_wait"] > 0 else 0.0
+            stats["blocked_seconds"] = round(max(0.0, self._blocked_until - time.monotonic()), 1)
+            return stats
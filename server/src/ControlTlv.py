@@ -0,0 +1,96 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# 设备和服务端之间控制请求的紧凑编码，和 json 二选一，按 Content-Type 协商。
+# 每个字段为 tag(1 字节) + 长度(2 字节，大端) + 值，字符串为 UTF-8，不带结尾的 0；
+# 整数为 4 字节大端，布尔为 1 字节；响应的 data 为嵌套的 TLV。
+# tag 和设备端 main/ControlTlv.h 保持一致，解码时跳过不认识的 tag，编码时跳过表中没有的字段
+
+import struct
+
+CONTENT_TYPE = "application/x-rtc-tlv"
+
+TYPE_STRING = 0
+TYPE_UINT = 1
+TYPE_BOOL = 2
+TYPE_OBJECT = 3
+
+FIELDS = {
+    0x01 : ("app_id", TYPE_STRING),
+    0x02 : ("room_id", TYPE_STRING),
+    0x03 : ("uid", TYPE_STRING),
+    0x04 : ("task_id", TYPE_STRING),
+    0x05 : ("bot_uid", TYPE_STRING),
+    0x06 : ("token", TYPE_STRING),
+    0x07 : ("audio_codec", TYPE_STRING),
+    0x08 : ("room_identifier", TYPE_STRING),
+    0x09 : ("device_id", TYPE_STRING),
+    0x0a : ("command", TYPE_STRING),
+    0x0b : ("message", TYPE_STRING),
+    0x0c : ("enable_burst", TYPE_BOOL),
+    0x0d : ("burst_buffer_size", TYPE_UINT),
+    0x0e : ("burst_interval", TYPE_UINT),
+    0x0f : ("uid_identifier", TYPE_STRING),
+    0x10 : ("bot_identifier", TYPE_STRING),
+    0x11 : ("retry_after", TYPE_UINT),
+    0x12 : ("resumed", TYPE_BOOL),
+    0x40 : ("code", TYPE_UINT),
+    0x41 : ("msg", TYPE_STRING),
+    0x42 : ("data", TYPE_OBJECT)
+}
+TAGS = {name : (tag, value_type) for tag, (name, value_type) in FIELDS.items()}
+
+HEADER = struct.Struct(">BH")
+UINT = struct.Struct(">I")
+MAX_VALUE_LEN = 0xffff
+
+
+def encode(obj):
+    out = bytearray()
+    for name, value in obj.items():
+        if name not in TAGS or value == None:
+            continue
+        tag, value_type = TAGS[name]
+        if value_type == TYPE_STRING:
+            raw = str(value).encode("utf-8")
+        elif value_type == TYPE_UINT:
+            raw = UINT.pack(int(value) & 0xffffffff)
+        elif value_type == TYPE_BOOL:
+            raw = b"\x01" if value else b"\x00"
+        else:
+            raw = encode(value)
+        if len(raw) > MAX_VALUE_LEN:
+            raise ValueError("tlv field %s too long: %d" % (name, len(raw)))
+        out += HEADER.pack(tag, len(raw))
+        out += raw
+    return bytes(out)
+
+
+def decode(data):
+    obj = {}
+    pos = 0
+    while pos < len(data):
+        if pos + HEADER.size > len(data):
+            raise ValueError("truncated tlv header at %d" % pos)
+        tag, length = HEADER.unpack_from(data, pos)
+        pos += HEADER.size
+        if pos + length > len(data):
+            raise ValueError("truncated tlv value, tag 0x%02x" % tag)
+        raw = data[pos:pos + length]
+        pos += length
+        if tag not in FIELDS:
+            continue
+        name, value_type = FIELDS[tag]
+        if value_type == TYPE_STRING:
+            obj[name] = raw.decode("utf-8")
+        elif value_type == TYPE_UINT:
+            if length != UINT.size:
+                raise ValueError("bad uint length %d, tag 0x%02x" % (length, tag))
+            obj[name] = UINT.unpack(raw)[0]
+        elif value_type == TYPE_BOOL:
+            if length != 1:
+                raise ValueError("bad bool length %d, tag 0x%02x" % (length, tag))
+            obj[name] = raw[0] != 0
+        else:
+            obj[name] = decode(raw)
+    return obj
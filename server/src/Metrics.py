@@ -0,0 +1,113 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# 进程内的控制面指标：耗时直方图、按返回码的计数和并发数，GET /metrics 按 Prometheus 文本格式输出。
+# 每次记录只在一个指标的锁内做一次桶查找和几次加法，每个请求的全部记录约几微秒，相对 OpenAPI 的百毫秒级可以忽略；
+# 标签值由调用方限制在固定集合内（接口路径、OpenAPI action、返回码），避免指标数量无限增长
+
+import bisect
+import threading
+
+# 单位 s，覆盖 token 生成（亚毫秒）到 OpenAPI 超时（十几秒）
+DEFAULT_BUCKETS = (0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 20.0)
+
+
+def _format_labels(label_names, label_values, extra = ""):
+    pairs = ['%s="%s"' % (name, str(value).replace("\\", "\\\\").replace('"', '\\"')) for name, value in zip(label_names, label_values)]
+    if extra != "":
+        pairs.append(extra)
+    return "{" + ",".join(pairs) + "}" if pairs else ""
+
+
+def _format_value(value):
+    return repr(float(value)) if isinstance(value, float) else str(value)
+
+
+class Counter:
+    type = "counter"
+
+    def __init__(self, name, help, label_names):
+        self.name = name
+        self.help = help
+        self.label_names = label_names
+        self._lock = threading.Lock()
+        self._values = {}
+
+    def inc(self, labels = (), value = 1):
+        with self._lock:
+            self._values[labels] = self._values.get(labels, 0) + value
+
+    def render(self, lines):
+        lines.append("# HELP %s %s" % (self.name, self.help))
+        lines.append("# TYPE %s %s" % (self.name, self.type))
+        with self._lock:
+            values = sorted(self._values.items())
+        for labels, value in values:
+            lines.append("%s%s %s" % (self.name, _format_labels(self.label_names, labels), _format_value(value)))
+
+
+class Gauge(Counter):
+    type = "gauge"
+
+    def dec(self, labels = (), value = 1):
+        self.inc(labels, -value)
+
+
+class Histogram:
+    def __init__(self, name, help, label_names, buckets = DEFAULT_BUCKETS):
+        self.name = name
+        self.help = help
+        self.label_names = label_names
+        self.buckets = buckets
+        self._lock = threading.Lock()
+        # labels -> [每个桶的计数（最后一个为 +Inf）, 总和, 次数]，桶计数在输出时累加
+        self._values = {}
+
+    def observe(self, labels, seconds):
+        index = bisect.bisect_left(self.buckets, seconds)
+        with self._lock:
+            value = self._values.get(labels)
+            if value == None:
+                value = [[0] * (len(self.buckets) + 1), 0.0, 0]
+                self._values[labels] = value
+            value[0][index] += 1
+            value[1] += seconds
+            value[2] += 1
+
+    def render(self, lines):
+        lines.append("# HELP %s %s" % (self.name, self.help))
+        lines.append("# TYPE %s histogram" % self.name)
+        with self._lock:
+            values = sorted((labels, (list(value[0]), value[1], value[2])) for labels, value in self._values.items())
+        for labels, (counts, total, count) in values:
+            cumulative = 0
+            for bound, bucket_count in zip(self.buckets + ("+Inf",), counts):
+                cumulative += bucket_count
+                le = 'le="%s"' % (bound if bound == "+Inf" else repr(bound))
+                lines.append("%s_bucket%s %d" % (self.name, _format_labels(self.label_names, labels, le), cumulative))
+            lines.append("%s_sum%s %s" % (self.name, _format_labels(self.label_names, labels), repr(total)))
+            lines.append("%s_count%s %d" % (self.name, _format_labels(self.label_names, labels), count))
+
+
+class Registry:
+    def __init__(self):
+        self._metrics = []
+
+    def counter(self, name, help, label_names = ()):
+        return self._add(Counter(name, help, label_names))
+
+    def gauge(self, name, help, label_names = ()):
+        return self._add(Gauge(name, help, label_names))
+
+    def histogram(self, name, help, label_names = (), buckets = DEFAULT_BUCKETS):
+        return self._add(Histogram(name, help, label_names, buckets))
+
+    def _add(self, metric):
+        self._metrics.append(metric)
+        return metric
+
+    def render(self):
+        lines = []
+        for metric in self._metrics:
+            metric.render(lines)
+        return "\n".join(lines) + "\n"
@@ -0,0 +1,94 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# 预先生成的房间信息（room_id、uid、bot_uid、token）池，按房间 id 前缀（音频编码 + room_identifier）分开。
+# startvoicechat 直接取一个，不在设备请求的路径上生成 token；后台线程在被取走后补充。
+# 启动时只预生成各音频编码，请求中第一次出现的前缀当场生成并加入，最多 max_keys 个。
+# 放置超过 max_age 的房间信息丢弃重新生成，保证 token 剩余的有效期
+
+import collections
+import threading
+import time
+
+
+class RoomPool:
+    def __init__(self, mint, keys, size, max_age, max_keys):
+        # mint(*key) 返回一个新的房间信息
+        self._mint = mint
+        self._size = size
+        self._max_age = max_age
+        self._max_keys = max_keys
+        self._pools = {key : collections.deque() for key in keys}
+        self._cond = threading.Condition()
+        self._hits = 0
+        self._misses = 0
+        self._mint_count = 0
+        self._mint_seconds = 0.0
+        self._mint_seconds_max = 0.0
+        self._expired = 0
+        self._thread = threading.Thread(target=self._refill_loop, name="room_pool", daemon=True)
+        self._thread.start()
+
+    def take(self, key):
+        now = time.monotonic()
+        with self._cond:
+            pool = self._pools.get(key)
+            if pool == None and len(self._pools) < self._max_keys:
+                self._pools[key] = collections.deque()
+            while pool:
+                minted_at, room_info = pool.popleft()
+                if now - minted_at < self._max_age:
+                    self._hits += 1
+                    self._cond.notify()
+                    return room_info
+                self._expired += 1
+            self._misses += 1
+            self._cond.notify()
+        # 池空了或者是新的前缀，当场生成
+        return self.mint(key)
+
+    def mint(self, key):
+        start = time.perf_counter()
+        room_info = self._mint(*key)
+        elapsed = time.perf_counter() - start
+        with self._cond:
+            self._mint_count += 1
+            self._mint_seconds += elapsed
+            self._mint_seconds_max = max(self._mint_seconds_max, elapsed)
+        return room_info
+
+    def stats(self):
+        with self._cond:
+            taken = self._hits + self._misses
+            return {
+                "hits" : self._hits,
+                "misses" : self._misses,
+                "hit_rate" : round(self._hits / taken, 3) if taken > 0 else 0.0,
+                "expired" : self._expired,
+                "mint_count" : self._mint_count,
+                "mint_ms_avg" : round(self._mint_seconds * 1000 / self._mint_count, 3) if self._mint_count > 0 else 0.0,
+                "mint_ms_max" : round(self._mint_seconds_max * 1000, 3),
+                "ready" : {"".join(key) : len(pool) for key, pool in self._pools.items()}
+            }
+
+    def _next_missing(self):
+        now = time.monotonic()
+        for key, pool in self._pools.items():
+            while pool and now - pool[0][0] >= self._max_age:
+                pool.popleft()
+                self._expired += 1
+            if len(pool) < self._size:
+                return key
+        return None
+
+    def _refill_loop(self):
+        while True:
+            with self._cond:
+                key = self._next_missing()
+                while key == None:
+                    # 没有被取走时也要定期醒来淘汰过期的
+                    self._cond.wait(self._max_age / 2)
+                    key = self._next_missing()
+            room_info = self.mint(key)
+            with self._cond:
+                self._pools[key].append((time.monotonic(), room_info))
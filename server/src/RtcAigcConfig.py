@@ -1,6 +1,8 @@
 # Copyright (2025) Beijing Volcano Engine Technology Ltd.
 # SPDX-License-Identifier: MIT
 
+import os
+
 # 鉴权 AK/SK。前往 https://console.volcengine.com/iam/keymanage 获取
 SK = ""
 AK = ""
@@ -27,3 +29,58 @@ TTS_ACCESS_TOKEN = ""
 
 # 服务端监听端口号,你可以根据实际业务需求设置端口号
 PORT = 8080
+
+# 服务端并发处理的设置，设备集中上电时会同时请求 startvoicechat
+# 等待 accept 的连接队列长度
+SERVER_LISTEN_BACKLOG = 512
+# 设备连接保持（keep-alive）的空闲超时，单位 s
+SERVER_KEEP_ALIVE_TIMEOUT = 30
+# OpenAPI 地址。压测时可以通过环境变量指向 server/tools/OpenApiStub.py，例如 RTC_API_SCHEME=http RTC_API_HOST=127.0.0.1:18090
+RTC_API_SCHEME = os.environ.get("RTC_API_SCHEME", "https")
+RTC_API_HOST = os.environ.get("RTC_API_HOST", "rtc.volcengineapi.com")
+# 到 OpenAPI 的连接池大小，超过的请求排队等待空闲连接
+RTC_API_POOL_SIZE = 64
+# 请求 OpenAPI 的超时，(连接, 读取)，单位 s
+RTC_API_TIMEOUT = (3, 15)
+# 每种房间前缀（音频编码 + room_identifier）预先生成的房间信息（room_id、uid、token）数量
+ROOM_POOL_SIZE = 32
+# 最多预生成的房间前缀种数
+ROOM_POOL_MAX_PREFIXES = 16
+# 预先生成的房间信息放置超过这个时间后丢弃重新生成，单位 s
+ROOM_POOL_MAX_AGE = 600
+
+# 设备没有停止的会话由服务端回收（StopVoiceChat）
+# 发过 heartbeat 的会话超过这个时间没有请求即回收，单位 s，设备每 60s 发一次 heartbeat
+SESSION_IDLE_TIMEOUT = 180
+# 从没发过 heartbeat 的会话（旧固件）超过这个时间没有请求才回收，单位 s
+SESSION_LEGACY_IDLE_TIMEOUT = 7200
+# 检查空闲会话的间隔，单位 s
+SESSION_REAP_INTERVAL = 15
+# 并发调用 StopVoiceChat 的线程数
+SESSION_REAPER_WORKERS = 4
+
+# 服务端执行 function calling（设备转发 tool_calls）
+# 同时执行的工具调用数
+TOOL_WORKERS = 8
+# 单个工具调用的默认超时，单位 s，超时后向智能体传回超时说明
+TOOL_TIMEOUT = 5
+# 排队和执行中的工具调用上限，超过时 updatevoicechat 返回错误
+TOOL_MAX_PENDING = 256
+# 每个工具保留最近多少次耗时用来计算分位数
+TOOL_LATENCY_SAMPLES = 1024
+# 天气查询结果按地点缓存的时间，单位 s
+TOOL_WEATHER_CACHE_TTL = 600
+
+# startvoicechat 准入控制
+# 每秒最多转发到 StartVoiceChat 的请求数，按 OpenAPI 的频率限制和智能体并发配额设置
+ADMISSION_START_RATE = 20
+# 令牌桶容量，允许短时间内超过 ADMISSION_START_RATE 的请求数
+ADMISSION_START_BURST = 40
+# 没有令牌时最多排队等待的请求数，超过时直接返回 429 和 Retry-After
+ADMISSION_MAX_WAITERS = 64
+# 排队等待的最长时间，单位 s
+ADMISSION_MAX_WAIT = 2
+# OpenAPI 返回配额或并发超限后，在这段时间内直接拒绝启动，单位 s
+ADMISSION_QUOTA_COOLDOWN = 30
+# OpenAPI 错误码（小写）中包含这些关键字时视为配额或并发超限，HTTP 429 也算
+ADMISSION_QUOTA_ERROR_KEYWORDS = ("limit", "quota", "throttl", "toomany")
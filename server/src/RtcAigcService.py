@@ -3,27 +3,46 @@
 
 import http.server
 import re
-import socketserver
 import json
 import uuid
 import time
 
 import AccessToken
+import Admission
+import ControlTlv
+import Metrics
+import RoomPool
 import RtcApiRequester
+import SessionRegistry
+import ToolExecutor
 
 from RtcAigcConfig import *
 
 RESPONSE_CODE_SUCCESS = 200
 RESPONSE_CODE_REQUEST_ERROR = 400
+RESPONSE_CODE_TOO_MANY_REQUESTS = 429
 RESPONSE_CODE_SERVER_ERROR = 500
 # START_VOICE_CHAT_URL = "https://rtc.volcengineapi.com?Action=StartVoiceChat&Version=2024-12-01"
 # STOP_VOICE_CHAT_URL = "https://rtc.volcengineapi.com?Action=StopVoiceChat&Version=2024-12-01"
 # UPDATE_VOICE_CHAT_URL = "https://rtc.volcengineapi.com?Action=UpdateVoiceChat&Version=2024-12-01"
-RTC_API_HOST = "rtc.volcengineapi.com"
 RTC_API_START_VOICE_CHAT_ACTION = "StartVoiceChat"
 RTC_API_STOP_VOICE_CHAT_ACTION = "StopVoiceChat"
 RTC_API_UPDATE_VOICE_CHAT_ACTION = "UpdateVoiceChat"
 RTC_API_VERSION = "2024-12-01"
+RTC_TOKEN_EXPIRE_SECONDS = 3600 * 48 # rtc token 48h
+AUDIO_CODECS = ("OPUS", "G711A", "G722", "AAC")
+POST_ENDPOINTS = ("/startvoicechat", "/resumevoicechat", "/stopvoicechat", "/updatevoicechat", "/renewtoken", "/heartbeat")
+GET_ENDPOINTS = ("/stats", "/metrics", "/ping")
+
+metrics = Metrics.Registry()
+request_duration = metrics.histogram("rtc_aigc_request_duration_seconds", "Time from request headers parsed to response written.", ("endpoint",))
+request_count = metrics.counter("rtc_aigc_requests_total", "Requests by endpoint and response code.", ("endpoint", "code"))
+request_in_flight = metrics.gauge("rtc_aigc_requests_in_flight", "Requests being handled.", ("endpoint",))
+upstream_duration = metrics.histogram("rtc_aigc_upstream_duration_seconds", "OpenAPI call time including connection wait.", ("action",))
+upstream_count = metrics.counter("rtc_aigc_upstream_requests_total", "OpenAPI calls by action and HTTP status, 0 for network errors.", ("action", "code"))
+upstream_in_flight = metrics.gauge("rtc_aigc_upstream_in_flight", "OpenAPI calls waiting for a response.", ("action",))
+token_mint_duration = metrics.histogram("rtc_aigc_token_mint_duration_seconds", "Time to generate one rtc token.")
+tool_duration = metrics.histogram("rtc_aigc_tool_duration_seconds", "Tool handler execution time, cache hits excluded.", ("tool",))
 
 def parse_json(json_str):
     try:
@@ -32,8 +51,119 @@ def parse_json(json_str):
     except json.JSONDecodeError as e:
         return None
 
+def generate_rtc_token(room_id, user_id):
+    start = time.perf_counter()
+    expire_time = int(time.time()) + RTC_TOKEN_EXPIRE_SECONDS
+    token = AccessToken.AccessToken(RTC_APP_ID, RTC_APP_KEY, room_id, user_id)
+    token.add_privilege(AccessToken.PrivSubscribeStream, expire_time)
+    token.add_privilege(AccessToken.PrivPublishStream, expire_time)
+    token.expire_time(expire_time)
+    token_str = token.serialize()
+    token_mint_duration.observe((), time.perf_counter() - start)
+    return token_str
+
+def request_rtc_api(action, request_body_str):
+    # 所有 OpenAPI 调用都经过这里，记录每个 action 的耗时、返回码和并发数
+    canonical_query_string = "Action=%s&Version=%s" % (action, RTC_API_VERSION)
+    labels = (action,)
+    upstream_in_flight.inc(labels)
+    start = time.perf_counter()
+    try:
+        code, response = RtcApiRequester.request_rtc_api(RTC_API_HOST, "POST", "/", canonical_query_string, None, request_body_str, AK, SK)
+    finally:
+        upstream_in_flight.dec(labels)
+        upstream_duration.observe(labels, time.perf_counter() - start)
+    upstream_count.inc((action, str(code)))
+    return code, response
+
+def mint_room_info(audio_codec, room_identifier = "", uid_identifier = "", bot_identifier = ""):
+    # 根据业务情况，生成 room_id，用户id 或者 从客户端请求中获取
+    # 这里简单生成一个随机的 room_id 和 user_id
+    uuid_str = uuid.uuid4().hex
+    room_id = audio_codec + room_identifier + uuid_str # 加入aigc策略组后，根据房间id前缀配置rtc音视频传输格式
+    user_id = "user" + uid_identifier + uuid_str
+    bot_user_id = "bot" + bot_identifier + uuid_str
+    return {
+        "room_id" : room_id,
+        "uid" : user_id,
+        "app_id" : RTC_APP_ID,
+        "token" : generate_rtc_token(room_id, user_id),
+        "task_id" : uuid_str,
+        "bot_uid" : bot_user_id
+    }
+
+def rtc_api_error(code, response):
+    # OpenAPI 调用成功返回 None，否则返回错误信息；响应不是 json 或缺少字段时按状态码说明
+    if code == RESPONSE_CODE_SUCCESS and isinstance(response, dict) and response.get("Result") == "ok":
+        return None
+    try:
+        return response["ResponseMetadata"]["Error"]["Message"]
+    except (KeyError, TypeError):
+        return "request rtc api response code " + str(code)
+
+def request_stop_voice_chat(app_id, room_id, task_id):
+    # 参考 https://www.volcengine.com/docs/6348/1404672
+    request_body = {
+        "AppId" : app_id,      # rtc app id
+        "RoomId" : room_id,    # rtc 房间 id
+        "TaskId" : task_id     # rtc 客户端用户id
+    }
+
+    request_body_str = json.dumps(request_body)
+    code, response = request_rtc_api(RTC_API_STOP_VOICE_CHAT_ACTION, request_body_str)
+    print("request_rtc_api stop code:", code)
+    print("request_rtc_api stop response:", response)
+    return rtc_api_error(code, response)
+
+def request_function_result(app_id, room_id, task_id, tool_call_id, content):
+    # 参考 https://www.volcengine.com/docs/6348/1359441
+    request_body = {
+        "AppId" : app_id,
+        "RoomId" : room_id,
+        "TaskId" : task_id,
+        "Command" : "Function",
+        "Message" : json.dumps({
+            "ToolCallID" : tool_call_id,
+            "Content" : content
+        })
+    }
+    code, response = request_rtc_api(RTC_API_UPDATE_VOICE_CHAT_ACTION, json.dumps(request_body))
+    return rtc_api_error(code, response)
+
+def device_identity(json_obj):
+    # 设备 id 优先，旧固件没有 device_id 时用 uid_identifier 区分设备
+    return str(json_obj.get("device_id") or json_obj.get("uid_identifier", ""))
+
+def is_quota_error(code, response):
+    # OpenAPI 的配额、并发或频率超限
+    if code == RESPONSE_CODE_TOO_MANY_REQUESTS:
+        return True
+    try:
+        error_code = str(response["ResponseMetadata"]["Error"]["Code"]).lower()
+    except (KeyError, TypeError):
+        return False
+    return any(keyword in error_code for keyword in ADMISSION_QUOTA_ERROR_KEYWORDS)
+
+def get_current_weather(arguments):
+    # 下面代码只是示例，要根据实际情况查询天气服务
+    location = arguments.get("location", "")
+    return location + "今天天气很好，阳光明媚，偶尔有微风。"
+
+room_pool = RoomPool.RoomPool(mint_room_info, [(codec, "") for codec in AUDIO_CODECS], ROOM_POOL_SIZE, ROOM_POOL_MAX_AGE, ROOM_POOL_MAX_PREFIXES)
+session_registry = SessionRegistry.SessionRegistry(request_stop_voice_chat, SESSION_IDLE_TIMEOUT, SESSION_LEGACY_IDLE_TIMEOUT,
+                                                   SESSION_REAP_INTERVAL, SESSION_REAPER_WORKERS)
+admission = Admission.Admission(ADMISSION_START_RATE, ADMISSION_START_BURST, ADMISSION_MAX_WAITERS, ADMISSION_MAX_WAIT,
+                                ADMISSION_QUOTA_COOLDOWN)
+tool_executor = ToolExecutor.ToolExecutor(request_function_result, TOOL_WORKERS, TOOL_TIMEOUT, TOOL_MAX_PENDING, TOOL_LATENCY_SAMPLES,
+                                          lambda name, seconds : tool_duration.observe((name,), seconds))
+# 在这里注册业务的工具，名字和 StartVoiceChat 的 fc_tools 中的函数名一致
+tool_executor.register("get_current_weather", get_current_weather, cache_ttl = TOOL_WEATHER_CACHE_TTL)
+
 class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
     '''
+    每个设备连接由单独的线程处理，HTTP/1.1 保持连接，同一设备后续的请求不需要重新建连。
+    空闲超过 SERVER_KEEP_ALIVE_TIMEOUT 的连接由服务端关闭
+
     StartVoiceChat
     curl --location 'http://127.0.0.1:8080/startvoicechat' \
     --header 'Content-Type: application/json' \
@@ -42,6 +172,23 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         "end_point_id": "ep-20240729172503-mmg9b",
         "voice_type": "zh_female_meilinvyou_moon_bigtts"
     }'
+    启动过于集中或 OpenAPI 配额超限时返回 429，Retry-After 头和 retry_after 字段为建议的重试时间（秒）：
+    {"code": 429, "msg": "too many voice chat starts, retry later.", "retry_after": 3}
+
+
+    ResumeVoiceChat
+    设备重启或断网后调用，参数和 StartVoiceChat 相同，另外带上上一个会话的 task_id 和 room_id，找回还在进行的会话，
+    返回原来的房间、用户和新 token，data 中 resumed 为 true；没有可恢复的会话时启动新会话，resumed 为 false
+    curl --location 'http://127.0.0.1:8080/resumevoicechat' \
+    --header 'Content-Type: application/json' \
+    --header 'Authorization: af78e30${RTC_APP_ID}' \
+    --data '{
+        "audio_codec": "OPUS",
+        "room_identifier": "OPUSLOW",
+        "device_id" : "7CDFA1E2F3A4",
+        "room_id": "OPUSLOWbf410694b3a34a3aa980b6e85613200d",
+        "task_id" : "bf410694b3a34a3aa980b6e85613200d"
+    }'
 
 
     StopVoiceChat
@@ -67,7 +214,19 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         "command": "interrupt"
     }'
 
-    处理 function calling
+    服务端执行 function calling，message 为设备收到的 "tool" 消息，结果由服务端传回智能体
+    curl --location 'http://127.0.0.1:8080/updatevoicechat' \
+    --header 'Content-Type: application/json' \
+    --header 'Authorization: af78e30${RTC_APP_ID}' \
+    --data '{
+        "app_id": "******",
+        "room_id": "bf410694b3a34a3aa980b6e85613200d",
+        "task_id" : "bf410694b3a34a3aa980b6e85613200d",
+        "command": "function",
+        "message": "{\"tool_calls\":[{\"id\":\"call_cx\",\"type\":\"function\",\"function\":{\"name\":\"get_current_weather\",\"arguments\":\"{\\\"location\\\":\\\"上海\\\"}\"}}]}"
+    }'
+
+    处理 function calling，设备自己执行工具后传回结果
     curl --location 'http://127.0.0.1:8080/updatevoicechat' \
     --header 'Content-Type: application/json' \
     --header 'Authorization: hehehe' \
@@ -79,34 +238,178 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         "message": "{\"ToolCallID\":\"call_cx\",\"Content\":\"上海天气是台风\"}"
     }'
 
+
+    Stats
+    预生成房间池的命中率和生成耗时
+    curl --location 'http://127.0.0.1:8080/stats' \
+    --header 'Authorization: af78e30${RTC_APP_ID}'
+
+
+    Metrics
+    各接口和 OpenAPI action 的耗时直方图、按返回码的计数和并发数，Prometheus 文本格式
+    curl --location 'http://127.0.0.1:8080/metrics' \
+    --header 'Authorization: af78e30${RTC_APP_ID}'
+
+
+    Ping
+    设备联网后预先建立连接，之后的请求复用这个连接，不需要鉴权
+    curl --location 'http://127.0.0.1:8080/ping'
+
+
+    Heartbeat
+    会话进行中定期调用，服务端据此回收设备没有停止的会话
+    curl --location 'http://127.0.0.1:8080/heartbeat' \
+    --header 'Content-Type: application/json' \
+    --header 'Authorization: af78e30${RTC_APP_ID}' \
+    --data '{
+        "app_id": "******",
+        "room_id": "G711Abf410694b3a34a3aa980b6e85613200d",
+        "task_id" : "bf410694b3a34a3aa980b6e85613200d",
+        "device_id" : "7CDFA1E2F3A4"
+    }'
+
+
+    RenewToken
+    为同一房间、同一用户重新生成 token，不会重新启动智能体；只对会话表中进行中的会话有效
+    curl --location 'http://127.0.0.1:8080/renewtoken' \
+    --header 'Content-Type: application/json' \
+    --header 'Authorization: af78e30${RTC_APP_ID}' \
+    --data '{
+        "app_id": "******",
+        "room_id": "G711Abf410694b3a34a3aa980b6e85613200d",
+        "uid" : "userbf410694b3a34a3aa980b6e85613200d",
+        "task_id" : "bf410694b3a34a3aa980b6e85613200d"
+    }'
+
     '''
+    protocol_version = "HTTP/1.1"
+    timeout = SERVER_KEEP_ALIVE_TIMEOUT
 
     def do_POST(self):
+        self.begin_metrics(self.path if self.path in POST_ENDPOINTS else "other")
+        try:
+            self.handle_post()
+        finally:
+            self.end_metrics()
+
+    def do_GET(self):
+        self.begin_metrics(self.path if self.path in GET_ENDPOINTS else "other")
+        try:
+            self.handle_get()
+        finally:
+            self.end_metrics()
+
+    def begin_metrics(self, endpoint):
+        self.metrics_endpoint = endpoint
+        self.metrics_start = time.perf_counter()
+        self.response_code = 0
+        request_in_flight.inc((endpoint,))
+
+    def end_metrics(self):
+        labels = (self.metrics_endpoint,)
+        request_in_flight.dec(labels)
+        request_duration.observe(labels, time.perf_counter() - self.metrics_start)
+        request_count.inc((self.metrics_endpoint, str(self.response_code)))
+
+    def handle_post(self):
         json_obj = self.parse_post_data()
         if json_obj == None:
             return
         
         if self.path == "/startvoicechat":
             self.start_voice_chat(json_obj)
+        elif self.path == "/resumevoicechat":
+            self.resume_voice_chat(json_obj)
         elif self.path == "/stopvoicechat":
             self.stop_voice_chat(json_obj)
         elif self.path == "/updatevoicechat":
             self.update_voice_chat(json_obj)
+        elif self.path == "/renewtoken":
+            self.renew_token(json_obj)
+        elif self.path == "/heartbeat":
+            self.heartbeat(json_obj)
         else:
             self.response_data(404, "path error, unknown path: " + self.path)
             return
 
+    def handle_get(self):
+        if self.path not in GET_ENDPOINTS:
+            self.response_data(404, "path error, unknown path: " + self.path)
+            return
+        if self.path == "/ping":
+            # 设备联网后用来预先建立连接，不需要鉴权
+            self.response_data(RESPONSE_CODE_SUCCESS, "")
+            return
+        if self.headers.get("Authorization") != ("af78e30" + RTC_APP_ID):
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "header Authorization error, Bad Authorization.")
+            return
+        if self.path == "/metrics":
+            self.response_text(RESPONSE_CODE_SUCCESS, metrics.render())
+            return
+        resp_obj = {
+            "data" : {
+                "room_pool" : room_pool.stats(),
+                "sessions" : session_registry.stats(),
+                "tools" : tool_executor.stats(),
+                "admission" : admission.stats()
+            }
+        }
+        self.response_data(RESPONSE_CODE_SUCCESS, "", resp_obj)
+
 ###################################### start voice chat ######################################
-    def start_voice_chat(self, json_obj):
+    def start_voice_chat(self, json_obj, resume = False):
+        # 在取房间信息之前做准入，被拒绝的请求不消耗预生成的房间
+        retry_after = admission.acquire()
+        if retry_after > 0:
+            self.response_retry_after(retry_after)
+            return
         room_info = self.generate_rtc_room_info(json_obj)
-        ret = self.request_start_voice_chat(room_info, json_obj)
+        ret, quota_exceeded = self.request_start_voice_chat(room_info, json_obj)
         if ret == None:
+            # 同一设备的上一个会话由 session_registry 在后台停止
+            session_registry.started(room_info["app_id"], room_info["room_id"], room_info["task_id"], device_identity(json_obj),
+                                     room_info["uid"], room_info["bot_uid"], time.perf_counter() - self.metrics_start)
             resp_obj = {
                 "data" : room_info
             }
+            if resume:
+                resp_obj["data"] = dict(room_info, resumed = False)
             self.response_data(RESPONSE_CODE_SUCCESS, "", resp_obj)
+        elif quota_exceeded:
+            # 本次请求遇到配额超限，让设备稍后重试；其他错误（例如参数错误）重试也不会成功，按 500 返回
+            self.response_retry_after(max(admission.blocked_for(), 1), ret)
         else:
             self.response_data(RESPONSE_CODE_SERVER_ERROR, ret)
+
+    def resume_voice_chat(self, json_obj):
+        # 设备重启或断网后调用，参数和 startvoicechat 相同，另外带上上一个会话的 task_id 和 room_id。
+        # 会话还在时返回原来的房间、用户和新 token，设备重新进房后智能体和对话上下文都还在，
+        # 也不需要再调用 StartVoiceChat；否则按 startvoicechat 启动新会话
+        # 只凭 device_id（STA MAC）或 uid_identifier 不能恢复，否则知道这些的人都可以接管别的设备的对话
+        audio_codec = json_obj.get("audio_codec", "G711A")
+        if audio_codec not in AUDIO_CODECS:
+            audio_codec = "G711A"
+        session = session_registry.resume(str(json_obj.get("task_id", "")), str(json_obj.get("room_id", "")),
+                                          str(json_obj.get("device_id", "")), audio_codec + json_obj.get("room_identifier", ""))
+        if session == None:
+            self.start_voice_chat(json_obj, resume = True)
+            return
+        resp_obj = {
+            "data" : {
+                "room_id" : session.room_id,
+                "uid" : session.uid,
+                "app_id" : session.app_id,
+                "token" : generate_rtc_token(session.room_id, session.uid),
+                "task_id" : session.task_id,
+                "bot_uid" : session.bot_uid,
+                "resumed" : True
+            }
+        }
+        session_registry.resumed(time.perf_counter() - self.metrics_start)
+        self.response_data(RESPONSE_CODE_SUCCESS, "", resp_obj)
+
+    def response_retry_after(self, retry_after, msg = "too many voice chat starts, retry later."):
+        self.response_data(RESPONSE_CODE_TOO_MANY_REQUESTS, msg, {"retry_after" : retry_after}, {"Retry-After" : str(retry_after)})
     
     def generate_rtc_room_info(self, json_obj):
         # 音频编码格式
@@ -114,7 +417,7 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         if "audio_codec" in json_obj:
             audio_codec = json_obj["audio_codec"]
 
-        if audio_codec not in {"OPUS", "G711A", "G722", "AAC"}:
+        if audio_codec not in AUDIO_CODECS:
             audio_codec = "G711A"
         
         room_identifier = ""
@@ -129,30 +432,14 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         if "bot_identifier" in json_obj:
             bot_identifier = json_obj["bot_identifier"]
         
-        # 根据业务情况，生成 room_id，用户id 或者 从客户端请求中获取
-        # 这里简单生成一个随机的 room_id 和 user_id
-        uuid_str = uuid.uuid4().hex
-        room_id = audio_codec + room_identifier + uuid_str # 加入aigc策略组后，根据房间id前缀配置rtc音视频传输格式
-        user_id = "user" + uid_identifier + uuid_str
-        bot_user_id = "bot" + bot_identifier + uuid_str
-        expire_time = int(time.time()) + 3600 * 48 # rtc token 48h
-        token = AccessToken.AccessToken(RTC_APP_ID, RTC_APP_KEY, room_id, user_id)
-        token.add_privilege(AccessToken.PrivSubscribeStream, expire_time)
-        token.add_privilege(AccessToken.PrivPublishStream, expire_time)
-        token.expire_time(expire_time)
-
-        token_str = token.serialize()
-        room_info = {
-            "room_id" : room_id,
-            "uid" : user_id,
-            "app_id" : RTC_APP_ID,
-            "token" : token_str,
-            "task_id" : uuid_str,
-            "bot_uid" : bot_user_id
-        }
+        # 没有自定义用户标识时按房间前缀从预生成的池中取，例如设备 OPUS 编码时带 room_identifier OPUSLOW
+        if uid_identifier == "" and bot_identifier == "":
+            room_info = room_pool.take((audio_codec, room_identifier))
+        else:
+            room_info = room_pool.mint((audio_codec, room_identifier, uid_identifier, bot_identifier))
         print(room_info)
         return room_info
-    
+
     def request_start_voice_chat(self, room_info, json_obj):
         # request_body 内容含义请参考 https://www.volcengine.com/docs/6348/1404673
         # 小模型 ASR，速度相对大模型 ASR 更快一些，识别精度低于大模型 ASR
@@ -412,21 +699,14 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
             request_body["Config"]["LLMConfig"]["Tools"] = fc_tools
 
         request_body_str = json.dumps(request_body)
-        canonical_query_string = "Action=%s&Version=%s" % (RTC_API_START_VOICE_CHAT_ACTION, RTC_API_VERSION)
-        code, response = RtcApiRequester.request_rtc_api(RTC_API_HOST, "POST", "/", canonical_query_string, None, request_body_str, AK, SK)
+        code, response = request_rtc_api(RTC_API_START_VOICE_CHAT_ACTION, request_body_str)
         print("request_rtc_api start code:", code)
         print("request_rtc_api start response:", response)
-        if code == RESPONSE_CODE_SUCCESS:
-            if "Result" in response and response["Result"] == "ok":
-                return None
-            else:
-                return response["ResponseMetadata"]["Error"]["Message"]
-        else:
-            if response != None:
-                return response["ResponseMetadata"]["Error"]["Message"]
-            else:
-                return "request rtc api response code " + str(code)
-        return None
+        # 返回错误信息和是否为配额超限
+        quota_exceeded = is_quota_error(code, response)
+        if quota_exceeded:
+            admission.on_quota_exceeded()
+        return rtc_api_error(code, response), quota_exceeded
 
 ###################################### stop voice chat #######################################
     def stop_voice_chat(self, json_obj):
@@ -445,29 +725,9 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
             self.response_data(RESPONSE_CODE_SERVER_ERROR, ret)
     
     def request_stop_voice_chat(self, json_obj):
-        # 参考 https://www.volcengine.com/docs/6348/1404672
-        request_body = {
-            "AppId" : json_obj["app_id"],      # rtc app id
-            "RoomId" : json_obj["room_id"],    # rtc 房间 id
-            "TaskId" : json_obj["task_id"]     # rtc 客户端用户id
-        }
-
-        request_body_str = json.dumps(request_body)
-        canonical_query_string = "Action=%s&Version=%s" % (RTC_API_STOP_VOICE_CHAT_ACTION, RTC_API_VERSION)
-        code, response = RtcApiRequester.request_rtc_api(RTC_API_HOST, "POST", "/", canonical_query_string, None, request_body_str, AK, SK)
-        print("request_rtc_api stop code:", code)
-        print("request_rtc_api stop response:", response)
-        if code == RESPONSE_CODE_SUCCESS:
-            if "Result" in response and response["Result"] == "ok":
-                return None
-            else:
-                return response["ResponseMetadata"]["Error"]["Message"]
-        else:
-            if response != None:
-                return response["ResponseMetadata"]["Error"]["Message"]
-            else:
-                return "request rtc api response code " + str(code)
-        return None
+        # 设备主动停止，无论 OpenAPI 是否成功都不再由服务端回收
+        session_registry.stopped(json_obj["task_id"])
+        return request_stop_voice_chat(json_obj["app_id"], json_obj["room_id"], json_obj["task_id"])
 
 ###################################### update voice chat #####################################
     def update_voice_chat(self, json_obj):
@@ -492,6 +752,20 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
             if json_obj["interrupt_mode"] not in {1, 2, 3}:
                 self.response_data(RESPONSE_CODE_REQUEST_ERROR, "update_voice_chat: your command == " + json_obj["command"] + ", \"interrupt_mode\" must be in json, interrupt_mode == 1, 2, or 3")
                 return
+        session_registry.touch(task_id = json_obj["task_id"])
+        if json_obj["command"] == "function":
+            # 在请求 OpenAPI 之前检查，保持连接时每个请求只能有一个响应
+            message_json_obj = parse_json(json_obj["message"])
+            if message_json_obj == None:
+                self.response_data(RESPONSE_CODE_REQUEST_ERROR, "Post data is not a json string.")
+                return
+            if "tool_calls" in message_json_obj:
+                self.execute_tool_calls(json_obj, message_json_obj["tool_calls"])
+                return
+            # 设备自己执行工具后传回的结果，直接转发
+            if "ToolCallID" not in message_json_obj or "Content" not in message_json_obj:
+                self.response_data(RESPONSE_CODE_REQUEST_ERROR, "function calling message is error.")
+                return
         ret = self.request_update_voice_chat(json_obj)
         if ret == None:
             resp_obj = {
@@ -501,6 +775,47 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         else:
             self.response_data(RESPONSE_CODE_SERVER_ERROR, ret)
     
+    def execute_tool_calls(self, json_obj, tool_calls):
+        # 设备转发的 "tool" 消息，由 tool_executor 在后台执行并传回结果，这里不等待
+        # function calling 数据， 参考 https://www.volcengine.com/docs/6348/1359441
+        # 客户端传来的message数据是一个json字符串，内容如下：
+        # {
+        #     "subscriber_user_id" : "",
+        #     "tool_calls" : 
+        #     [
+        #         {
+        #             "function" : 
+        #             {
+        #                 "arguments" : "{\\"location\\": \\"\\u5317\\u4eac\\u5e02\\"}",
+        #                 "name" : "get_current_weather"
+        #             },
+        #             "id" : "call_py400kek0e3pczrqdxgnb3lo",
+        #             "type" : "function"
+        #         }
+        #     ]
+        # }
+        if not isinstance(tool_calls, list) or len(tool_calls) <= 0:
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "function calling message is error.")
+            return
+        for tool_call in tool_calls:
+            if not isinstance(tool_call, dict) or "id" not in tool_call or not isinstance(tool_call.get("function"), dict):
+                self.response_data(RESPONSE_CODE_REQUEST_ERROR, "function calling message is error.")
+                return
+        accepted = tool_executor.submit(json_obj["app_id"], json_obj["room_id"], json_obj["task_id"], tool_calls)
+        if accepted == None:
+            self.response_data(RESPONSE_CODE_SERVER_ERROR, "tool executor is busy, try again later.")
+            return
+        resp_obj = {
+            "data" : {
+                "app_id" : json_obj["app_id"],
+                "room_id" : json_obj["room_id"],
+                "task_id" : json_obj["task_id"],
+                "command" : json_obj["command"],
+                "tool_calls" : accepted
+            }
+        }
+        self.response_data(RESPONSE_CODE_SUCCESS, "", resp_obj)
+
     def request_update_voice_chat(self, json_obj):
         # 参考 https://www.volcengine.com/docs/6348/1404671
         update_commands_map = {
@@ -522,66 +837,55 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         }
         if "interrupt_mode" in json_obj:
             request_body["InterruptMode"] = json_obj["interrupt_mode"]
-        if json_obj["command"] == "function":
-            # function calling 数据， 参考 https://www.volcengine.com/docs/6348/1359441
-            # 客户端传来的message数据是一个json字符串，内容如下：
-            # {
-            #     "subscriber_user_id" : "",
-            #     "tool_calls" : 
-            #     [
-            #         {
-            #             "function" : 
-            #             {
-            #                 "arguments" : "{\\"location\\": \\"\\u5317\\u4eac\\u5e02\\"}",
-            #                 "name" : "get_current_weather"
-            #             },
-            #             "id" : "call_py400kek0e3pczrqdxgnb3lo",
-            #             "type" : "function"
-            #         }
-            #     ]
-            # }
-            
-            print(json_obj["message"])
-            message_json_obj = parse_json(json_obj["message"])
-            if message_json_obj == None:
-                self.response_data(RESPONSE_CODE_REQUEST_ERROR, "Post data is not a json string.")
-                return
-            # 下面代码只是示例，要根据实际情况，解析函数名称和参数，做出真实的响应
-            if "tool_calls" not in message_json_obj or len(message_json_obj["tool_calls"]) <= 0 or "id" not in message_json_obj["tool_calls"][0]:
-                self.response_data(RESPONSE_CODE_REQUEST_ERROR, "function calling message is error.")
-                return
-            message_body = {
-                "ToolCallID" : message_json_obj["tool_calls"][0]["id"],
-                "Content" : "今天天气很好，阳光明媚，偶尔有微风。"
-            }
-            
-            request_body["Message"] = json.dumps(message_body)
-        elif "message" in json_obj:
+        if "message" in json_obj:
             request_body["Message"] = json_obj["message"]
         
         request_body_str = json.dumps(request_body)
-        canonical_query_string = "Action=%s&Version=%s" % (RTC_API_UPDATE_VOICE_CHAT_ACTION, RTC_API_VERSION)
-        code, response = RtcApiRequester.request_rtc_api(RTC_API_HOST, "POST", "/", canonical_query_string, None, request_body_str, AK, SK)
+        code, response = request_rtc_api(RTC_API_UPDATE_VOICE_CHAT_ACTION, request_body_str)
         print("request_rtc_api update code:", code)
         print("request_rtc_api update response:", response)
-        if code == RESPONSE_CODE_SUCCESS:
-            if "Result" in response and response["Result"] == "ok":
-                return None
-            else:
-                return response["ResponseMetadata"]["Error"]["Message"]
-        else:
-            if response != None:
-                return response["ResponseMetadata"]["Error"]["Message"]
-            else:
-                return "request rtc api response code " + str(code)
-        return None
+        return rtc_api_error(code, response)
+
+###################################### renew token ###########################################
+    def renew_token(self, json_obj):
+        # 客户端收到 on_token_privilege_will_expire 后请求新 token，再调用 byte_rtc_renew_token，不需要退房重进
+        if "room_id" not in json_obj or "uid" not in json_obj or "app_id" not in json_obj:
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "renew_token: \"room_id\", \"uid\", \"app_id\" must be in json")
+            return
+        if json_obj["app_id"] != RTC_APP_ID:
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "renew_token: app_id mismatch")
+            return
+
+        # 只为表中进行中的会话、并且是这个会话的用户生成 token，不能用来进入其它设备的房间
+        if not session_registry.owns(json_obj["room_id"], json_obj.get("task_id", ""), json_obj["uid"]):
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "renew_token: no active session for room_id and uid")
+            return
+        token_str = generate_rtc_token(json_obj["room_id"], json_obj["uid"])
+        resp_obj = {
+            "data" : {
+                "room_id" : json_obj["room_id"],
+                "uid" : json_obj["uid"],
+                "token" : token_str
+            }
+        }
+        self.response_data(RESPONSE_CODE_SUCCESS, "", resp_obj)
+
+
+###################################### heartbeat #############################################
+    def heartbeat(self, json_obj):
+        # 会话进行中设备定期调用，超过 SESSION_IDLE_TIMEOUT 没有请求的会话由服务端停止
+        if "room_id" not in json_obj or "task_id" not in json_obj or "app_id" not in json_obj:
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "heartbeat: \"room_id\", \"task_id\", \"app_id\" must be in json")
+            return
+        if json_obj["app_id"] != RTC_APP_ID:
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "heartbeat: app_id mismatch")
+            return
+        session_registry.heartbeat(json_obj["app_id"], json_obj["room_id"], json_obj["task_id"], device_identity(json_obj))
+        self.response_data(RESPONSE_CODE_SUCCESS, "", {"data" : {"task_id" : json_obj["task_id"]}})
 
 
 ##############################################################################################
-    def response_data(self, code, msg, extra_data = None):
-        self.send_response(code)
-        self.send_header('Content-type', 'application/json')
-        self.end_headers()
+    def response_data(self, code, msg, extra_data = None, headers = None):
         ret_data = {
             "code": code,
             "msg" : msg
@@ -590,15 +894,46 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         if extra_data != None:
             for k, v in extra_data.items():
                 ret_data[k] = v
-        self.wfile.write(json.dumps(ret_data).encode())
+        # 请求使用 TLV 编码时响应也用 TLV
+        if self.headers.get("Content-Type") == ControlTlv.CONTENT_TYPE:
+            content_type = ControlTlv.CONTENT_TYPE
+            body = ControlTlv.encode(ret_data)
+        else:
+            content_type = "application/json"
+            body = json.dumps(ret_data).encode()
+        self.send_body(code, content_type, body, headers)
+
+    def response_text(self, code, text):
+        # Prometheus 文本格式
+        self.send_body(code, "text/plain; version=0.0.4; charset=utf-8", text.encode("utf-8"))
+
+    def send_body(self, code, content_type, body, headers = None):
+        self.response_code = code
+        # 保持连接时设备按 Content-Length 读取响应
+        self.send_response(code)
+        self.send_header('Content-type', content_type)
+        self.send_header('Content-Length', str(len(body)))
+        if headers != None:
+            for k, v in headers.items():
+                self.send_header(k, v)
+        self.end_headers()
+        self.wfile.write(body)
 
 
     def parse_post_data(self):
+        # 先读完请求体，出错返回后连接上的下一个请求才能正确解析
+        content_length = self.headers.get("Content-Length")
+        if content_length == None or not content_length.isdigit():
+            self.close_connection = True
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "header Content-Length error, must be set.")
+            return None
+        post_data = self.rfile.read(int(content_length))
+
         # check headers
         content_type = self.headers.get("Content-Type")
         authorization = self.headers.get("Authorization")
-        if content_type != "application/json":
-            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "header Content-Type error, must be application/json.")
+        if content_type != "application/json" and content_type != ControlTlv.CONTENT_TYPE:
+            self.response_data(RESPONSE_CODE_REQUEST_ERROR, "header Content-Type error, must be application/json or " + ControlTlv.CONTENT_TYPE + ".")
             return None
         if authorization == None or authorization == "":
             self.response_data(RESPONSE_CODE_REQUEST_ERROR, "header Authorization error, Authorization not be set.")
@@ -607,12 +942,17 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
             self.response_data(RESPONSE_CODE_REQUEST_ERROR, "header Authorization error, Bad Authorization.")
             return None
         
+        if content_type == ControlTlv.CONTENT_TYPE:
+            try:
+                return ControlTlv.decode(post_data)
+            except ValueError as e:
+                self.response_data(RESPONSE_CODE_REQUEST_ERROR, "post data is not valid tlv: " + str(e))
+                return None
+
         # check post_data is json
-        content_length = int(self.headers['Content-Length'])
-        post_data = self.rfile.read(content_length).decode('utf-8')
         json_obj = None
         try:
-            json_obj = json.loads(post_data)
+            json_obj = json.loads(post_data.decode('utf-8'))
         except Exception as e:
             self.response_data(RESPONSE_CODE_REQUEST_ERROR, "post data is not json string.")
             return None
@@ -620,7 +960,12 @@ class RtcAigcHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
 
 
 
+class RtcAigcHTTPServer(http.server.ThreadingHTTPServer):
+    # 默认的 accept 队列只有 5，集中上电时多出的连接会被拒绝或等 SYN 重传
+    request_queue_size = SERVER_LISTEN_BACKLOG
+
+
 # 启动服务
-with socketserver.TCPServer(("", PORT), RtcAigcHTTPRequestHandler) as httpd:
+with RtcAigcHTTPServer(("", PORT), RtcAigcHTTPRequestHandler) as httpd:
     print("serving at port", PORT)
     httpd.serve_forever()
@@ -5,6 +5,14 @@ import datetime
 import hashlib
 import hmac
 import requests
+import requests.adapters
+
+from RtcAigcConfig import RTC_API_SCHEME, RTC_API_POOL_SIZE, RTC_API_TIMEOUT
+
+# 所有请求共用一个 session，复用到 OpenAPI 的 HTTPS 连接，不用每次重新解析域名和握手。
+# 只重试建立连接失败的情况，StartVoiceChat 等请求不是幂等的，发出后失败不重试
+_session = requests.Session()
+_session.mount(RTC_API_SCHEME + "://", requests.adapters.HTTPAdapter(pool_connections=1, pool_maxsize=RTC_API_POOL_SIZE, pool_block=True, max_retries=1))
 
 def hash_sha256(content):
     return hashlib.sha256(content.encode("utf-8")).hexdigest()
@@ -48,7 +56,7 @@ def request_rtc_api(http_host, http_request_method, canonical_uri, canonical_que
     # 步骤5：发起http请求
     if canonical_uri == "/":
         canonical_uri = ""
-    url = 'https://' + http_host + canonical_uri + "?" + canonical_query_string
+    url = RTC_API_SCHEME + '://' + http_host + canonical_uri + "?" + canonical_query_string
     headers = {
         "Content-Type" : content_type, 
         "Host" : http_host, 
@@ -60,9 +68,16 @@ def request_rtc_api(http_host, http_request_method, canonical_uri, canonical_que
     if http_headers != None:
         headers.update(http_headers)
     
-    if http_request_method == "POST":
-        response = requests.post(url, headers=headers, data=http_body)
-    else:
-        response = requests.get(url, headers=headers)
-    
-    return (response.status_code, response.json())
+    try:
+        if http_request_method == "POST":
+            response = _session.post(url, headers=headers, data=http_body, timeout=RTC_API_TIMEOUT)
+        else:
+            response = _session.get(url, headers=headers, timeout=RTC_API_TIMEOUT)
+    except requests.RequestException as e:
+        print("request_rtc_api error:", e)
+        return (0, None)
+
+    try:
+        return (response.status_code, response.json())
+    except ValueError:
+        return (response.status_code, None)
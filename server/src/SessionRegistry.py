@@ -0,0 +1,190 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# 服务端的智能体会话表，按 task_id 和设备 id 索引，记录开始时间和最近活动时间。
+# 设备断电或崩溃时不会调用 stopvoicechat，智能体会继续占用 ASR/LLM/TTS 资源，这里由后台线程替设备停止：
+# - 同一设备启动新会话时停止它的上一个会话
+# - 超过 idle_timeout 没有任何请求（包括 heartbeat）的会话；从没发过 heartbeat 的旧固件用 legacy_idle_timeout
+# 会话表只在内存中，服务重启后由设备的 heartbeat 重新登记
+# 设备重启或断网后用 resume 按上一个会话的 task_id 和 room_id 找回还在进行的会话，重新进同一个房间，智能体和对话上下文都保留
+
+import concurrent.futures
+import threading
+import time
+
+
+class Session:
+    def __init__(self, app_id, room_id, task_id, device_id, now, uid = "", bot_uid = ""):
+        self.app_id = app_id
+        self.room_id = room_id
+        self.task_id = task_id
+        self.device_id = device_id
+        # heartbeat 登记的会话没有 uid，不能恢复
+        self.uid = uid
+        self.bot_uid = bot_uid
+        self.start_time = now
+        self.last_activity = now
+        self.heartbeat = False
+
+
+class SessionRegistry:
+    def __init__(self, stop, idle_timeout, legacy_idle_timeout, reap_interval, workers):
+        # stop(app_id, room_id, task_id) 调用 StopVoiceChat，成功返回 None，失败返回错误信息
+        self._stop = stop
+        self._idle_timeout = idle_timeout
+        self._legacy_idle_timeout = legacy_idle_timeout
+        self._reap_interval = reap_interval
+        self._lock = threading.Lock()
+        self._sessions = {}
+        self._devices = {}
+        self._rooms = {}
+        self._counts = {
+            "started" : 0,
+            "stopped" : 0,
+            "adopted" : 0,
+            "reaped_idle" : 0,
+            "reaped_replaced" : 0,
+            "reap_failures" : 0,
+            "resume_hits" : 0,
+            "resume_misses" : 0
+        }
+        # 完整启动和恢复的耗时，用来估算恢复节省的时间
+        self._start_seconds = 0.0
+        self._start_timed = 0
+        self._resume_seconds = 0.0
+        self._executor = concurrent.futures.ThreadPoolExecutor(max_workers = workers, thread_name_prefix = "session_reaper")
+        self._thread = threading.Thread(target = self._reap_loop, name = "session_reaper", daemon = True)
+        self._thread.start()
+
+    # adopted 为 heartbeat 登记的会话：请求方无法证明会话是自己的，只在房间和设备还没有会话时建立索引，
+    # 不能顶掉已有的会话，否则知道设备 MAC 的人用一个假的 task_id 就能停止设备正在进行的对话
+    def _add(self, session, adopted = False):
+        self._sessions[session.task_id] = session
+        if not adopted or self._rooms.get(session.room_id) not in self._sessions:
+            self._rooms[session.room_id] = session.task_id
+        replaced = None
+        if session.device_id != "":
+            previous = self._devices.get(session.device_id)
+            if previous != None and previous != session.task_id and previous in self._sessions:
+                if adopted:
+                    return None
+                replaced = self._remove(previous)
+            self._devices[session.device_id] = session.task_id
+        return replaced
+
+    def _remove(self, task_id):
+        session = self._sessions.pop(task_id, None)
+        if session == None:
+            return None
+        if self._rooms.get(session.room_id) == task_id:
+            self._rooms.pop(session.room_id)
+        if self._devices.get(session.device_id) == task_id:
+            self._devices.pop(session.device_id)
+        return session
+
+    def started(self, app_id, room_id, task_id, device_id, uid = "", bot_uid = "", elapsed = None):
+        with self._lock:
+            self._counts["started"] += 1
+            if elapsed != None:
+                self._start_seconds += elapsed
+                self._start_timed += 1
+            replaced = self._add(Session(app_id, room_id, task_id, device_id, time.monotonic(), uid, bot_uid))
+        if replaced != None:
+            self._reap(replaced, "reaped_replaced")
+
+    # 返回设备还在进行的会话。设备需要给出启动时拿到的 task_id 和 room_id 证明会话是自己的，带 device_id 时也要一致；
+    # room_prefix 为编码格式和房间前缀，不一致时（例如设备换了编码格式）不恢复
+    def resume(self, task_id, room_id, device_id, room_prefix):
+        with self._lock:
+            session = self._sessions.get(task_id) if task_id != "" else None
+            if session == None or session.uid == "" or session.room_id != room_id or \
+               (device_id != "" and session.device_id != device_id) or not session.room_id.startswith(room_prefix):
+                self._counts["resume_misses"] += 1
+                return None
+            self._counts["resume_hits"] += 1
+            session.last_activity = time.monotonic()
+            return session
+
+    def resumed(self, elapsed):
+        with self._lock:
+            self._resume_seconds += elapsed
+
+    def stopped(self, task_id):
+        with self._lock:
+            if self._remove(task_id) != None:
+                self._counts["stopped"] += 1
+
+    # 设备的请求都算活动，返回会话是否在表中
+    def touch(self, task_id = None, room_id = None):
+        with self._lock:
+            if task_id == None:
+                task_id = self._rooms.get(room_id)
+            session = self._sessions.get(task_id)
+            if session == None:
+                return False
+            session.last_activity = time.monotonic()
+            return True
+
+    # 会话在表中且 uid 一致时返回 True 并记为活动，用来确认请求方是这个会话的设备；
+    # task_id 为空时按 room_id 查找。heartbeat 登记的会话没有 uid，不通过
+    def owns(self, room_id, task_id, uid):
+        with self._lock:
+            session = self._sessions.get(task_id if task_id != "" else self._rooms.get(room_id))
+            if session == None or session.room_id != room_id or session.uid == "" or session.uid != uid:
+                return False
+            session.last_activity = time.monotonic()
+            return True
+
+    def heartbeat(self, app_id, room_id, task_id, device_id):
+        with self._lock:
+            session = self._sessions.get(task_id)
+            if session != None:
+                session.last_activity = time.monotonic()
+                session.heartbeat = True
+                return
+            # 服务重启后表是空的，按 heartbeat 重新登记；设备已经有会话时不替换
+            session = Session(app_id, room_id, task_id, device_id, time.monotonic())
+            session.heartbeat = True
+            self._counts["adopted"] += 1
+            self._add(session, adopted = True)
+
+    def stats(self):
+        with self._lock:
+            stats = dict(self._counts)
+            stats["active"] = len(self._sessions)
+            stats["devices"] = len(self._devices)
+            resumes = self._counts["resume_hits"] + self._counts["resume_misses"]
+            hits = self._counts["resume_hits"]
+            start_ms = self._start_seconds * 1000 / self._start_timed if self._start_timed > 0 else 0.0
+            resume_ms = self._resume_seconds * 1000 / hits if hits > 0 else 0.0
+            stats["resume_hit_rate"] = round(hits / resumes, 3) if resumes > 0 else 0.0
+            stats["start_ms_avg"] = round(start_ms, 1)
+            stats["resume_ms_avg"] = round(resume_ms, 1)
+            # 每次恢复按平均的完整启动耗时估算，没有完整启动的记录时为 0
+            stats["resume_saved_ms"] = round(max(0.0, start_ms - resume_ms) * hits, 1) if self._start_timed > 0 else 0.0
+            return stats
+
+    def _reap(self, session, reason):
+        self._executor.submit(self._stop_session, session, reason)
+
+    def _stop_session(self, session, reason):
+        error = self._stop(session.app_id, session.room_id, session.task_id)
+        with self._lock:
+            if error == None:
+                self._counts[reason] += 1
+            else:
+                self._counts["reap_failures"] += 1
+        print("session reaper: %s task %s device %s, %s" % (reason, session.task_id, session.device_id, error if error != None else "stopped"))
+
+    def _reap_loop(self):
+        while True:
+            time.sleep(self._reap_interval)
+            now = time.monotonic()
+            idle = []
+            with self._lock:
+                for session in list(self._sessions.values()):
+                    timeout = self._idle_timeout if session.heartbeat else self._legacy_idle_timeout
+                    if now - session.last_activity > timeout:
+                        idle.append(self._remove(session.task_id))
+            for session in idle:
+                self._reap(session, "reaped_idle")
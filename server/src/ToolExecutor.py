@@ -0,0 +1,210 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# 服务端执行 function calling：设备把收到的 "tool" 消息（tool_calls）转发过来，这里按函数名找到注册的处理函数，
+# 在线程池中执行，结果通过 UpdateVoiceChat(Function) 按 ToolCallID 传回智能体，设备的请求不等待执行结果。
+# - 每个调用有超时，超时或出错时也传回一条说明，避免智能体一直等待
+# - 幂等的工具（例如按地点查询天气）按 函数名 + 参数 缓存结果，超过 cache_ttl 后重新执行
+# - 记录每个工具最近的耗时，stats() 输出分位数
+# - 超时的处理函数无法取消，会继续占用工作线程；这样的线程占满线程池时拒绝新的调用，不让后面的调用排在它们后面一起超时
+
+import collections
+import concurrent.futures
+import json
+import threading
+import time
+
+
+class Tool:
+    def __init__(self, name, handler, timeout, cache_ttl):
+        # handler(arguments) 返回传回智能体的文本，arguments 为解析后的参数 dict
+        self.name = name
+        self.handler = handler
+        self.timeout = timeout
+        self.cache_ttl = cache_ttl
+        self.calls = 0
+        self.errors = 0
+        self.timeouts = 0
+        self.cache_hits = 0
+        self.latencies = None
+
+
+class ToolExecutor:
+    def __init__(self, post_result, workers, timeout, max_pending, latency_samples, observe = None):
+        # post_result(app_id, room_id, task_id, tool_call_id, content) 调用 UpdateVoiceChat，成功返回 None，失败返回错误信息
+        # observe(name, seconds) 可选，把每次执行的耗时记录到外部指标
+        self._post_result = post_result
+        self._timeout = timeout
+        self._max_pending = max_pending
+        self._latency_samples = latency_samples
+        self._observe = observe
+        self._lock = threading.Lock()
+        self._tools = {}
+        self._cache = {}
+        self._pending = 0
+        self._workers_count = workers
+        # 已经超时但还在运行的处理函数
+        self._stuck = 0
+        self._counts = {
+            "submitted" : 0,
+            "rejected" : 0,
+            "rejected_stuck" : 0,
+            "unknown" : 0,
+            "post_failures" : 0
+        }
+        # 分发线程等待处理函数的结果并传回，处理函数在单独的线程池中执行，超时后不再等待
+        self._dispatch = concurrent.futures.ThreadPoolExecutor(max_workers = workers, thread_name_prefix = "tool_dispatch")
+        self._workers = concurrent.futures.ThreadPoolExecutor(max_workers = workers, thread_name_prefix = "tool_worker")
+
+    def register(self, name, handler, timeout = None, cache_ttl = 0):
+        tool = Tool(name, handler, timeout if timeout != None else self._timeout, cache_ttl)
+        tool.latencies = collections.deque(maxlen = self._latency_samples)
+        with self._lock:
+            self._tools[name] = tool
+
+    # tool_calls 为设备转发的 "tool_calls" 数组，返回接受的 ToolCallID 列表；排队的调用过多时返回 None
+    def submit(self, app_id, room_id, task_id, tool_calls):
+        with self._lock:
+            if self._stuck >= self._workers_count:
+                self._counts["rejected_stuck"] += len(tool_calls)
+                return None
+            if self._pending + len(tool_calls) > self._max_pending:
+                self._counts["rejected"] += len(tool_calls)
+                return None
+            self._pending += len(tool_calls)
+            self._counts["submitted"] += len(tool_calls)
+        accepted = []
+        for tool_call in tool_calls:
+            self._dispatch.submit(self._run, app_id, room_id, task_id, tool_call)
+            accepted.append(tool_call.get("id", ""))
+        return accepted
+
+    def _run(self, app_id, room_id, task_id, tool_call):
+        # 没有人读取分发线程的 future，异常在这里记录，否则会被丢掉
+        try:
+            content = self._execute(tool_call)
+            try:
+                error = self._post_result(app_id, room_id, task_id, tool_call.get("id", ""), content)
+            except Exception as e:
+                error = repr(e)
+            if error != None:
+                with self._lock:
+                    self._counts["post_failures"] += 1
+                print("tool executor: post result of %s failed, %s" % (tool_call.get("id", ""), error))
+        except Exception as e:
+            print("tool executor: tool call %s failed, %r" % (tool_call.get("id", ""), e))
+        finally:
+            with self._lock:
+                self._pending -= 1
+
+    def _execute(self, tool_call):
+        function = tool_call.get("function", {})
+        name = function.get("name", "")
+        with self._lock:
+            tool = self._tools.get(name)
+            if tool == None:
+                self._counts["unknown"] += 1
+        if tool == None:
+            return "工具 %s 不存在" % name
+        try:
+            arguments = json.loads(function.get("arguments") or "{}")
+        except ValueError:
+            arguments = None
+        if not isinstance(arguments, dict):
+            with self._lock:
+                tool.calls += 1
+                tool.errors += 1
+            return "工具 %s 的参数不是 json 对象" % name
+
+        cache_key = None
+        now = time.monotonic()
+        if tool.cache_ttl > 0:
+            cache_key = (name, json.dumps(arguments, sort_keys = True, ensure_ascii = False))
+            with self._lock:
+                cached = self._cache.get(cache_key)
+                if cached != None and now - cached[0] < tool.cache_ttl:
+                    tool.calls += 1
+                    tool.cache_hits += 1
+                    return cached[1]
+
+        with self._lock:
+            stuck = self._stuck >= self._workers_count
+            if stuck:
+                tool.calls += 1
+                tool.errors += 1
+        if stuck:
+            # 工作线程都被超时的处理函数占着，提交后也只会排队超时
+            return "工具 %s 暂时不可用" % name
+
+        start = time.perf_counter()
+        future = self._workers.submit(tool.handler, arguments)
+        timed_out = False
+        failed = False
+        try:
+            content = str(future.result(timeout = tool.timeout))
+        except concurrent.futures.TimeoutError:
+            timed_out = True
+            content = "工具 %s 执行超时" % name
+            # 还在排队的直接取消；已经在运行的无法取消，返回之前一直占用工作线程
+            if not future.cancel():
+                with self._lock:
+                    self._stuck += 1
+                future.add_done_callback(self._unstick)
+        except Exception as e:
+            failed = True
+            content = "工具 %s 执行失败" % name
+            print("tool executor: %s raised %r" % (name, e))
+        elapsed = time.perf_counter() - start
+        with self._lock:
+            tool.calls += 1
+            tool.latencies.append(elapsed)
+            if timed_out:
+                tool.timeouts += 1
+            elif failed:
+                tool.errors += 1
+            elif cache_key != None:
+                self._cache[cache_key] = (time.monotonic(), content)
+                self._evict(now)
+        if self._observe != None:
+            self._observe(name, elapsed)
+        return content
+
+    def _unstick(self, future):
+        with self._lock:
+            self._stuck -= 1
+
+    def _evict(self, now):
+        # 缓存超过上限时清理过期的结果，调用方持有锁
+        if len(self._cache) <= self._max_pending * 4:
+            return
+        for key, (cached_at, _) in list(self._cache.items()):
+            tool = self._tools.get(key[0])
+            if tool == None or now - cached_at >= tool.cache_ttl:
+                del self._cache[key]
+
+    def stats(self):
+        with self._lock:
+            stats = dict(self._counts)
+            stats["pending"] = self._pending
+            stats["stuck"] = self._stuck
+            stats["cached"] = len(self._cache)
+            tools = {}
+            for name, tool in self._tools.items():
+                latencies = sorted(tool.latencies)
+                tools[name] = {
+                    "calls" : tool.calls,
+                    "errors" : tool.errors,
+                    "timeouts" : tool.timeouts,
+                    "cache_hits" : tool.cache_hits,
+                    "p50_ms" : percentile_ms(latencies, 0.50),
+                    "p95_ms" : percentile_ms(latencies, 0.95),
+                    "p99_ms" : percentile_ms(latencies, 0.99)
+                }
+            stats["tools"] = tools
+            return stats
+
+
+def percentile_ms(sorted_values, fraction):
+    if len(sorted_values) == 0:
+        return 0.0
+    return round(sorted_values[min(len(sorted_values) - 1, int(len(sorted_values) * fraction))] * 1000, 3)
@@ -0,0 +1,85 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# 比较设备控制请求 json 和 TLV（../src/ControlTlv.py）两种编码的大小和编解码耗时。
+# 请求按设备 cJSON_PrintPreallocated(不格式化) 的输出计算，响应按服务端 json.dumps 的输出计算，
+# token 用 AccessToken 真实生成。耗时为本机 Python 的结果，设备上的耗时见 RTC_BOT_UTILS 日志
+#
+#   python3 ControlCodecBench.py [--iterations 20000]
+
+import argparse
+import json
+import os
+import sys
+import time
+import uuid
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src"))
+sys.dont_write_bytecode = True
+
+import AccessToken
+import ControlTlv
+
+def sample_messages():
+    uuid_str = uuid.uuid4().hex
+    app_id = "67582ac8" + uuid_str[:16]
+    room_id = "OPUSOPUSLOW" + uuid_str
+    user_id = "user" + uuid_str
+    token = AccessToken.AccessToken(app_id, uuid_str, room_id, user_id)
+    expire_time = int(time.time()) + 3600 * 48
+    token.add_privilege(AccessToken.PrivSubscribeStream, expire_time)
+    token.add_privilege(AccessToken.PrivPublishStream, expire_time)
+    token.expire_time(expire_time)
+    task = {
+        "app_id" : app_id,
+        "room_id" : room_id,
+        "task_id" : uuid_str
+    }
+    room_info = dict(task, uid = user_id, bot_uid = "bot" + uuid_str, token = token.serialize())
+    start_request = {
+        "audio_codec" : "OPUS",
+        "room_identifier" : "OPUSLOW",
+        "enable_burst" : False,
+        "burst_buffer_size" : 500,
+        "burst_interval" : 20,
+        "device_id" : "7CDFA1E2F3A4"
+    }
+    update_request = dict(task, command = "interrupt")
+    return [
+        ("/startvoicechat", start_request, {"code" : 200, "msg" : "", "data" : room_info}),
+        ("/updatevoicechat", update_request, {"code" : 200, "msg" : "", "data" : update_request}),
+        ("/stopvoicechat", task, {"code" : 200, "msg" : "", "data" : task}),
+        ("/heartbeat", dict(task, device_id = "7CDFA1E2F3A4"), {"code" : 200, "msg" : "", "data" : {"task_id" : task["task_id"]}})
+    ]
+
+def time_us(func, arg, iterations):
+    start = time.perf_counter()
+    for _ in range(iterations):
+        func(arg)
+    return (time.perf_counter() - start) * 1e6 / iterations
+
+def main():
+    parser = argparse.ArgumentParser(description = "compare json and tlv encoding of device control requests")
+    parser.add_argument("--iterations", type = int, default = 20000)
+    args = parser.parse_args()
+
+    print("%-18s %8s %8s %8s %8s %10s %10s %10s %10s" % ("endpoint", "req_json", "req_tlv", "rsp_json", "rsp_tlv",
+          "json_enc", "tlv_enc", "json_dec", "tlv_dec"))
+    for endpoint, request, response in sample_messages():
+        request_json = json.dumps(request, separators = (",", ":")).encode()
+        request_tlv = ControlTlv.encode(request)
+        response_json = json.dumps(response).encode()
+        response_tlv = ControlTlv.encode(response)
+        # 编解码前后要一致
+        assert ControlTlv.decode(request_tlv) == request
+        assert ControlTlv.decode(response_tlv) == response
+        json_encode_us = time_us(lambda obj : json.dumps(obj).encode(), response, args.iterations)
+        tlv_encode_us = time_us(ControlTlv.encode, response, args.iterations)
+        json_decode_us = time_us(lambda data : json.loads(data.decode("utf-8")), request_json, args.iterations)
+        tlv_decode_us = time_us(ControlTlv.decode, request_tlv, args.iterations)
+        print("%-18s %8d %8d %8d %8d %8.2fus %8.2fus %8.2fus %8.2fus" % (endpoint, len(request_json), len(request_tlv),
+              len(response_json), len(response_tlv), json_encode_us, tlv_encode_us, json_decode_us, tlv_decode_us))
+    print("sizes in bytes; encode times are for the response, decode times for the request (server side)")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,203 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# 模拟 N 个设备压测 RtcAigcService.py：每个设备保持一个连接，循环 startvoicechat → updatevoicechat(interrupt)
+# → stopvoicechat，最后按接口输出吞吐和时延分位。只依赖标准库。
+# --reboot-rate 为对话中模拟重启的比例：不调用 stopvoicechat，下一轮用 resumevoicechat 恢复
+#
+#   python3 LoadTest.py [--url http://127.0.0.1:8080] [--devices 200] [--cycles 5 | --duration 60]
+#                       [--ramp-seconds 0] [--think-ms 500] [--codec OPUS] [--reboot-rate 0.2] [--authorization af78e30...]
+#
+# 配合 OpenApiStub.py 使用，不消耗真实的 RTC 配额
+
+import argparse
+import http.client
+import json
+import os
+import random
+import sys
+import threading
+import time
+import urllib.parse
+
+ENDPOINTS = ("/startvoicechat", "/resumevoicechat", "/updatevoicechat", "/stopvoicechat")
+
+class EndpointStats:
+    def __init__(self):
+        self.latencies = []
+        self.errors = 0
+        self.error_samples = {}
+
+class LoadStats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.endpoints = {endpoint : EndpointStats() for endpoint in ENDPOINTS}
+        self.cycles = 0
+        self.reconnects = 0
+        self.reboots = 0
+        self.resumed = 0
+
+    def record(self, endpoint, latency, error):
+        with self.lock:
+            stats = self.endpoints[endpoint]
+            if error == None:
+                stats.latencies.append(latency)
+                return
+            stats.errors += 1
+            stats.error_samples[error] = stats.error_samples.get(error, 0) + 1
+
+class Device:
+    def __init__(self, args, stats, index):
+        self.args = args
+        self.stats = stats
+        self.index = index
+        url = urllib.parse.urlsplit(args.url)
+        self.host = url.hostname
+        self.port = url.port or 80
+        self.conn = None
+        # 模拟重启前的会话，和设备保存在 NVS 中的 room_id、task_id 一样，恢复时用来证明会话属于这台设备
+        self.last_task = None
+
+    def request(self, endpoint, body):
+        payload = json.dumps(body)
+        headers = {
+            "Content-Type" : "application/json",
+            "Authorization" : self.args.authorization
+        }
+        start = time.perf_counter()
+        try:
+            if self.conn == None:
+                self.conn = http.client.HTTPConnection(self.host, self.port, timeout = self.args.timeout)
+            self.conn.request("POST", endpoint, payload, headers)
+            response = self.conn.getresponse()
+            data = response.read()
+            if response.getheader("Connection", "").lower() == "close":
+                self.close()
+        except (OSError, http.client.HTTPException) as e:
+            # 连接断开后下一次请求重新建连
+            self.close()
+            with self.stats.lock:
+                self.stats.reconnects += 1
+            self.stats.record(endpoint, 0, type(e).__name__)
+            return None
+        latency = time.perf_counter() - start
+        try:
+            resp_obj = json.loads(data)
+        except ValueError:
+            self.stats.record(endpoint, latency, "HTTP %d non-json" % response.status)
+            return None
+        if resp_obj.get("code") != 200:
+            self.stats.record(endpoint, latency, "code %s: %s" % (resp_obj.get("code"), str(resp_obj.get("msg"))[:60]))
+            return None
+        self.stats.record(endpoint, latency, None)
+        return resp_obj
+
+    def close(self):
+        if self.conn != None:
+            self.conn.close()
+            self.conn = None
+
+    def think(self):
+        if self.args.think_ms > 0:
+            time.sleep(random.uniform(0.5, 1.5) * self.args.think_ms / 1000)
+
+    def cycle(self):
+        body = {"audio_codec" : self.args.codec, "device_id" : "load%05d" % self.index}
+        if self.last_task != None:
+            body.update(room_id = self.last_task["room_id"], task_id = self.last_task["task_id"])
+        resp_obj = self.request("/resumevoicechat" if self.last_task != None else "/startvoicechat", body)
+        if resp_obj == None:
+            return
+        self.last_task = None
+        room_info = resp_obj["data"]
+        if room_info.get("resumed"):
+            with self.stats.lock:
+                self.stats.resumed += 1
+        task = {
+            "app_id" : room_info["app_id"],
+            "room_id" : room_info["room_id"],
+            "task_id" : room_info["task_id"]
+        }
+        self.think()
+        self.request("/updatevoicechat", dict(task, command = "interrupt"))
+        self.think()
+        if random.random() < self.args.reboot_rate:
+            # 模拟掉电重启：断开连接，不停止智能体
+            self.close()
+            self.last_task = task
+            with self.stats.lock:
+                self.stats.reboots += 1
+        else:
+            self.request("/stopvoicechat", task)
+        with self.stats.lock:
+            self.stats.cycles += 1
+
+    def run(self, deadline):
+        if self.args.ramp_seconds > 0:
+            time.sleep(self.args.ramp_seconds * self.index / self.args.devices)
+        cycles = 0
+        while (self.args.duration > 0 and time.monotonic() < deadline) or (self.args.duration <= 0 and cycles < self.args.cycles):
+            self.cycle()
+            cycles += 1
+            self.think()
+        self.close()
+
+def percentile(values, fraction):
+    if len(values) == 0:
+        return 0.0
+    return values[min(len(values) - 1, int(len(values) * fraction))]
+
+def report(stats, elapsed, devices):
+    print("%d devices finished %d cycles in %.1f s, %d reconnects" % (devices, stats.cycles, elapsed, stats.reconnects))
+    if stats.reboots > 0:
+        print("%d simulated reboots, %d sessions resumed" % (stats.reboots, stats.resumed))
+    print("%-18s %7s %7s %8s %8s %8s %8s %8s" % ("endpoint", "ok", "errors", "req/s", "p50_ms", "p95_ms", "p99_ms", "max_ms"))
+    for endpoint, endpoint_stats in stats.endpoints.items():
+        latencies = sorted(endpoint_stats.latencies)
+        print("%-18s %7d %7d %8.1f %8.1f %8.1f %8.1f %8.1f" % (endpoint, len(latencies), endpoint_stats.errors,
+              len(latencies) / elapsed if elapsed > 0 else 0, percentile(latencies, 0.50) * 1000,
+              percentile(latencies, 0.95) * 1000, percentile(latencies, 0.99) * 1000,
+              (latencies[-1] if latencies else 0) * 1000))
+    for endpoint, endpoint_stats in stats.endpoints.items():
+        for error, count in sorted(endpoint_stats.error_samples.items(), key = lambda item : -item[1])[:3]:
+            print("  %s %dx %s" % (endpoint, count, error))
+
+def default_authorization():
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src"))
+    sys.dont_write_bytecode = True
+    try:
+        import RtcAigcConfig
+        return "af78e30" + RtcAigcConfig.RTC_APP_ID
+    except ImportError:
+        return "af78e30"
+
+def main():
+    parser = argparse.ArgumentParser(description = "simulate devices running voice chat cycles against RtcAigcService")
+    parser.add_argument("--url", default = "http://127.0.0.1:8080")
+    parser.add_argument("--devices", type = int, default = 200)
+    parser.add_argument("--cycles", type = int, default = 5, help = "cycles per device when --duration is 0")
+    parser.add_argument("--duration", type = float, default = 0, help = "run for this many seconds instead of --cycles")
+    parser.add_argument("--ramp-seconds", type = float, default = 0, help = "spread device start over this time, 0 for a power-on surge")
+    parser.add_argument("--think-ms", type = float, default = 500, help = "mean pause between requests of one device")
+    parser.add_argument("--codec", default = "OPUS")
+    parser.add_argument("--timeout", type = float, default = 30)
+    parser.add_argument("--reboot-rate", type = float, default = 0, help = "fraction of cycles that end in a simulated reboot instead of stopvoicechat")
+    parser.add_argument("--authorization", default = None)
+    args = parser.parse_args()
+    if args.authorization == None:
+        args.authorization = default_authorization()
+
+    stats = LoadStats()
+    start = time.monotonic()
+    deadline = start + args.duration
+    threads = []
+    for index in range(args.devices):
+        thread = threading.Thread(target = Device(args, stats, index).run, args = (deadline,), daemon = True)
+        threads.append(thread)
+        thread.start()
+    for thread in threads:
+        thread.join()
+    report(stats, time.monotonic() - start, args.devices)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,214 @@
+# Copyright (2025) Beijing Volcano Engine Technology Ltd.
+# SPDX-License-Identifier: MIT
+
+# 本地模拟 rtc.volcengineapi.com 的 StartVoiceChat / StopVoiceChat / UpdateVoiceChat，用于压测 RtcAigcService.py，
+# 不消耗真实的 RTC 配额。按 RtcApiRequester 的规则校验 HMAC-SHA256 签名，可以设置时延和错误率。
+#
+#   python3 OpenApiStub.py [--port 18090] [--latency-ms 300] [--jitter-ms 100] [--error-rate 0.01] [--max-tasks 100] [--ak AK --sk SK]
+#
+# 服务端用环境变量指向这里：RTC_API_SCHEME=http RTC_API_HOST=127.0.0.1:18090 python3 RtcAigcService.py
+# AK/SK 默认读取 ../src/RtcAigcConfig.py
+
+import argparse
+import datetime
+import hashlib
+import hmac
+import http.server
+import json
+import os
+import random
+import sys
+import threading
+import time
+import urllib.parse
+
+ACTIONS = ("StartVoiceChat", "StopVoiceChat", "UpdateVoiceChat")
+DATE_SKEW_SECONDS = 300
+
+def hash_sha256(content):
+    return hashlib.sha256(content).hexdigest()
+
+def hmac_sha256(key, content):
+    return hmac.new(key, content.encode("utf-8"), hashlib.sha256).digest()
+
+class StubState:
+    def __init__(self, args):
+        self.args = args
+        self.lock = threading.Lock()
+        self.tasks = set()
+        self.counts = {action : 0 for action in ACTIONS}
+        self.injected_errors = 0
+        self.signature_errors = 0
+        self.task_errors = 0
+        self.quota_errors = 0
+
+    def delay(self):
+        latency = self.args.latency_ms + random.uniform(-self.args.jitter_ms, self.args.jitter_ms)
+        if latency > 0:
+            time.sleep(latency / 1000)
+
+state = None
+
+class OpenApiStubHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def log_message(self, format, *args):
+        pass
+
+    def respond(self, status, action, result = None, error_code = None, error_message = None):
+        metadata = {
+            "RequestId" : os.urandom(8).hex(),
+            "Action" : action,
+            "Version" : "2024-12-01",
+            "Service" : "rtc",
+            "Region" : "cn-north-1"
+        }
+        if error_code != None:
+            metadata["Error"] = {
+                "Code" : error_code,
+                "Message" : error_message
+            }
+        body_obj = {
+            "ResponseMetadata" : metadata
+        }
+        if result != None:
+            body_obj["Result"] = result
+        body = json.dumps(body_obj).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    # 和 RtcApiRequester.request_rtc_api 的签名过程一致，返回错误信息，成功返回 None
+    def verify_signature(self, path, query, body):
+        authorization = self.headers.get("Authorization", "")
+        x_date = self.headers.get("X-Date", "")
+        x_content_sha256 = self.headers.get("X-Content-Sha256", "")
+        prefix = "HMAC-SHA256 "
+        if not authorization.startswith(prefix):
+            return "missing HMAC-SHA256 authorization"
+        fields = {}
+        for item in authorization[len(prefix):].split(","):
+            key, _, value = item.strip().partition("=")
+            fields[key] = value
+        if "Credential" not in fields or "SignedHeaders" not in fields or "Signature" not in fields:
+            return "malformed authorization"
+        ak, _, credential_scope = fields["Credential"].partition("/")
+        if ak != state.args.ak:
+            return "unknown access key"
+        if x_content_sha256 != hash_sha256(body):
+            return "body hash mismatch"
+        try:
+            signed_at = datetime.datetime.strptime(x_date, "%Y%m%dT%H%M%SZ").replace(tzinfo=datetime.timezone.utc)
+        except ValueError:
+            return "bad X-Date"
+        if abs((datetime.datetime.now(datetime.timezone.utc) - signed_at).total_seconds()) > DATE_SKEW_SECONDS:
+            return "X-Date out of range"
+        if credential_scope != x_date[0:8] + "/cn-north-1/rtc/request":
+            return "bad credential scope"
+
+        signed_headers = fields["SignedHeaders"].split(";")
+        canonical_headers = "".join(name + ":" + self.headers.get(name, "") + "\n" for name in signed_headers)
+        canonical_request = "POST\n" + (path or "/") + "\n" + query + "\n" + canonical_headers + "\n" + fields["SignedHeaders"] + "\n" + x_content_sha256
+        string_to_sign = "HMAC-SHA256\n" + x_date + "\n" + credential_scope + "\n" + hash_sha256(canonical_request.encode("utf-8"))
+        signature = state.args.sk.encode("utf-8")
+        for content in credential_scope.split("/") + [string_to_sign]:
+            signature = hmac_sha256(signature, content)
+        if not hmac.compare_digest(signature.hex(), fields["Signature"]):
+            return "signature mismatch"
+        return None
+
+    def do_POST(self):
+        url = urllib.parse.urlsplit(self.path)
+        body = self.rfile.read(int(self.headers.get("Content-Length", "0")))
+        params = urllib.parse.parse_qs(url.query)
+        action = params.get("Action", [""])[0]
+        if action not in ACTIONS:
+            self.respond(404, action, error_code = "InvalidActionOrVersion", error_message = "unknown action " + action)
+            return
+
+        error = self.verify_signature(url.path, url.query, body)
+        if error != None:
+            with state.lock:
+                state.signature_errors += 1
+            self.respond(401, action, error_code = "SignatureDoesNotMatch", error_message = error)
+            return
+
+        state.delay()
+        with state.lock:
+            state.counts[action] += 1
+        if random.random() < state.args.error_rate:
+            with state.lock:
+                state.injected_errors += 1
+            self.respond(500, action, error_code = "InternalError", error_message = "stub injected error")
+            return
+
+        try:
+            request = json.loads(body)
+            task = (request["AppId"], request["RoomId"], request["TaskId"])
+        except (ValueError, KeyError, TypeError):
+            self.respond(400, action, error_code = "InvalidParameter", error_message = "AppId, RoomId, TaskId are required")
+            return
+        with state.lock:
+            exists = task in state.tasks
+            # 模拟智能体并发配额
+            quota_exceeded = action == "StartVoiceChat" and not exists and 0 < state.args.max_tasks <= len(state.tasks)
+            if quota_exceeded:
+                state.quota_errors += 1
+            elif action == "StartVoiceChat" and not exists:
+                state.tasks.add(task)
+            elif action == "StopVoiceChat" and exists:
+                state.tasks.discard(task)
+            failed = exists if action == "StartVoiceChat" else not exists
+            if failed:
+                state.task_errors += 1
+        if quota_exceeded:
+            self.respond(429, action, error_code = "LimitExceeded", error_message = "too many running voice chat tasks")
+        elif not failed:
+            self.respond(200, action, result = "ok")
+        elif action == "StartVoiceChat":
+            self.respond(400, action, error_code = "TaskAlreadyExists", error_message = "task " + task[2] + " is running")
+        else:
+            self.respond(400, action, error_code = "TaskNotExist", error_message = "task " + task[2] + " not found")
+
+class OpenApiStubServer(http.server.ThreadingHTTPServer):
+    request_queue_size = 512
+
+def report(interval):
+    while True:
+        time.sleep(interval)
+        with state.lock:
+            print("stub: %s, running %d, injected errors %d, signature errors %d, task errors %d, quota errors %d" % (
+                ", ".join("%s %d" % (action, count) for action, count in state.counts.items()),
+                len(state.tasks), state.injected_errors, state.signature_errors, state.task_errors, state.quota_errors), flush = True)
+
+def main():
+    global state
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src"))
+    sys.dont_write_bytecode = True
+    try:
+        import RtcAigcConfig
+        default_ak, default_sk = RtcAigcConfig.AK, RtcAigcConfig.SK
+    except ImportError:
+        default_ak, default_sk = "", ""
+
+    parser = argparse.ArgumentParser(description = "local stand-in for rtc.volcengineapi.com voice chat actions")
+    parser.add_argument("--port", type = int, default = 18090)
+    parser.add_argument("--latency-ms", type = float, default = 300, help = "mean processing time of each call")
+    parser.add_argument("--jitter-ms", type = float, default = 100, help = "uniform +/- spread around --latency-ms")
+    parser.add_argument("--error-rate", type = float, default = 0.0, help = "fraction of calls answered with InternalError")
+    parser.add_argument("--max-tasks", type = int, default = 0, help = "concurrent StartVoiceChat tasks before LimitExceeded, 0 for no limit")
+    parser.add_argument("--ak", default = default_ak)
+    parser.add_argument("--sk", default = default_sk)
+    parser.add_argument("--report-seconds", type = float, default = 10)
+    args = parser.parse_args()
+    state = StubState(args)
+
+    threading.Thread(target = report, args = (args.report_seconds,), daemon = True).start()
+    server = OpenApiStubServer(("", args.port), OpenApiStubHandler)
+    print("openapi stub at port", args.port, flush = True)
+    server.serve_forever()
+
+if __name__ == "__main__":
+    main()